@@ -8,6 +8,7 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LocalTxs.h>
 #include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
@@ -15,6 +16,7 @@
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
 #include <ripple/app/misc/ValidatorList.h>
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/make_lock.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/consensus/LedgerTiming.h>
@@ -378,6 +380,10 @@ RCLConsensus::Adaptor::doAccept(
     ConsensusMode const& mode,
     Json::Value && consensusJson)
 {
+    auto& profiler = app_.getCloseProfiler();
+    perf::CloseProfiler::Scope acceptScope (
+        profiler, prevLedger.seq() + 1, "accept");
+
     prevProposers_ = result.proposers;
     prevRoundTime_ = result.roundTime.read();
 
@@ -429,8 +435,14 @@ RCLConsensus::Adaptor::doAccept(
         }
     }
 
-    auto built = buildLCL(prevLedger, retriableTxs, consensusCloseTime,
-        closeTimeCorrect, closeResolution, result.roundTime.read(), failed);
+    auto built = [&]
+    {
+        perf::CloseProfiler::Scope scope (
+            profiler, prevLedger.seq() + 1, "buildLCL");
+        return buildLCL(prevLedger, retriableTxs, consensusCloseTime,
+            closeTimeCorrect, closeResolution, result.roundTime.read(),
+            failed);
+    }();
 
     auto const newLCLHash = built.id();
     JLOG(j_.debug()) << "Built ledger #" << built.seq() << ": " << newLCLHash;
@@ -481,6 +493,7 @@ RCLConsensus::Adaptor::doAccept(
     if (validating_ && !consensusFail &&
         app_.getValidations().canValidateSeq(built.seq()))
     {
+        perf::CloseProfiler::Scope scope (profiler, built.seq(), "validate");
         validate(built, result.txns, proposing);
         JLOG(j_.info()) << "CNF Val " << newLCLHash;
     }
@@ -524,6 +537,8 @@ RCLConsensus::Adaptor::doAccept(
         auto sl = make_lock(ledgerMaster_.peekMutex(), std::defer_lock);
         std::lock(lock, sl);
 
+        perf::CloseProfiler::Scope scope (profiler, built.seq(), "openLedger");
+
         auto const lastVal = ledgerMaster_.getValidatedLedger();
         boost::optional<Rules> rules;
         if (lastVal)
@@ -639,19 +654,51 @@ RCLConsensus::Adaptor::buildLCL(
     std::chrono::milliseconds roundTime,
     std::set<TxID>& failedTxs)
 {
+    // With a pipeline, the new nodes are written while the next round opens
+    auto unwritten = app_.config().LEDGER_PIPELINE
+        ? std::make_shared<UnwrittenNodes>()
+        : nullptr;
+
     std::shared_ptr<Ledger> built = [&]()
     {
         if (auto const replayData = ledgerMaster_.releaseReplay())
         {
             assert(replayData->parent()->info().hash == previousLedger.id());
+            unwritten.reset();
             return buildLedger(*replayData, tapNONE, app_, j_);
         }
         return buildLedger(previousLedger.ledger_, closeTime, closeTimeCorrect,
-            closeResolution, app_, retriableTxs, failedTxs, j_);
+            closeResolution, app_, retriableTxs, failedTxs, j_,
+            unwritten.get());
     }();
 
-    using namespace std::chrono_literals;
-    app_.getTxQ().processClosedLedger(app_, *built, roundTime > 5s);
+    if (unwritten)
+    {
+        // Saving the ledger waits for its nodes to be written. A
+        // synchronous save may write them itself, before the job runs.
+        auto const hash = built->info().hash;
+        app_.pendingSaves().startWrite(hash,
+            [&app = app_, built, unwritten]()
+            {
+                perf::CloseProfiler::Scope scope (app.getCloseProfiler(),
+                    built->info().seq, "writeNodes");
+                writeLedgerNodes(*built, *unwritten);
+            });
+
+        if (! app_.getJobQueue().addJob(jtWRITE, "writeLedgerNodes",
+                [&app = app_, hash](Job&)
+                {
+                    app.pendingSaves().finishWrite(hash);
+                }))
+            app_.pendingSaves().finishWrite(hash);
+    }
+
+    {
+        using namespace std::chrono_literals;
+        perf::CloseProfiler::Scope scope (app_.getCloseProfiler(),
+            built->info().seq, "processClosedLedger");
+        app_.getTxQ().processClosedLedger(app_, *built, roundTime > 5s);
+    }
 
     if (ledgerMaster_.storeLedger(built))
         JLOG(j_.debug()) << "Consensus built ledger we already had";
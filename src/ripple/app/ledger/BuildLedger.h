@@ -7,7 +7,9 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/utility/Journal.h>
 #include <chrono>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace ripple {
 
@@ -16,7 +18,25 @@ class CanonicalTXSet;
 class Ledger;
 class LedgerReplay;
 class SHAMap;
+class SHAMapAbstractNode;
 
+/** Nodes of a built ledger that are not yet in the node store. */
+struct UnwrittenNodes
+{
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> state;
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> txs;
+};
+
+/** Work done applying transactions on several threads. */
+struct ParallelApplyStats
+{
+    // Results committed as they were applied on a worker
+    std::size_t kept = 0;
+
+    // Transactions applied again in order, after a conflict or because
+    // they are not applied on workers
+    std::size_t reapplied = 0;
+};
 
 
 std::shared_ptr<Ledger>
@@ -28,7 +48,17 @@ buildLedger(
     Application& app,
     CanonicalTXSet& txns,
     std::set<TxID>& failedTxs,
-    beast::Journal j);
+    beast::Journal j,
+    UnwrittenNodes* unwritten = nullptr,
+    ParallelApplyStats* stats = nullptr);
+
+/** Write the nodes of a ledger built with unwritten nodes.
+
+    Until this is done, the new nodes of the ledger are only in memory and
+    in the tree node cache.
+*/
+void
+writeLedgerNodes(Ledger const& ledger, UnwrittenNodes const& nodes);
 
 
 std::shared_ptr<Ledger>
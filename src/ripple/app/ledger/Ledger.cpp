@@ -13,6 +13,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
@@ -111,6 +112,7 @@ class Ledger::txs_iter_impl
 private:
     bool metadata_;
     SHAMap::const_iterator iter_;
+    std::shared_ptr<hash_map<uint256, tx_type>> parsed_;
 
 public:
     txs_iter_impl() = delete;
@@ -119,8 +121,9 @@ public:
     txs_iter_impl (txs_iter_impl const&) = default;
 
     txs_iter_impl(bool metadata,
-        SHAMap::const_iterator iter)
-        : metadata_(metadata), iter_(iter)
+        SHAMap::const_iterator iter,
+            std::shared_ptr<hash_map<uint256, tx_type>> parsed)
+        : metadata_(metadata), iter_(iter), parsed_(std::move(parsed))
     {
     }
 
@@ -150,7 +153,15 @@ public:
     {
         auto const item = *iter_;
         if (metadata_)
+        {
+            if (parsed_)
+            {
+                auto const it = parsed_->find(item.key());
+                if (it != parsed_->end())
+                    return it->second;
+            }
             return deserializeTxPlusMeta(item);
+        }
         return { deserializeTx(item), nullptr };
     }
 };
@@ -408,6 +419,7 @@ Ledger::read (Keylet const& k) const
         stateMap_->peekItem(k.key);
     if (! item)
         return nullptr;
+    ++perf::workCounters().slesRead;
     auto sle = std::make_shared<SLE>(
         SerialIter{item->data(),
             item->size()}, item->key());
@@ -442,14 +454,16 @@ auto
 Ledger::txsBegin() const ->
     std::unique_ptr<txs_type::iter_base>
 {
-    return std::make_unique<txs_iter_impl>(!open(), txMap_->begin());
+    return std::make_unique<txs_iter_impl>(
+        !open(), txMap_->begin(), std::atomic_load(&parsed_));
 }
 
 auto
 Ledger::txsEnd() const ->
     std::unique_ptr<txs_type::iter_base>
 {
-    return std::make_unique<txs_iter_impl>(!open(), txMap_->end());
+    return std::make_unique<txs_iter_impl>(
+        !open(), txMap_->end(), std::atomic_load(&parsed_));
 }
 
 bool
@@ -469,6 +483,12 @@ Ledger::txRead(
         return {};
     if (!open())
     {
+        if (auto const parsed = std::atomic_load(&parsed_))
+        {
+            auto const it = parsed->find(key);
+            if (it != parsed->end())
+                return it->second;
+        }
         auto result =
             deserializeTxPlusMeta(*item);
         return { std::move(result.first),
@@ -540,6 +560,29 @@ Ledger::rawTxInsert (uint256 const& key,
         LogicError("duplicate_tx: " + to_string(key));
 }
 
+void
+Ledger::rawTxInsert (uint256 const& key,
+    std::shared_ptr<Serializer const
+        > const& txn, std::shared_ptr<
+            Serializer const> const& metaData,
+                tx_type const& parsed)
+{
+    rawTxInsert (key, txn, metaData);
+    if (parsed.first && parsed.second)
+    {
+        if (! parsed_)
+            parsed_ = std::make_shared<hash_map<uint256, tx_type>>();
+        parsed_->emplace (key, parsed);
+    }
+}
+
+void
+Ledger::releaseParsed() const
+{
+    std::atomic_store (&parsed_,
+        std::shared_ptr<hash_map<uint256, tx_type>>{});
+}
+
 bool
 Ledger::setup (Config const& config)
 {
@@ -748,6 +791,8 @@ static bool saveValidatedLedger (
 {
     auto j = app.journal ("Ledger");
     auto seq = ledger->info().seq;
+    perf::CloseProfiler::Scope scope (
+        app.getCloseProfiler (), seq, "saveValidatedLedger");
     if (! app.pendingSaves().startWork (seq))
     {
         JLOG (j.debug()) << "Save aborted";
@@ -950,6 +995,19 @@ bool pendSaveValidated (
     bool isSynchronous,
     bool isCurrent)
 {
+    // A ledger is only saved once its nodes are in the node store. A
+    // synchronous save writes them now, or waits for the write running.
+    if (isSynchronous)
+        app.pendingSaves().finishWrite (ledger->info().hash);
+    else if (app.pendingSaves().afterWrite (ledger->info().hash,
+        [&app, ledger, isSynchronous, isCurrent]
+        {
+            pendSaveValidated (app, ledger, isSynchronous, isCurrent);
+        }))
+    {
+        return true;
+    }
+
     if (! app.getHashRouter ().setFlags (ledger->info().hash, SF_SAVED))
     {
         auto stream = app.journal ("Ledger").debug();
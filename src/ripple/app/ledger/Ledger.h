@@ -7,6 +7,7 @@
 #include <ripple/ledger/View.h>
 #include <ripple/ledger/CachedView.h>
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/core/TimeKeeper.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/STLedgerEntry.h>
@@ -161,6 +162,19 @@ public:
             > const& txn, std::shared_ptr<
                 Serializer const> const& metaData) override;
 
+    void
+    rawTxInsert (uint256 const& key,
+        std::shared_ptr<Serializer const
+            > const& txn, std::shared_ptr<
+                Serializer const> const& metaData,
+                    tx_type const& parsed) override;
+
+
+    /** Drop the parsed transactions kept from building this ledger.
+
+        Readers parse the transactions from the map from then on.
+    */
+    void releaseParsed() const;
 
     void setValidated() const
     {
@@ -244,6 +258,11 @@ private:
     std::shared_ptr<SHAMap> txMap_;
     std::shared_ptr<SHAMap> stateMap_;
 
+    // Transactions as applied when this ledger was built here, so that
+    // readers need not parse them. Only written before it is shared, and
+    // released once it is no longer the last closed ledger.
+    std::shared_ptr<hash_map<uint256, tx_type>> mutable parsed_;
+
     std::mutex mutable mutex_;
 
     Fees fees_;
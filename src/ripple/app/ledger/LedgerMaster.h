@@ -20,8 +20,10 @@
 #include <ripple/protocol/STValidation.h>
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/core/Stoppable.h>
+#include <ripple/overlay/Peer.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/beast/utility/PropertyStream.h>
+#include <map>
 #include <mutex>
 
 #include <ripple/protocol/messages.h>
@@ -196,6 +198,30 @@ public:
         uint256 haveLedgerHash,
         UptimeClock::time_point uptime);
 
+    /** Note that a peer was asked to stream the given range of ledgers.
+
+        The stream is identified by the peer and the hash of the ledger
+        the request started from. Only its messages for ledgers in the
+        range are accepted, until the peer ends it or it is asked for
+        again. Streams from other peers, or starting from other ledgers,
+        may be outstanding at the same time.
+    */
+    void expectFetchPackStream (Peer::id_t peer,
+        uint256 const& haveLedgerHash, LedgerIndex first, LedgerIndex last);
+
+    /** A peer answered a fetch pack request without streaming. */
+    void endFetchPackStream (Peer::id_t peer, uint256 const& haveLedgerHash);
+
+    /** Store the nodes of one fetch pack stream message.
+
+        @return false if the message was unsolicited or malformed, in
+                which case nothing was stored and the sender should be
+                charged.
+    */
+    bool gotFetchPackStream (
+        std::shared_ptr<protocol::TMGetObjectByHash> const& packet,
+        Peer::id_t peer);
+
     std::size_t getFetchPackCacheSize () const;
 
     bool
@@ -220,6 +246,14 @@ private:
     void getFetchPack(
         LedgerIndex missing, InboundLedger::Reason reason);
 
+    void makeFetchPackStream (
+        std::weak_ptr<Peer> const& wPeer,
+        std::shared_ptr<protocol::TMGetObjectByHash> const& request,
+        std::shared_ptr<Ledger const> haveLedger,
+        std::uint32_t remaining);
+
+    bool fetchPackStreamActive (LedgerIndex seq) const;
+
     boost::optional<LedgerHash> getLedgerHashForHistory(
         LedgerIndex index, InboundLedger::Reason reason);
 
@@ -302,6 +336,16 @@ private:
 
     std::uint32_t fetch_seq_ {0};
 
+    struct FetchStream
+    {
+        LedgerIndex first;
+        LedgerIndex last;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    // The fetch pack streams asked for, by peer and starting ledger
+    std::map<std::pair<Peer::id_t, uint256>, FetchStream> fetch_streams_;
+
     LedgerIndex const max_ledger_difference_ {1000000};
 
 };
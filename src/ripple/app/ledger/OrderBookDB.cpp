@@ -15,6 +15,7 @@ OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     , app_ (app)
     , mSeq (0)
     , j_ (app.journal ("OrderBookDB"))
+    , index_ (j_)
 {
 }
 
@@ -5,6 +5,7 @@
 
 #include <ripple/app/ledger/AcceptedLedgerTx.h>
 #include <ripple/app/ledger/BookListeners.h>
+#include <ripple/app/ledger/OrderBookIndex.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/OrderBook.h>
 #include <mutex>
@@ -31,6 +32,11 @@ public:
 
     bool isBookToXRP (Issue const&);
 
+    OrderBookIndex& getBookIndex ()
+    {
+        return index_;
+    }
+
     BookListeners::pointer getBookListeners (Book const&);
     BookListeners::pointer makeBookListeners (Book const&);
 
@@ -60,6 +66,8 @@ private:
     std::uint32_t mSeq;
 
     beast::Journal j_;
+
+    OrderBookIndex index_;
 };
 
 } 
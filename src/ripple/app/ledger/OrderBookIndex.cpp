@@ -0,0 +1,207 @@
+#include <ripple/app/ledger/OrderBookIndex.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/BookDirs.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <atomic>
+
+namespace ripple {
+
+// Most books kept in the index
+std::size_t constexpr maxBooks = 4096;
+
+std::size_t
+OrderBookIndex::Snapshot::bucket (Book const& book)
+{
+    return beast::uhash<> {} (book) % bucketCount;
+}
+
+std::shared_ptr<OrderBookIndex::Offers const>
+OrderBookIndex::Snapshot::find (Book const& book) const
+{
+    auto const& b = buckets[bucket (book)];
+    if (! b)
+        return nullptr;
+
+    auto const it = b->find (book);
+    if (it == b->end ())
+        return nullptr;
+
+    return it->second;
+}
+
+OrderBookIndex::OrderBookIndex (beast::Journal journal)
+    : journal_ (journal)
+    , current_ (std::make_shared<Snapshot> ())
+{
+}
+
+OrderBookIndex::Offers
+OrderBookIndex::build (ReadView const& view, Book const& book)
+{
+    Offers offers;
+    for (auto const& sle : BookDirs (view, book))
+    {
+        if (sle)
+            offers.push_back ({sle,
+                getQuality (sle->getFieldH256 (sfBookDirectory))});
+    }
+    return offers;
+}
+
+std::shared_ptr<OrderBookIndex::Offers const>
+OrderBookIndex::getOffers (ReadView const& view, Book const& book)
+{
+    if (view.open ())
+        return nullptr;
+
+    auto const snapshot = std::atomic_load (&current_);
+    if (snapshot->seq != view.info ().seq ||
+        snapshot->hash != view.info ().hash)
+    {
+        return nullptr;
+    }
+
+    if (auto offers = snapshot->find (book))
+        return offers;
+
+    auto const offers = std::make_shared<Offers const> (build (view, book));
+
+    std::lock_guard<std::mutex> sl (mutex_);
+    auto const cur = std::atomic_load (&current_);
+    if (cur->seq == snapshot->seq && cur->hash == snapshot->hash &&
+        cur->size < maxBooks && ! cur->find (book))
+    {
+        auto next = std::make_shared<Snapshot> (*cur);
+        auto const i = Snapshot::bucket (book);
+        auto b = next->buckets[i] ?
+            std::make_shared<Snapshot::Bucket> (*next->buckets[i]) :
+            std::make_shared<Snapshot::Bucket> ();
+        b->emplace (book, offers);
+        next->buckets[i] = std::move (b);
+        ++next->size;
+        std::atomic_store (&current_,
+            std::shared_ptr<Snapshot const> (std::move (next)));
+    }
+    return offers;
+}
+
+void
+OrderBookIndex::onValidatedLedger (
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    std::lock_guard<std::mutex> sl (mutex_);
+
+    auto const cur = std::atomic_load (&current_);
+    auto const& info = ledger->info ();
+    if (info.seq <= cur->seq)
+        return;
+
+    auto next = std::make_shared<Snapshot> ();
+    next->seq = info.seq;
+    next->hash = info.hash;
+
+    if (cur->size != 0 && info.seq == cur->seq + 1 &&
+        info.parentHash == cur->hash)
+    {
+        try
+        {
+            // Offers changed or deleted are replaced in place. A book
+            // that gained an offer is dropped and read again on demand
+            // so directory order is kept.
+            hash_map<uint256, std::shared_ptr<SLE const>> changed;
+            hash_set<Book> touched;
+            hash_set<Book> dropped;
+
+            for (auto const& tx : ledger->txs)
+            {
+                if (! tx.second)
+                    continue;
+
+                for (auto const& node :
+                    tx.second->getFieldArray (sfAffectedNodes))
+                {
+                    if (node.getFieldU16 (sfLedgerEntryType) != ltOFFER)
+                        continue;
+
+                    bool const created = node.getFName () == sfCreatedNode;
+                    auto const fields = dynamic_cast<STObject const*> (
+                        node.peekAtPField (
+                            created ? sfNewFields : sfFinalFields));
+                    if (! fields)
+                        continue;
+
+                    Book const book {
+                        fields->getFieldAmount (sfTakerPays).issue (),
+                        fields->getFieldAmount (sfTakerGets).issue ()};
+
+                    changed.emplace (node.getFieldH256 (sfLedgerIndex),
+                        nullptr);
+                    touched.insert (book);
+                    if (created)
+                        dropped.insert (book);
+                }
+            }
+
+            for (auto& c : changed)
+                c.second = ledger->read (keylet::offer (c.first));
+
+            next->buckets = cur->buckets;
+            next->size = cur->size;
+
+            // Buckets are copied the first time this ledger changes them
+            std::array<std::shared_ptr<Snapshot::Bucket>,
+                Snapshot::bucketCount> copies;
+            for (auto const& book : touched)
+            {
+                auto const old = next->find (book);
+                if (! old)
+                    continue;
+
+                auto const i = Snapshot::bucket (book);
+                if (! copies[i])
+                {
+                    copies[i] = std::make_shared<Snapshot::Bucket> (
+                        *next->buckets[i]);
+                    next->buckets[i] = copies[i];
+                }
+
+                if (dropped.count (book))
+                {
+                    copies[i]->erase (book);
+                    --next->size;
+                    continue;
+                }
+
+                auto offers = std::make_shared<Offers> ();
+                offers->reserve (old->size ());
+                for (auto const& offer : *old)
+                {
+                    auto const c = changed.find (offer.sle->key ());
+                    if (c == changed.end ())
+                        offers->push_back (offer);
+                    else if (c->second)
+                        offers->push_back ({c->second, offer.quality});
+                }
+                (*copies[i])[book] = std::move (offers);
+            }
+
+            JLOG (journal_.trace()) << "Order book index at " << info.seq <<
+                ": " << changed.size () << " offers changed, " <<
+                next->size << " books kept";
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (journal_.warn()) << "Order book index reset at " <<
+                info.seq << ": " << e.what ();
+            next->buckets = {};
+            next->size = 0;
+        }
+    }
+
+    std::atomic_store (&current_,
+        std::shared_ptr<Snapshot const> (std::move (next)));
+}
+
+}
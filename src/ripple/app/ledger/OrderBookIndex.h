@@ -0,0 +1,91 @@
+#ifndef RIPPLE_APP_LEDGER_ORDERBOOKINDEX_H_INCLUDED
+#define RIPPLE_APP_LEDGER_ORDERBOOKINDEX_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/Book.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Offers of the last validated ledger, by book, best quality first.
+
+    A book is read from its directories the first time it is asked for
+    and the result is shared by every later reader of that ledger. Books
+    are carried forward to each following validated ledger using the
+    offers in its transaction metadata. Readers never take a lock.
+*/
+class OrderBookIndex
+{
+public:
+    struct Offer
+    {
+        std::shared_ptr<SLE const> sle;
+
+        // Quality of the directory holding the offer
+        std::uint64_t quality;
+    };
+
+    using Offers = std::vector<Offer>;
+
+    explicit
+    OrderBookIndex (beast::Journal journal);
+
+    /** The offers in a book of a view, in directory order.
+        Returns nullptr unless the view is the last validated ledger.
+    */
+    std::shared_ptr<Offers const>
+    getOffers (ReadView const& view, Book const& book);
+
+    /** Advance to a newly validated ledger.
+        If the ledger does not directly follow the current one the index
+        starts over empty.
+    */
+    void
+    onValidatedLedger (std::shared_ptr<ReadView const> const& ledger);
+
+    /** Read the offers in a book by walking its directories. */
+    static
+    Offers
+    build (ReadView const& view, Book const& book);
+
+private:
+    // Books are spread over buckets so that adding or changing a book
+    // copies only its bucket. Unchanged buckets are shared between
+    // snapshots.
+    struct Snapshot
+    {
+        using Bucket = hash_map<Book, std::shared_ptr<Offers const>>;
+
+        static std::size_t constexpr bucketCount = 256;
+
+        static std::size_t
+        bucket (Book const& book);
+
+        std::shared_ptr<Offers const>
+        find (Book const& book) const;
+
+        std::uint32_t seq = 0;
+        uint256 hash;
+        std::size_t size = 0;
+        std::array<std::shared_ptr<Bucket const>, bucketCount> buckets;
+    };
+
+    beast::Journal journal_;
+
+    // Serializes writers
+    std::mutex mutex_;
+
+    // Accessed with std::atomic_load and std::atomic_store
+    std::shared_ptr<Snapshot const> current_;
+};
+
+}
+
+#endif
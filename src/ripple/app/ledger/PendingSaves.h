@@ -3,10 +3,13 @@
 #ifndef RIPPLE_APP_PENDINGSAVES_H_INCLUDED
 #define RIPPLE_APP_PENDINGSAVES_H_INCLUDED
 
+#include <ripple/basics/base_uint.h>
 #include <ripple/protocol/Protocol.h>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 namespace ripple {
 
@@ -18,6 +21,15 @@ private:
     std::map <LedgerIndex, bool> map_;
     std::condition_variable await_;
 
+    // Ledgers whose nodes are not yet written, and the saves waiting
+    struct Write
+    {
+        std::function<void()> write;
+        bool running = false;
+        std::vector<std::function<void()>> after;
+    };
+    std::map <uint256, Write> writes_;
+
 public:
 
     
@@ -86,6 +98,67 @@ public:
     }
 
     
+    /** Note that the nodes of a ledger still have to be written. */
+    void
+    startWrite (uint256 const& hash, std::function<void()> write)
+    {
+        std::lock_guard <std::mutex> lock(mutex_);
+        writes_[hash].write = std::move (write);
+    }
+
+    /** Write the nodes of a ledger, unless another thread already is.
+
+        Returns once they are written, after running what waited for them.
+    */
+    void
+    finishWrite (uint256 const& hash)
+    {
+        std::unique_lock <std::mutex> lock(mutex_);
+        auto it = writes_.find (hash);
+        if (it == writes_.end())
+            return;
+
+        if (it->second.running)
+        {
+            await_.wait (lock, [this, &hash]
+                {
+                    return writes_.find (hash) == writes_.end();
+                });
+            return;
+        }
+
+        it->second.running = true;
+        auto const write = std::move (it->second.write);
+        lock.unlock();
+        write ();
+        lock.lock();
+
+        it = writes_.find (hash);
+        auto const after = std::move (it->second.after);
+        writes_.erase (it);
+        await_.notify_all();
+        lock.unlock();
+
+        for (auto const& f : after)
+            f ();
+    }
+
+    /** Run f once the nodes of a ledger are written.
+
+        @return false, without keeping f, if they are not being written.
+    */
+    bool
+    afterWrite (uint256 const& hash, std::function<void()> f)
+    {
+        std::lock_guard <std::mutex> lock(mutex_);
+        auto it = writes_.find (hash);
+        if (it == writes_.end())
+            return false;
+        it->second.after.push_back (std::move (f));
+        return true;
+    }
+
+    
     std::map <LedgerIndex, bool>
     getSnapshot () const
     {
@@ -7,10 +7,330 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/basics/CloseProfiler.h>
+#include <ripple/core/Config.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/ledger/OpenView.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/STTx.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace ripple {
 
+namespace detail {
+
+// A view that remembers what a transaction read from its base
+class RecordingView : public ReadView
+{
+public:
+    explicit
+    RecordingView (ReadView const& base)
+        : base_ (base)
+    {
+    }
+
+    /** True if a change to one of the keys may have changed what was read. */
+    bool
+    conflicts (std::set<key_type> const& changed) const
+    {
+        if (changed.empty ())
+            return false;
+
+        if (all_)
+            return true;
+
+        for (auto const& key : keys_)
+            if (changed.count (key))
+                return true;
+
+        for (auto const& r : ranges_)
+        {
+            auto const it = changed.upper_bound (r.key);
+            if (it == changed.end ())
+                continue;
+            if (r.next ? *it <= *r.next : (! r.last || *it < *r.last))
+                return true;
+        }
+        return false;
+    }
+
+    LedgerInfo const&
+    info () const override
+    {
+        return base_.info ();
+    }
+
+    bool
+    open () const override
+    {
+        return base_.open ();
+    }
+
+    Fees const&
+    fees () const override
+    {
+        return base_.fees ();
+    }
+
+    Rules const&
+    rules () const override
+    {
+        return base_.rules ();
+    }
+
+    bool
+    exists (Keylet const& k) const override
+    {
+        keys_.push_back (k.key);
+        return base_.exists (k);
+    }
+
+    boost::optional<key_type>
+    succ (key_type const& key,
+        boost::optional<key_type> const& last) const override
+    {
+        auto next = base_.succ (key, last);
+        ranges_.push_back ({key, last, next});
+        return next;
+    }
+
+    std::shared_ptr<SLE const>
+    read (Keylet const& k) const override
+    {
+        keys_.push_back (k.key);
+        return base_.read (k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin () const override
+    {
+        all_ = true;
+        return base_.slesBegin ();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd () const override
+    {
+        all_ = true;
+        return base_.slesEnd ();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound (key_type const& key) const override
+    {
+        all_ = true;
+        return base_.slesUpperBound (key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin () const override
+    {
+        all_ = true;
+        return base_.txsBegin ();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd () const override
+    {
+        all_ = true;
+        return base_.txsEnd ();
+    }
+
+    bool
+    txExists (key_type const& key) const override
+    {
+        all_ = true;
+        return base_.txExists (key);
+    }
+
+    tx_type
+    txRead (key_type const& key) const override
+    {
+        all_ = true;
+        return base_.txRead (key);
+    }
+
+private:
+    struct Range
+    {
+        key_type key;
+        boost::optional<key_type> last;
+        boost::optional<key_type> next;
+    };
+
+    ReadView const& base_;
+    mutable std::vector<key_type> keys_;
+    mutable std::vector<Range> ranges_;
+    mutable bool all_ = false;
+};
+
+// Passes a transaction's changes on to the ledger being built, noting the
+// keys written and numbering the transaction by its final position.
+class CommitView : public TxsRawView
+{
+public:
+    CommitView (OpenView& to, std::set<uint256>& changed)
+        : to_ (to)
+        , changed_ (changed)
+    {
+    }
+
+    void
+    rawErase (std::shared_ptr<SLE> const& sle) override
+    {
+        changed_.insert (sle->key ());
+        to_.rawErase (sle);
+    }
+
+    void
+    rawInsert (std::shared_ptr<SLE> const& sle) override
+    {
+        changed_.insert (sle->key ());
+        to_.rawInsert (sle);
+    }
+
+    void
+    rawReplace (std::shared_ptr<SLE> const& sle) override
+    {
+        changed_.insert (sle->key ());
+        to_.rawReplace (sle);
+    }
+
+    void
+    rawDestroyXRP (XRPAmount const& fee) override
+    {
+        to_.rawDestroyXRP (fee);
+    }
+
+    void
+    rawTxInsert (ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData) override
+    {
+        rawTxInsert (key, txn, metaData, {});
+    }
+
+    void
+    rawTxInsert (ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData,
+        ReadView::tx_type const& parsed) override
+    {
+        if (! metaData)
+        {
+            to_.rawTxInsert (key, txn, metaData, parsed);
+            return;
+        }
+
+        auto meta = parsed.second;
+        if (! meta)
+        {
+            SerialIter sit (metaData->slice ());
+            meta = std::make_shared<STObject const> (sit, sfMetadata);
+        }
+
+        auto const index = static_cast<std::uint32_t> (to_.txCount ());
+        if (meta->getFieldU32 (sfTransactionIndex) == index)
+        {
+            to_.rawTxInsert (key, txn, metaData, {parsed.first, meta});
+            return;
+        }
+
+        auto obj = std::make_shared<STObject> (*meta);
+        obj->setFieldU32 (sfTransactionIndex, index);
+        auto s = std::make_shared<Serializer> ();
+        obj->add (*s);
+        to_.rawTxInsert (key, txn, s, {parsed.first, std::move (obj)});
+    }
+
+private:
+    OpenView& to_;
+    std::set<uint256>& changed_;
+};
+
+// A transaction applied to its own view on top of the ledger being built
+struct Speculation
+{
+    explicit
+    Speculation (ReadView const& base)
+        : reads (base)
+        , view (&reads)
+    {
+    }
+
+    RecordingView reads;
+    OpenView view;
+    ApplyResult result = ApplyResult::Retry;
+};
+
+static
+std::unique_ptr<Speculation>
+speculate (Application& app, OpenView const& view, STTx const& tx,
+    bool certainRetry, beast::Journal j)
+{
+    auto s = std::make_unique<Speculation> (view);
+    s->result = applyTransaction (
+        app, s->view, tx, certainRetry, tapNONE, j);
+    return s;
+}
+
+// Calls f(i) for every i in [0, n) on the calling thread and on up to
+// threads - 1 jobs. The caller only waits for jobs that have started, so
+// a busy job queue can delay but never stall the work.
+template <class F>
+void
+forEachOnJobs (JobQueue& jobs, std::size_t n, std::size_t threads,
+    F const& f)
+{
+    struct State
+    {
+        std::atomic<std::size_t> next {0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t running = 0;
+        bool done = false;
+    };
+
+    auto const state = std::make_shared<State> ();
+    auto const run = [&f, n, &next = state->next]
+    {
+        for (std::size_t i; (i = next++) < n;)
+            f (i);
+    };
+
+    for (std::size_t i = 1; i < threads && i < n; ++i)
+    {
+        auto const posted = jobs.addJob (jtACCEPT, "applyTransactions",
+            [state, &run](Job&)
+            {
+                {
+                    std::lock_guard<std::mutex> lock (state->mutex);
+                    if (state->done)
+                        return;
+                    ++state->running;
+                }
+                run ();
+                std::lock_guard<std::mutex> lock (state->mutex);
+                if (--state->running == 0)
+                    state->cv.notify_all ();
+            });
+        if (! posted)
+            break;
+    }
+
+    run ();
+
+    std::unique_lock<std::mutex> lock (state->mutex);
+    state->done = true;
+    state->cv.wait (lock, [&state] { return state->running == 0; });
+}
+
+}
+
 
 template <class ApplyTxs>
 std::shared_ptr<Ledger>
@@ -21,15 +341,21 @@ buildLedgerImpl(
     NetClock::duration closeResolution,
     Application& app,
     beast::Journal j,
+    UnwrittenNodes* unwritten,
     ApplyTxs&& applyTxs)
 {
     auto built = std::make_shared<Ledger>(*parent, closeTime);
+    auto& profiler = app.getCloseProfiler();
+    perf::CloseProfiler::Scope buildScope (
+        profiler, built->info().seq, "buildLedger");
 
     if (built->rules().enabled(featureSHAMapV2) && !built->stateMap().is_v2())
         built->make_v2();
 
 
     {
+        perf::CloseProfiler::Scope scope (
+            profiler, built->info().seq, "applyTransactions");
         OpenView accum(&*built);
         assert(!accum.open());
         applyTxs(accum, built);
@@ -37,8 +363,17 @@ buildLedgerImpl(
     }
 
     built->updateSkipList();
+    if (unwritten)
     {
-
+        perf::CloseProfiler::Scope scope (
+            profiler, built->info().seq, "hashDirty");
+        built->stateMap().unshare(unwritten->state);
+        built->txMap().unshare(unwritten->txs);
+    }
+    else
+    {
+        perf::CloseProfiler::Scope scope (
+            profiler, built->info().seq, "flushDirty");
         int const asf = built->stateMap().flushDirty(
             hotACCOUNT_NODE, built->info().seq);
         int const tmf = built->txMap().flushDirty(
@@ -46,7 +381,11 @@ buildLedgerImpl(
         JLOG(j.debug()) << "Flushed " << asf << " accounts and " << tmf
                         << " transaction nodes";
     }
-    built->unshare();
+    {
+        perf::CloseProfiler::Scope scope (
+            profiler, built->info().seq, "unshare");
+        built->unshare();
+    }
 
     built->setAccepted(
         closeTime, closeResolution, closeTimeCorrect, app.config());
@@ -55,6 +394,115 @@ buildLedgerImpl(
 }
 
 
+// Apply one pass of transactions speculatively on several threads. Each
+// result is kept only if nothing it read was written by a transaction
+// kept before it; otherwise the transaction is applied again in order.
+static
+int
+applyPassParallel(
+    Application& app,
+    std::shared_ptr<Ledger const> const& built,
+    CanonicalTXSet& txns,
+    std::set<TxID>& failed,
+    OpenView& view,
+    int pass,
+    bool certainRetry,
+    std::size_t threads,
+    ParallelApplyStats* stats,
+    beast::Journal j)
+{
+    std::vector<CanonicalTXSet::const_iterator> batch;
+    batch.reserve(txns.size());
+    for (auto it = txns.begin(); it != txns.end();)
+    {
+        if (pass == 0 && built->txExists(it->first.getTXID()))
+            it = txns.erase(it);
+        else
+            batch.push_back(it++);
+    }
+
+    // Pseudo-transactions have effects outside the ledger, so they
+    // are only ever applied in order.
+    std::vector<std::unique_ptr<detail::Speculation>> results(batch.size());
+    detail::forEachOnJobs(app.getJobQueue(), batch.size(), threads,
+        [&](std::size_t i)
+        {
+            auto const& tx = *batch[i]->second;
+            if (isPseudoTx(tx))
+                return;
+
+            try
+            {
+                results[i] = detail::speculate(
+                    app, view, tx, certainRetry, j);
+            }
+            catch (std::exception const&)
+            {
+            }
+        });
+
+    int changes = 0;
+    std::size_t kept = 0;
+    std::size_t reapplied = 0;
+    std::set<uint256> changed;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        auto const it = batch[i];
+        auto const txid = it->first.getTXID();
+
+        try
+        {
+            auto& s = results[i];
+            if (!s || s->reads.conflicts(changed))
+            {
+                s = detail::speculate(
+                    app, view, *it->second, certainRetry, j);
+                ++reapplied;
+            }
+            else
+                ++kept;
+
+            detail::CommitView to(view, changed);
+            s->view.apply(to);
+
+            switch (s->result)
+            {
+                case ApplyResult::Success:
+                    txns.erase(it);
+                    ++changes;
+                    break;
+
+                case ApplyResult::Fail:
+                    failed.insert(txid);
+                    txns.erase(it);
+                    break;
+
+                case ApplyResult::Retry:
+                    break;
+            }
+        }
+        catch (std::exception const&)
+        {
+            JLOG(j.warn()) << "Transaction " << txid << " throws";
+            failed.insert(txid);
+            txns.erase(it);
+        }
+        results[i].reset();
+    }
+
+    JLOG(j.debug())
+        << "Pass: " << pass << " applied " << batch.size()
+        << " transactions on " << threads << " threads, "
+        << reapplied << " in order";
+
+    if (stats)
+    {
+        stats->kept += kept;
+        stats->reapplied += reapplied;
+    }
+
+    return changes;
+}
 
 std::size_t
 applyTransactions(
@@ -63,10 +511,12 @@ applyTransactions(
     CanonicalTXSet& txns,
     std::set<TxID>& failed,
     OpenView& view,
+    ParallelApplyStats* stats,
     beast::Journal j)
 {
     bool certainRetry = true;
     std::size_t count = 0;
+    auto const threads = app.config().LEDGER_APPLY_THREADS;
 
     for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
     {
@@ -75,42 +525,50 @@ applyTransactions(
             << " begins (" << txns.size() << " transactions)";
         int changes = 0;
 
-        auto it = txns.begin();
-
-        while (it != txns.end())
+        if (threads)
+        {
+            changes = applyPassParallel(app, built, txns, failed, view,
+                pass, certainRetry, threads, stats, j);
+        }
+        else
         {
-            auto const txid = it->first.getTXID();
+            auto it = txns.begin();
 
-            try
+            while (it != txns.end())
             {
-                if (pass == 0 && built->txExists(txid))
-                {
-                    it = txns.erase(it);
-                    continue;
-                }
+                auto const txid = it->first.getTXID();
 
-                switch (applyTransaction(
-                    app, view, *it->second, certainRetry, tapNONE, j))
+                try
                 {
-                    case ApplyResult::Success:
+                    if (pass == 0 && built->txExists(txid))
+                    {
                         it = txns.erase(it);
-                        ++changes;
-                        break;
-
-                    case ApplyResult::Fail:
-                        failed.insert(txid);
-                        it = txns.erase(it);
-                        break;
-
-                    case ApplyResult::Retry:
-                        ++it;
+                        continue;
+                    }
+
+                    switch (applyTransaction(
+                        app, view, *it->second, certainRetry, tapNONE, j))
+                    {
+                        case ApplyResult::Success:
+                            it = txns.erase(it);
+                            ++changes;
+                            break;
+
+                        case ApplyResult::Fail:
+                            failed.insert(txid);
+                            it = txns.erase(it);
+                            break;
+
+                        case ApplyResult::Retry:
+                            ++it;
+                    }
+                }
+                catch (std::exception const&)
+                {
+                    JLOG(j.warn()) << "Transaction " << txid << " throws";
+                    failed.insert(txid);
+                    it = txns.erase(it);
                 }
-            }
-            catch (std::exception const&)
-            {
-                JLOG(j.warn()) << "Transaction " << txid << " throws";
-                failed.insert(txid);
-                it = txns.erase(it);
             }
         }
 
@@ -138,14 +596,16 @@ buildLedger(
     Application& app,
     CanonicalTXSet& txns,
     std::set<TxID>& failedTxns,
-    beast::Journal j)
+    beast::Journal j,
+    UnwrittenNodes* unwritten,
+    ParallelApplyStats* stats)
 {
     JLOG(j.debug()) << "Report: Transaction Set = " << txns.key()
                     << ", close " << closeTime.time_since_epoch().count()
                     << (closeTimeCorrect ? "" : " (incorrect)");
 
     return buildLedgerImpl(parent, closeTime, closeTimeCorrect,
-        closeResolution, app, j,
+        closeResolution, app, j, unwritten,
         [&](OpenView& accum, std::shared_ptr<Ledger> const& built)
         {
             JLOG(j.debug())
@@ -153,7 +613,7 @@ buildLedger(
                 << " transactions";
 
             auto const applied = applyTransactions(app, built, txns,
-                failedTxns, accum, j);
+                failedTxns, accum, stats, j);
 
             if (txns.size() || txns.size())
                 JLOG(j.debug())
@@ -185,6 +645,7 @@ buildLedger(
         replayLedger->info().closeTimeResolution,
         app,
         j,
+        nullptr,
         [&](OpenView& accum, std::shared_ptr<Ledger> const& built)
         {
             for (auto& tx : replayData.orderedTxns())
@@ -192,6 +653,13 @@ buildLedger(
         });
 }
 
+void
+writeLedgerNodes(Ledger const& ledger, UnwrittenNodes const& nodes)
+{
+    ledger.stateMap().writeNodes(hotACCOUNT_NODE, nodes.state);
+    ledger.txMap().writeNodes(hotTRANSACTION_NODE, nodes.txs);
+}
+
 }  
 
 
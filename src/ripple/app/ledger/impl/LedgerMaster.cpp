@@ -29,6 +29,7 @@
 #include <ripple/resource/Fees.h>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -42,6 +43,15 @@ auto constexpr MAX_LEDGER_AGE_ACQUIRE = 1min;
 
 auto constexpr MAX_WRITE_LOAD_ACQUIRE = 8192;
 
+// Most ledgers a peer is asked to stream in a single fetch pack stream
+auto constexpr MAX_FETCH_PACK_STREAM = 256;
+
+// Ledgers a streaming job sends before yielding to the job queue
+auto constexpr FETCH_PACK_STREAM_BATCH = 8;
+
+// How long we wait on an outstanding stream before asking again
+auto constexpr FETCH_PACK_STREAM_TIMEOUT = 30s;
+
 LedgerMaster::LedgerMaster (Application& app, Stopwatch& stopwatch,
     Stoppable& parent,
     beast::insight::Collector::ptr const& collector, beast::Journal journal)
@@ -204,6 +214,8 @@ LedgerMaster::setValidLedger(
 
     app_.getOPs().updateLocalTx (*l);
     app_.getSHAMapStore().onLedgerClosed (getValidatedLedger());
+    app_.getPathRequests().updateGraph (l);
+    app_.getOrderBookDB().getBookIndex().onValidatedLedger (l);
     mLedgerHistory.validatedLedger (l, consensusHash);
     app_.getAmendmentTable().doValidatedLedger (l);
     if (!app_.getOPs().isAmendmentBlocked() &&
@@ -295,11 +307,17 @@ LedgerMaster::switchLCL(std::shared_ptr<Ledger const> const& lastClosed)
     if (lastClosed->open())
         LogicError ("The new last closed ledger is open!");
 
+    std::shared_ptr<Ledger const> previous;
     {
         ScopedLockType ml (m_mutex);
+        previous = mClosedLedger.get ();
         mClosedLedger.set (lastClosed);
     }
 
+    // Only the last closed ledger keeps the transactions it was built with
+    if (previous && previous != lastClosed)
+        previous->releaseParsed ();
+
     if (standalone_)
     {
         setFullLedger (lastClosed, true, false);
@@ -572,15 +590,37 @@ LedgerMaster::getFetchPack (LedgerIndex missing,
 
     if (target)
     {
+        std::uint32_t lowest;
+        if (reason == InboundLedger::Reason::SHARD)
+            lowest = app_.getShardStore()->firstLedgerSeq(
+                app_.getShardStore()->seqToShardIndex(missing));
+        else
+        {
+            lowest = app_.getNodeStore().earliestSeq();
+            auto const valid = mValidLedgerSeq.load();
+            if (ledger_history_ != 0 && valid > ledger_history_)
+                lowest = std::max(lowest, valid - ledger_history_);
+        }
+        std::uint32_t const count = missing >= lowest ?
+            std::min<std::uint32_t>(MAX_FETCH_PACK_STREAM,
+                (missing - lowest) + 1) : 1;
+
         protocol::TMGetObjectByHash tmBH;
         tmBH.set_query (true);
         tmBH.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
         tmBH.set_ledgerhash (haveHash->begin(), 32);
+        if (count > 1)
+        {
+            tmBH.set_ledgercount (count);
+            expectFetchPackStream (
+                target->id(), *haveHash, missing - count + 1, missing);
+        }
         auto packet = std::make_shared<Message> (
             tmBH, protocol::mtGET_OBJECTS);
 
         target->send (packet);
-        JLOG(m_journal.trace()) << "Requested fetch pack for " << missing;
+        JLOG(m_journal.trace()) << "Requested fetch pack for " << missing
+            << " (" << count << " ledgers)";
     }
     else
         JLOG (m_journal.debug()) << "No peer for fetch pack";
@@ -1504,6 +1544,7 @@ LedgerMaster::fetchForHistory(
                     *hash, missing, reason);
                 if (!ledger &&
                     missing != fetch_seq_ &&
+                    !fetchPackStreamActive(missing) &&
                     missing > app_.getNodeStore().earliestSeq())
                 {
                     JLOG(m_journal.trace())
@@ -1799,6 +1840,13 @@ LedgerMaster::makeFetchPack (
         return;
     }
 
+    if (request->has_ledgercount() && request->ledgercount() > 1)
+    {
+        makeFetchPackStream (wPeer, request, std::move (haveLedger),
+            std::min<std::uint32_t>(
+                request->ledgercount(), MAX_FETCH_PACK_STREAM));
+        return;
+    }
 
     auto fpAppender = [](
         protocol::TMGetObjectByHash* reply,
@@ -1867,6 +1915,267 @@ LedgerMaster::makeFetchPack (
     }
 }
 
+void
+LedgerMaster::makeFetchPackStream (
+    std::weak_ptr<Peer> const& wPeer,
+    std::shared_ptr<protocol::TMGetObjectByHash> const& request,
+    std::shared_ptr<Ledger const> haveLedger,
+    std::uint32_t remaining)
+{
+    auto fpAppender = [](
+        protocol::TMGetObjectByHash* reply,
+        std::uint32_t ledgerSeq,
+        NodeObjectType type,
+        SHAMapHash const& hash,
+        const Blob& blob)
+    {
+        protocol::TMIndexedObject& newObj = * (reply->add_objects ());
+        newObj.set_ledgerseq (ledgerSeq);
+        newObj.set_hash (hash.as_uint256().begin (), 256 / 8);
+        newObj.set_data (&blob[0], blob.size ());
+        newObj.set_nodetype (type);
+    };
+
+    auto makeReply = [&request] (std::uint32_t count)
+    {
+        protocol::TMGetObjectByHash reply;
+        reply.set_query (false);
+        if (request->has_seq ())
+            reply.set_seq (request->seq ());
+        reply.set_ledgerhash (request->ledgerhash ());
+        reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
+        reply.set_ledgercount (count);
+        return reply;
+    };
+
+    // However we stop, unless another job picks the stream up, the peer
+    // must be told it is over so it can ask someone else.
+    bool ended = false;
+
+    try
+    {
+        int batch = 0;
+        auto wantLedger = getLedgerByHash (haveLedger->info().parentHash);
+
+        while (wantLedger && remaining != 0)
+        {
+            auto peer = wPeer.lock ();
+            if (!peer)
+                return;
+
+            if (isStopping())
+                break;
+
+            if (batch++ == FETCH_PACK_STREAM_BATCH)
+            {
+                // Yield so other jobs can run, then pick up where we left off
+                if (app_.getFeeTrack ().isLoadedLocal ())
+                    break;
+
+                ended = app_.getJobQueue ().addJob (
+                    jtPACK, "MakeFetchPackStream",
+                    [this, wPeer, request, haveLedger, remaining] (Job&)
+                    {
+                        makeFetchPackStream (
+                            wPeer, request, haveLedger, remaining);
+                    });
+                break;
+            }
+
+            std::uint32_t const lSeq = wantLedger->info().seq;
+
+            auto reply = makeReply (--remaining);
+
+            protocol::TMIndexedObject& newObj = *reply.add_objects ();
+            newObj.set_hash (wantLedger->info().hash.data(), 256 / 8);
+            Serializer s (256);
+            s.add32 (HashPrefix::ledgerMaster);
+            addRaw(wantLedger->info(), s);
+            newObj.set_data (s.getDataPtr (), s.getLength ());
+            newObj.set_ledgerseq (lSeq);
+            newObj.set_nodetype (hotLEDGER);
+
+            wantLedger->stateMap().getFetchPack
+                (&haveLedger->stateMap(), true,
+                    std::numeric_limits<int>::max(),
+                    std::bind (fpAppender, &reply, lSeq, hotACCOUNT_NODE,
+                        std::placeholders::_1, std::placeholders::_2));
+
+            if (wantLedger->info().txHash.isNonZero ())
+                wantLedger->txMap().getFetchPack (
+                    nullptr, true, std::numeric_limits<int>::max(),
+                    std::bind (fpAppender, &reply, lSeq, hotTRANSACTION_NODE,
+                        std::placeholders::_1, std::placeholders::_2));
+
+            haveLedger = std::move (wantLedger);
+            wantLedger = getLedgerByHash (haveLedger->info().parentHash);
+
+            if (!wantLedger || remaining == 0)
+            {
+                reply.set_streamend (true);
+                ended = true;
+            }
+
+            JLOG(m_journal.debug())
+                << "Streaming fetch pack for " << lSeq << " with "
+                << reply.objects ().size () << " nodes";
+            peer->send (
+                std::make_shared<Message> (reply, protocol::mtGET_OBJECTS));
+        }
+    }
+    catch (std::exception const&)
+    {
+        JLOG(m_journal.warn()) << "Exception streaming fetch pack";
+    }
+
+    if (!ended)
+    {
+        if (auto peer = wPeer.lock ())
+        {
+            auto reply = makeReply (0);
+            reply.set_streamend (true);
+            peer->send (
+                std::make_shared<Message> (reply, protocol::mtGET_OBJECTS));
+        }
+    }
+}
+
+void
+LedgerMaster::expectFetchPackStream (Peer::id_t peer,
+    uint256 const& haveLedgerHash, LedgerIndex first, LedgerIndex last)
+{
+    auto const now = std::chrono::steady_clock::now();
+    ScopedLockType sl (m_mutex);
+
+    // Forget streams that were never ended
+    for (auto iter = fetch_streams_.begin(); iter != fetch_streams_.end();)
+    {
+        if (now >= iter->second.time + FETCH_PACK_STREAM_TIMEOUT)
+            iter = fetch_streams_.erase (iter);
+        else
+            ++iter;
+    }
+
+    fetch_streams_[{peer, haveLedgerHash}] = {first, last, now};
+}
+
+void
+LedgerMaster::endFetchPackStream (
+    Peer::id_t peer, uint256 const& haveLedgerHash)
+{
+    ScopedLockType sl (m_mutex);
+    fetch_streams_.erase ({peer, haveLedgerHash});
+}
+
+bool
+LedgerMaster::gotFetchPackStream (
+    std::shared_ptr<protocol::TMGetObjectByHash> const& packet,
+    Peer::id_t peer)
+{
+    if (!packet->has_ledgerhash() ||
+        packet->ledgerhash().size() != uint256::bytes)
+    {
+        JLOG(m_journal.warn())
+            << "Malformed fetch pack stream from peer " << peer;
+        return false;
+    }
+    uint256 const haveLedgerHash {packet->ledgerhash()};
+
+    std::pair<LedgerIndex, LedgerIndex> range;
+    {
+        ScopedLockType sl (m_mutex);
+        auto const iter = fetch_streams_.find ({peer, haveLedgerHash});
+        if (iter == fetch_streams_.end())
+        {
+            JLOG(m_journal.info())
+                << "Unsolicited fetch pack stream from peer " << peer;
+            return false;
+        }
+        range = {iter->second.first, iter->second.last};
+    }
+
+    // Check the whole message before storing any of it
+    for (auto const& obj : packet->objects())
+    {
+        if (!obj.has_hash() || obj.hash().size() != uint256::bytes ||
+            !obj.has_ledgerseq() ||
+            obj.ledgerseq() < range.first || obj.ledgerseq() > range.second)
+        {
+            JLOG(m_journal.warn())
+                << "Malformed fetch pack stream from peer " << peer;
+            return false;
+        }
+
+        if (uint256 {obj.hash()} != sha512Half(makeSlice(obj.data())))
+        {
+            JLOG(m_journal.warn())
+                << "Bad node in fetch pack stream for " << obj.ledgerseq();
+            return false;
+        }
+    }
+
+    auto& db = app_.getNodeStore();
+    std::uint32_t seq = 0;
+    bool progress = false;
+    bool want = false;
+    std::size_t stored = 0;
+
+    for (auto const& obj : packet->objects())
+    {
+        if (obj.ledgerseq() != seq)
+        {
+            seq = obj.ledgerseq();
+            want = !haveLedger (seq);
+            progress = progress || want;
+        }
+
+        if (!want)
+            continue;
+
+        auto type = hotUNKNOWN;
+        if (obj.has_nodetype())
+        {
+            switch (obj.nodetype())
+            {
+            case hotLEDGER:
+            case hotACCOUNT_NODE:
+            case hotTRANSACTION_NODE:
+                type = static_cast<NodeObjectType>(obj.nodetype());
+                break;
+            default:
+                break;
+            }
+        }
+        db.store (type, Blob (obj.data().begin(), obj.data().end()),
+            uint256 {obj.hash()}, seq);
+        ++stored;
+    }
+
+    JLOG(m_journal.debug())
+        << "Stored " << stored << " nodes from fetch pack stream for " << seq
+        << (packet->streamend() ? " (end)" : "");
+
+    if (packet->streamend())
+        endFetchPackStream (peer, haveLedgerHash);
+
+    gotFetchPack (progress, seq);
+    return true;
+}
+
+bool
+LedgerMaster::fetchPackStreamActive (LedgerIndex seq) const
+{
+    auto const now = std::chrono::steady_clock::now();
+    ScopedLockType sl (m_mutex);
+    return std::any_of (fetch_streams_.begin(), fetch_streams_.end(),
+        [seq, now](auto const& stream)
+        {
+            return seq >= stream.second.first &&
+                seq <= stream.second.last &&
+                now < stream.second.time + FETCH_PACK_STREAM_TIMEOUT;
+        });
+}
+
 std::size_t
 LedgerMaster::getFetchPackCacheSize () const
 {
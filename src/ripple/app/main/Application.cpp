@@ -31,6 +31,7 @@
 #include <ripple/basics/ResolverAsio.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/basics/Sustain.h>
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/PerfLog.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/nodestore/DummyScheduler.h>
@@ -41,6 +42,7 @@
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/resource/Fees.h>
+#include <ripple/shamap/TreeNodeSnapshot.h>
 #include <ripple/beast/asio/io_latency_probe.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <boost/asio/steady_timer.hpp>
@@ -67,6 +69,7 @@ private:
     FullBelowCache fullbelow_;
     NodeStore::Database& db_;
     bool const shardBacked_;
+    LatencyHistogram fetchLatency_;
     beast::Journal j_;
 
     LedgerIndex maxSeq = 0;
@@ -157,6 +160,12 @@ public:
         return shardBacked_;
     }
 
+    LatencyHistogram&
+    fetchLatency() override
+    {
+        return fetchLatency_;
+    }
+
     void
     missing_node (std::uint32_t seq) override
     {
@@ -287,6 +296,7 @@ public:
 
     beast::Journal m_journal;
     std::unique_ptr<perf::PerfLog> perfLog_;
+    perf::CloseProfiler closeProfiler_;
     Application::MutexType m_masterMutex;
 
     TransactionMaster m_txMaster;
@@ -334,6 +344,10 @@ public:
     boost::asio::steady_timer entropyTimer_;
     bool startTimers_;
 
+    TreeNodeSnapshotSetup nodeSnapshot_;
+    std::chrono::steady_clock::time_point lastNodeSnapshot_;
+    std::mutex nodeSnapshotMutex_;
+
     std::unique_ptr <DatabaseCon> mTxnDB;
     std::unique_ptr <DatabaseCon> mLedgerDB;
     std::unique_ptr <DatabaseCon> mWalletDB;
@@ -351,6 +365,7 @@ public:
     std::unique_ptr <ResolverAsio> m_resolver;
 
     io_latency_sampler m_io_latency_sampler;
+    std::vector<std::unique_ptr<io_latency_sampler>> shardLatencySamplers_;
 
 
     static
@@ -370,7 +385,7 @@ public:
             std::unique_ptr<Logs> logs,
             std::unique_ptr<TimeKeeper> timeKeeper)
         : RootStoppable ("Application")
-        , BasicApp (numberOfThreads(*config))
+        , BasicApp (numberOfThreads(*config), config->IO_SHARDS)
         , config_ (std::move(config))
         , logs_ (std::move(logs))
         , timeKeeper_ (std::move(timeKeeper))
@@ -381,6 +396,8 @@ public:
             perf::setup_PerfLog(config_->section("perf"), config_->CONFIG_DIR),
             *this, logs_->journal("PerfLog"), [this] () { signalStop(); }))
 
+        , closeProfiler_ (64)
+
         , m_txMaster (*this)
 
         , m_nodeStoreScheduler (*this)
@@ -491,6 +508,16 @@ public:
         , m_io_latency_sampler (m_collectorManager->collector()->make_event ("ios_latency"),
             logs_->journal("Application"), std::chrono::milliseconds (100), get_io_service())
     {
+        for (std::size_t i = 0; i < io_shards(); ++i)
+        {
+            shardLatencySamplers_.push_back (
+                std::make_unique<io_latency_sampler> (
+                    m_collectorManager->collector()->make_event (
+                        "ios_latency_shard_" + std::to_string (i)),
+                    logs_->journal("Application"),
+                    std::chrono::milliseconds (100), get_io_shard (i)));
+        }
+
         if (shardStore_)
             sFamily_ = std::make_unique<detail::AppFamily>(
                 *this, *shardStore_, *m_collectorManager);
@@ -573,9 +600,26 @@ public:
         return get_io_service();
     }
 
+    boost::asio::io_service& getIOShard () override
+    {
+        return next_io_service();
+    }
+
     std::chrono::milliseconds getIOLatency () override
     {
-        return m_io_latency_sampler.get ();
+        auto latency = m_io_latency_sampler.get ();
+        for (auto const& sampler : shardLatencySamplers_)
+            latency = std::max (latency, sampler->get ());
+        return latency;
+    }
+
+    std::vector<std::chrono::milliseconds> getIOShardLatencies () override
+    {
+        std::vector<std::chrono::milliseconds> latencies;
+        latencies.reserve (shardLatencySamplers_.size ());
+        for (auto const& sampler : shardLatencySamplers_)
+            latencies.push_back (sampler->get ());
+        return latencies;
     }
 
     LedgerMaster& getLedgerMaster () override
@@ -614,6 +658,11 @@ public:
         return *perfLog_;
     }
 
+    perf::CloseProfiler& getCloseProfiler () override
+    {
+        return closeProfiler_;
+    }
+
     NodeCache& getTempNodeCache () override
     {
         return m_tempNodeCache;
@@ -819,6 +868,8 @@ public:
         }
 
         m_io_latency_sampler.start();
+        for (auto& sampler : shardLatencySamplers_)
+            sampler->start();
 
         m_resolver->start ();
     }
@@ -828,8 +879,12 @@ public:
         JLOG(m_journal.debug()) << "Application stopping";
 
         m_io_latency_sampler.cancel_async ();
+        for (auto& sampler : shardLatencySamplers_)
+            sampler->cancel_async ();
 
         m_io_latency_sampler.cancel ();
+        for (auto& sampler : shardLatencySamplers_)
+            sampler->cancel ();
 
         m_resolver->stop_async ();
 
@@ -861,6 +916,8 @@ public:
         mValidations.flush ();
         JLOG(m_journal.debug()) << "Validations flushed";
 
+        saveNodeSnapshot ();
+
         validatorSites_->stop ();
 
         validatorManifests_->save (getWalletDB (), "ValidatorManifests",
@@ -1019,9 +1076,31 @@ public:
             sFamily_->treecache().sweep();
         cachedSLEs_.expire();
 
+        if (nodeSnapshot_.interval.count() != 0 &&
+            std::chrono::steady_clock::now() >=
+                lastNodeSnapshot_ + nodeSnapshot_.interval)
+        {
+            // Writing the snapshot can take a while, don't hold up the sweep
+            lastNodeSnapshot_ = std::chrono::steady_clock::now();
+            m_jobQueue->addJob (jtWRITE, "saveNodeSnapshot",
+                [this] (Job&) { saveNodeSnapshot (); });
+        }
+
         setSweepTimer();
     }
 
+    void saveNodeSnapshot ()
+    {
+        if (nodeSnapshot_.path.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock (nodeSnapshotMutex_);
+        auto const validated = m_ledgerMaster->getValidatedLedger();
+        saveTreeNodeSnapshot (nodeSnapshot_, family(),
+            validated ? &validated->stateMap() : nullptr,
+            logs_->journal("TreeNodeSnapshot"));
+    }
+
     LedgerIndex getMaxDisallowedLedger() override
     {
         return maxDisallowedLedger_;
@@ -1222,6 +1301,17 @@ bool ApplicationImp::setup()
     family().treecache().setTargetSize(config_->getSize (siTreeCacheSize));
     family().treecache().setTargetAge(
         seconds{config_->getSize(siTreeCacheAge)});
+
+    if (!config_->standalone())
+    {
+        nodeSnapshot_ = setup_TreeNodeSnapshot (
+            config_->section ("node_snapshot"),
+            config_->legacy ("database_path"));
+        loadTreeNodeSnapshot (nodeSnapshot_, family(),
+            logs_->journal("TreeNodeSnapshot"));
+        lastNodeSnapshot_ = std::chrono::steady_clock::now();
+    }
+
     if (shardStore_)
     {
         shardStore_->tune(config_->getSize(siNodeCacheSize),
@@ -12,13 +12,14 @@
 #include <boost/asio.hpp>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
 namespace unl { class Manager; }
 namespace Resource { class Manager; }
 namespace NodeStore { class Database; class DatabaseShard; }
-namespace perf { class PerfLog; }
+namespace perf { class PerfLog; class CloseProfiler; }
 
 class AmendmentTable;
 class CachedSLEs;
@@ -90,6 +91,11 @@ public:
     boost::asio::io_service&
     getIOService () = 0;
 
+    /** The io_service to run a new peer or client connection on. */
+    virtual
+    boost::asio::io_service&
+    getIOShard () = 0;
+
     virtual CollectorManager&           getCollectorManager () = 0;
     virtual Family&                     family() = 0;
     virtual Family*                     shardFamily() = 0;
@@ -123,6 +129,7 @@ public:
     virtual OrderBookDB&            getOrderBookDB () = 0;
     virtual TransactionMaster&      getMasterTransaction () = 0;
     virtual perf::PerfLog&          getPerfLog () = 0;
+    virtual perf::CloseProfiler&    getCloseProfiler () = 0;
 
     virtual
     std::pair<PublicKey, SecretKey> const&
@@ -142,10 +149,16 @@ public:
     virtual DatabaseCon&            getTxnDB () = 0;
     virtual DatabaseCon&            getLedgerDB () = 0;
 
+    /** The worst latency of the main io_service and its shards. */
     virtual
     std::chrono::milliseconds
     getIOLatency () = 0;
 
+    /** The latency of each io_service shard. */
+    virtual
+    std::vector<std::chrono::milliseconds>
+    getIOShardLatencies () = 0;
+
     virtual bool serverOkay (std::string& reason) = 0;
 
     virtual beast::Journal journal (std::string const& name) = 0;
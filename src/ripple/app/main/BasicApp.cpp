@@ -1,9 +1,33 @@
-
-
 #include <ripple/app/main/BasicApp.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 
-BasicApp::BasicApp(std::size_t numberOfThreads)
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Keep the calling thread on one processor, where supported
+void
+pinToProcessor(std::size_t n)
+{
+#ifdef __linux__
+    auto const processors = std::thread::hardware_concurrency();
+    if (processors == 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(n % processors, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) n;
+#endif
+}
+
+}
+
+BasicApp::BasicApp(std::size_t numberOfThreads, std::size_t numberOfShards)
 {
     work_.emplace (io_service_);
     threads_.reserve(numberOfThreads);
@@ -16,17 +40,31 @@ BasicApp::BasicApp(std::size_t numberOfThreads)
                         std::to_string(numberOfThreads));
                 this->io_service_.run();
             });
+
+    shards_.reserve(numberOfShards);
+    for (std::size_t i = 0; i < numberOfShards; ++i)
+    {
+        auto shard = std::make_unique<Shard>();
+        shard->work.emplace (shard->io_service);
+        shard->thread = std::thread(
+            [ios = &shard->io_service, i]()
+            {
+                beast::setCurrentThreadName(
+                    std::string("io_shard #") + std::to_string(i));
+                pinToProcessor(i);
+                ios->run();
+            });
+        shards_.push_back(std::move(shard));
+    }
 }
 
 BasicApp::~BasicApp()
 {
     work_ = boost::none;
+    for (auto& shard : shards_)
+        shard->work = boost::none;
     for (auto& _ : threads_)
         _.join();
+    for (auto& shard : shards_)
+        shard->thread.join();
 }
-
-
-
-
-
-
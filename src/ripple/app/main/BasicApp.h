@@ -1,22 +1,31 @@
-
-
 #ifndef RIPPLE_APP_BASICAPP_H_INCLUDED
 #define RIPPLE_APP_BASICAPP_H_INCLUDED
 
 #include <boost/asio/io_service.hpp>
 #include <boost/optional.hpp>
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <vector>
 
 class BasicApp
 {
 private:
+    struct Shard
+    {
+        boost::asio::io_service io_service;
+        boost::optional<boost::asio::io_service::work> work;
+        std::thread thread;
+    };
+
     boost::optional<boost::asio::io_service::work> work_;
     std::vector<std::thread> threads_;
     boost::asio::io_service io_service_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::size_t> nextShard_ {0};
 
 protected:
-    BasicApp(std::size_t numberOfThreads);
+    BasicApp(std::size_t numberOfThreads, std::size_t numberOfShards = 0);
     ~BasicApp();
 
 public:
@@ -25,14 +34,32 @@ public:
     {
         return io_service_;
     }
-};
-
-#endif
-
-
-
 
+    /** The number of io_service shards, each run by one thread. */
+    std::size_t
+    io_shards() const
+    {
+        return shards_.size();
+    }
 
+    boost::asio::io_service&
+    get_io_shard(std::size_t i)
+    {
+        return shards_[i]->io_service;
+    }
 
+    /** The io_service for a new connection.
 
+        Connections are spread over the shards in turn. Without shards,
+        they share the main io_service.
+    */
+    boost::asio::io_service&
+    next_io_service()
+    {
+        if (shards_.empty())
+            return io_service_;
+        return get_io_shard(nextShard_++ % shards_.size());
+    }
+};
 
+#endif
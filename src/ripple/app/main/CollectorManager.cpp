@@ -1,6 +1,7 @@
 
 
 #include <ripple/app/main/CollectorManager.h>
+#include <ripple/basics/contract.h>
 #include <memory>
 
 namespace ripple {
@@ -11,6 +12,7 @@ class CollectorManagerImp
 public:
     beast::Journal m_journal;
     beast::insight::Collector::ptr m_collector;
+    std::shared_ptr<beast::insight::AggregatedCollector> m_aggregated;
     std::unique_ptr <beast::insight::Groups> m_groups;
 
     CollectorManagerImp (Section const& params,
@@ -27,6 +29,22 @@ public:
 
             m_collector = beast::insight::StatsDCollector::New (address, prefix, journal);
         }
+        else if (server == "aggregated")
+        {
+            boost::optional<beast::IP::Endpoint> address;
+            std::string const& a (get<std::string> (params, "address"));
+            if (! a.empty ())
+                address = beast::IP::Endpoint::from_string (a);
+            std::string const& prefix (get<std::string> (params, "prefix"));
+            std::chrono::milliseconds const interval (
+                get<std::uint32_t> (params, "interval", 1000));
+            if (interval.count () == 0)
+                Throw<std::runtime_error> (
+                    "[insight] interval must be greater than zero");
+            m_aggregated = beast::insight::AggregatedCollector::New (
+                prefix, interval, address, journal);
+            m_collector = m_aggregated;
+        }
         else
         {
             m_collector = beast::insight::NullCollector::New ();
@@ -46,6 +64,13 @@ public:
     {
         return m_groups->get (name);
     }
+
+    boost::optional<std::string> prometheus () override
+    {
+        if (! m_aggregated)
+            return boost::none;
+        return m_aggregated->prometheus ();
+    }
 };
 
 
@@ -5,6 +5,7 @@
 
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/beast/insight/Insight.h>
+#include <boost/optional.hpp>
 
 namespace ripple {
 
@@ -19,6 +20,13 @@ public:
     virtual beast::insight::Collector::ptr const& collector () = 0;
     virtual beast::insight::Group::ptr const& group (
         std::string const& name) = 0;
+
+    /** The last metrics snapshot in the Prometheus text format.
+
+        Only the aggregated collector keeps snapshots; with any other
+        collector this returns `boost::none`.
+    */
+    virtual boost::optional<std::string> prometheus () = 0;
 };
 
 }
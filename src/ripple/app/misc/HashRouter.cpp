@@ -1,51 +1,112 @@
 
 
 #include <ripple/app/misc/HashRouter.h>
+#include <tuple>
 
 namespace ripple {
 
+namespace {
+
+using namespace std::chrono_literals;
+
+// The start of the second holding a time
+Stopwatch::time_point
+bucket (Stopwatch::time_point t)
+{
+    return Stopwatch::time_point (std::chrono::duration_cast<
+        std::chrono::seconds> (t.time_since_epoch ()));
+}
+
+}
+
 auto
-HashRouter::emplace (uint256 const& key)
+HashRouter::emplace (Shard& shard, uint256 const& key,
+        std::unique_lock<std::mutex>& lock)
     -> std::pair<Entry&, bool>
 {
-    auto iter = suppressionMap_.find (key);
+    auto const now = clock_.now ();
+
+    auto iter = shard.entries.find (key);
+    bool inserted = false;
+    if (iter == shard.entries.end ())
+    {
+        // Expiry visits every shard, so it runs without this one locked
+        lock.unlock ();
+        expire (now);
+        lock.lock ();
+
+        std::tie (iter, inserted) = shard.entries.emplace (key, Entry ());
+        if (inserted)
+            iter->second.touched = Stopwatch::time_point::min ();
+    }
 
-    if (iter != suppressionMap_.end ())
+    auto& entry = iter->second;
+    if (now >= entry.touched + 1s)
     {
-        suppressionMap_.touch(iter);
-        return std::make_pair(
-            std::ref(iter->second), false);
+        auto const b = bucket (now);
+        if (shard.buckets.empty () || shard.buckets.back ().first < b)
+            shard.buckets.emplace_back (b, std::vector<uint256> ());
+        entry.touched = shard.buckets.back ().first;
+        shard.buckets.back ().second.push_back (key);
     }
 
-    expire(suppressionMap_, holdTime_);
+    return {entry, inserted};
+}
+
+void
+HashRouter::expire (Stopwatch::time_point now)
+{
+    auto const expired = bucket (now) - holdTime_;
+    if (expired < nextExpiry_.load ())
+        return;
+
+    std::unique_lock<std::mutex> sweep (expiryMutex_, std::try_to_lock);
+    if (! sweep.owns_lock ())
+        return;
 
-    return std::make_pair(std::ref(
-        suppressionMap_.emplace (
-            key, Entry ()).first->second),
-                true);
+    for (auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock (shard.mutex);
+        while (! shard.buckets.empty () &&
+            shard.buckets.front ().first <= expired)
+        {
+            for (auto const& key : shard.buckets.front ().second)
+            {
+                auto const iter = shard.entries.find (key);
+                if (iter != shard.entries.end () &&
+                        iter->second.touched <= expired)
+                    shard.entries.erase (iter);
+            }
+            shard.buckets.pop_front ();
+        }
+    }
+    nextExpiry_ = expired + 1s;
 }
 
 void HashRouter::addSuppression (uint256 const& key)
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    emplace (key);
+    emplace (shard, key, lock);
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer)
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto result = emplace(key);
+    auto result = emplace (shard, key, lock);
     result.first.addPeer(peer);
     return result.second;
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer, int& flags)
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto result = emplace(key);
+    auto result = emplace (shard, key, lock);
     auto& s = result.first;
     s.addPeer (peer);
     flags = s.getFlags ();
@@ -55,29 +116,32 @@ bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer, int&
 bool HashRouter::shouldProcess (uint256 const& key, PeerShortID peer,
     int& flags, std::chrono::seconds tx_interval)
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto result = emplace(key);
+    auto result = emplace (shard, key, lock);
     auto& s = result.first;
     s.addPeer (peer);
     flags = s.getFlags ();
-    return s.shouldProcess (suppressionMap_.clock().now(), tx_interval);
+    return s.shouldProcess (clock_.now(), tx_interval);
 }
 
 int HashRouter::getFlags (uint256 const& key)
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    return emplace(key).first.getFlags ();
+    return emplace (shard, key, lock).first.getFlags ();
 }
 
 bool HashRouter::setFlags (uint256 const& key, int flags)
 {
     assert (flags != 0);
 
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto& s = emplace(key).first;
+    auto& s = emplace (shard, key, lock).first;
 
     if ((s.getFlags () & flags) == flags)
         return false;
@@ -90,11 +154,12 @@ auto
 HashRouter::shouldRelay (uint256 const& key)
     -> boost::optional<std::set<PeerShortID>>
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto& s = emplace(key).first;
+    auto& s = emplace (shard, key, lock).first;
 
-    if (!s.shouldRelay(suppressionMap_.clock().now(), holdTime_))
+    if (!s.shouldRelay(clock_.now(), holdTime_))
         return boost::none;
 
     return s.releasePeerSet();
@@ -103,9 +168,10 @@ HashRouter::shouldRelay (uint256 const& key)
 bool
 HashRouter::shouldRecover(uint256 const& key)
 {
-    std::lock_guard <std::mutex> lock(mutex_);
+    auto& shard = shardFor (key);
+    std::unique_lock <std::mutex> lock (shard.mutex);
 
-    auto& s = emplace(key).first;
+    auto& s = emplace (shard, key, lock).first;
 
     return s.shouldRecover(recoverLimit_);
 }
@@ -7,8 +7,16 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/basics/UnorderedContainers.h>
-#include <ripple/beast/container/aged_unordered_map.h>
+#include <boost/container/small_vector.hpp>
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace ripple {
 
@@ -41,8 +49,14 @@ private:
 
         void addPeer (PeerShortID peer)
         {
-            if (peer != 0)
-                peers_.insert (peer);
+            if (peer == 0)
+                return;
+
+            // Kept sorted
+            auto const it = std::lower_bound (
+                peers_.begin (), peers_.end (), peer);
+            if (it == peers_.end () || *it != peer)
+                peers_.insert (it, peer);
         }
 
         int getFlags (void) const
@@ -58,7 +72,9 @@ private:
         
         std::set<PeerShortID> releasePeerSet()
         {
-            return std::move(peers_);
+            std::set<PeerShortID> peers (peers_.begin (), peers_.end ());
+            peers_.clear ();
+            return peers;
         }
 
         
@@ -85,9 +101,12 @@ private:
              return true;
         }
 
+        // The start of the second the entry was last used in
+        Stopwatch::time_point touched;
+
     private:
         int flags_ = 0;
-        std::set <PeerShortID> peers_;
+        boost::container::small_vector <PeerShortID, 8> peers_;
         boost::optional<Stopwatch::time_point> relayed_;
         boost::optional<Stopwatch::time_point> processed_;
         std::uint32_t recoveries_ = 0;
@@ -108,7 +127,7 @@ public:
 
     HashRouter (Stopwatch& clock, std::chrono::seconds entryHoldTimeInSeconds,
         std::uint32_t recoverLimit)
-        : suppressionMap_(clock)
+        : clock_ (clock)
         , holdTime_ (entryHoldTimeInSeconds)
         , recoverLimit_ (recoverLimit + 1u)
     {
@@ -140,12 +159,40 @@ public:
     bool shouldRecover(uint256 const& key);
 
 private:
-    std::pair<Entry&, bool> emplace (uint256 const&);
+    static std::size_t constexpr shardCount = 16;
+
+    /** Entries whose keys fall in one shard.
+
+        Each key is listed in the bucket for every second it was used in,
+        oldest first. Entries are expired a bucket at a time, skipping
+        those used again since.
+    */
+    struct Shard
+    {
+        std::mutex mutex;
+        hardened_hash_map<uint256, Entry> entries;
+        std::deque<std::pair<Stopwatch::time_point,
+            std::vector<uint256>>> buckets;
+    };
+
+    Shard& shardFor (uint256 const& key)
+    {
+        return shards_[*key.begin () % shardCount];
+    }
+
+    std::pair<Entry&, bool> emplace (Shard& shard, uint256 const& key,
+        std::unique_lock<std::mutex>& lock);
+
+    void expire (Stopwatch::time_point now);
+
+    Stopwatch& clock_;
 
-    std::mutex mutable mutex_;
+    std::array<Shard, shardCount> shards_;
 
-    beast::aged_unordered_map<uint256, Entry, Stopwatch::clock_type,
-        hardened_hash<strong_hash>> suppressionMap_;
+    // Expiry runs at most once a second, by one thread at a time
+    std::mutex expiryMutex_;
+    std::atomic<Stopwatch::time_point> nextExpiry_ {
+        Stopwatch::time_point::min ()};
 
     std::chrono::seconds const holdTime_;
 
@@ -16,6 +16,7 @@
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
+#include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
@@ -23,6 +24,7 @@
 #include <ripple/app/misc/impl/AccountTxPaging.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/base64.h>
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/mulDiv.h>
 #include <ripple/basics/PerfLog.h>
 #include <ripple/basics/safe_cast.h>
@@ -31,12 +33,14 @@
 #include <ripple/crypto/csprng.h>
 #include <ripple/crypto/RFC1751.h>
 #include <ripple/json/to_string.h>
+#include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/overlay/Cluster.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/BuildInfo.h>
 #include <ripple/resource/ResourceManager.h>
 #include <ripple/rpc/DeliveredAmount.h>
+#include <ripple/rpc/handlers/GetCounts.h>
 #include <ripple/beast/rfc2616.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/beast/utility/rngfill.h>
@@ -1963,6 +1967,14 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin, bool counters)
     info[jss::io_latency_ms] = static_cast<Json::UInt> (
         app_.getIOLatency().count());
 
+    auto const shardLatencies = app_.getIOShardLatencies();
+    if (! shardLatencies.empty())
+    {
+        auto& latencies = info[jss::io_shard_latency_ms] = Json::arrayValue;
+        for (auto const& latency : shardLatencies)
+            latencies.append (static_cast<Json::UInt> (latency.count()));
+    }
+
     if (admin)
     {
         if (!app_.getValidationPublicKey().empty())
@@ -2019,7 +2031,24 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin, bool counters)
 
 
     if (admin)
+    {
         info[jss::load] = m_job_queue.getJson ();
+        info[jss::latency] = getLatencyJson (app_);
+    }
+
+    if (admin)
+    {
+        auto rotation = app_.getSHAMapStore ().getJson ();
+        if (! rotation.isNull ())
+            info[jss::online_delete] = std::move (rotation);
+
+        if (auto shardStore = app_.getShardStore ())
+        {
+            auto progress = shardStore->getProgress ();
+            if (! progress.isNull ())
+                info[jss::shard_progress] = std::move (progress);
+        }
+    }
 
     auto const escalationMetrics = app_.getTxQ().getMetrics(
         *app_.openLedger().current());
@@ -2220,6 +2249,8 @@ void NetworkOPsImp::pubProposedTransaction (
 void NetworkOPsImp::pubLedger (
     std::shared_ptr<ReadView const> const& lpAccepted)
 {
+    perf::CloseProfiler::Scope scope (app_.getCloseProfiler (),
+        lpAccepted->info().seq, "pubLedger");
 
     std::shared_ptr<AcceptedLedger> alpAccepted =
         app_.getAcceptedLedgerCache().fetch (lpAccepted->info().hash);
@@ -2800,6 +2831,110 @@ void NetworkOPsImp::getBookPage (
     auto const rate = transferRate(view, book.out.account);
     auto viewJ = app_.journal ("View");
 
+    // Add one offer at the given directory rate to the page
+    auto addOffer = [&](std::shared_ptr<SLE const> const& sleOffer,
+        STAmount const& dirRate)
+    {
+        auto const uOfferOwnerID =
+                sleOffer->getAccountID (sfAccount);
+        auto const& saTakerGets =
+                sleOffer->getFieldAmount (sfTakerGets);
+        auto const& saTakerPays =
+                sleOffer->getFieldAmount (sfTakerPays);
+        STAmount saOwnerFunds;
+        bool firstOwnerOffer (true);
+
+        if (book.out.account == uOfferOwnerID)
+        {
+            saOwnerFunds    = saTakerGets;
+        }
+        else if (bGlobalFreeze)
+        {
+            saOwnerFunds.clear (book.out);
+        }
+        else
+        {
+            auto umBalanceEntry  = umBalance.find (uOfferOwnerID);
+            if (umBalanceEntry != umBalance.end ())
+            {
+
+                saOwnerFunds    = umBalanceEntry->second;
+                firstOwnerOffer = false;
+            }
+            else
+            {
+
+                saOwnerFunds = accountHolds (view,
+                    uOfferOwnerID, book.out.currency,
+                        book.out.account, fhZERO_IF_FROZEN, viewJ);
+
+                if (saOwnerFunds < beast::zero)
+                {
+
+                    saOwnerFunds.clear ();
+                }
+            }
+        }
+
+        Json::Value jvOffer = sleOffer->getJson (JsonOptions::none);
+
+        STAmount saTakerGetsFunded;
+        STAmount saOwnerFundsLimit = saOwnerFunds;
+        Rate offerRate = parityRate;
+
+        if (rate != parityRate
+            && uTakerID != book.out.account
+            && book.out.account != uOfferOwnerID)
+        {
+            offerRate = rate;
+            saOwnerFundsLimit = divide (
+                saOwnerFunds, offerRate);
+        }
+
+        if (saOwnerFundsLimit >= saTakerGets)
+        {
+            saTakerGetsFunded   = saTakerGets;
+        }
+        else
+        {
+
+            saTakerGetsFunded = saOwnerFundsLimit;
+
+            saTakerGetsFunded.setJson (jvOffer[jss::taker_gets_funded]);
+            std::min (
+                saTakerPays, multiply (
+                    saTakerGetsFunded, dirRate, saTakerPays.issue ())).setJson
+                    (jvOffer[jss::taker_pays_funded]);
+        }
+
+        STAmount saOwnerPays = (parityRate == offerRate)
+            ? saTakerGetsFunded
+            : std::min (
+                saOwnerFunds,
+                multiply (saTakerGetsFunded, offerRate));
+
+        umBalance[uOfferOwnerID]    = saOwnerFunds - saOwnerPays;
+
+        Json::Value& jvOf = jvOffers.append (jvOffer);
+        jvOf[jss::quality] = dirRate.getText ();
+
+        if (firstOwnerOffer)
+            jvOf[jss::owner_funds] = saOwnerFunds.getText ();
+    };
+
+    // Closed ledgers are served from the shared order book index
+    if (auto const offers =
+        app_.getOrderBookDB().getBookIndex().getOffers(view, book))
+    {
+        for (auto const& offer : *offers)
+        {
+            if (iLimit-- == 0)
+                break;
+            addOffer(offer.sle, amountFromQuality(offer.quality));
+        }
+        return;
+    }
+
     while (! bDone && iLimit-- > 0)
     {
         if (bDirectAdvance)
@@ -2840,91 +2975,7 @@ void NetworkOPsImp::getBookPage (
 
             if (sleOffer)
             {
-                auto const uOfferOwnerID =
-                        sleOffer->getAccountID (sfAccount);
-                auto const& saTakerGets =
-                        sleOffer->getFieldAmount (sfTakerGets);
-                auto const& saTakerPays =
-                        sleOffer->getFieldAmount (sfTakerPays);
-                STAmount saOwnerFunds;
-                bool firstOwnerOffer (true);
-
-                if (book.out.account == uOfferOwnerID)
-                {
-                    saOwnerFunds    = saTakerGets;
-                }
-                else if (bGlobalFreeze)
-                {
-                    saOwnerFunds.clear (book.out);
-                }
-                else
-                {
-                    auto umBalanceEntry  = umBalance.find (uOfferOwnerID);
-                    if (umBalanceEntry != umBalance.end ())
-                    {
-
-                        saOwnerFunds    = umBalanceEntry->second;
-                        firstOwnerOffer = false;
-                    }
-                    else
-                    {
-
-                        saOwnerFunds = accountHolds (view,
-                            uOfferOwnerID, book.out.currency,
-                                book.out.account, fhZERO_IF_FROZEN, viewJ);
-
-                        if (saOwnerFunds < beast::zero)
-                        {
-
-                            saOwnerFunds.clear ();
-                        }
-                    }
-                }
-
-                Json::Value jvOffer = sleOffer->getJson (JsonOptions::none);
-
-                STAmount saTakerGetsFunded;
-                STAmount saOwnerFundsLimit = saOwnerFunds;
-                Rate offerRate = parityRate;
-
-                if (rate != parityRate
-                    && uTakerID != book.out.account
-                    && book.out.account != uOfferOwnerID)
-                {
-                    offerRate = rate;
-                    saOwnerFundsLimit = divide (
-                        saOwnerFunds, offerRate);
-                }
-
-                if (saOwnerFundsLimit >= saTakerGets)
-                {
-                    saTakerGetsFunded   = saTakerGets;
-                }
-                else
-                {
-
-                    saTakerGetsFunded = saOwnerFundsLimit;
-
-                    saTakerGetsFunded.setJson (jvOffer[jss::taker_gets_funded]);
-                    std::min (
-                        saTakerPays, multiply (
-                            saTakerGetsFunded, saDirRate, saTakerPays.issue ())).setJson
-                            (jvOffer[jss::taker_pays_funded]);
-                }
-
-                STAmount saOwnerPays = (parityRate == offerRate)
-                    ? saTakerGetsFunded
-                    : std::min (
-                        saOwnerFunds,
-                        multiply (saTakerGetsFunded, offerRate));
-
-                umBalance[uOfferOwnerID]    = saOwnerFunds - saOwnerPays;
-
-                Json::Value& jvOf = jvOffers.append (jvOffer);
-                jvOf[jss::quality] = saDirRate.getText ();
-
-                if (firstOwnerOffer)
-                    jvOf[jss::owner_funds] = saOwnerFunds.getText ();
+                addOffer(sleOffer, saDirRate);
             }
             else
             {
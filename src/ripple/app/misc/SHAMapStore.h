@@ -7,6 +7,7 @@
 #include <ripple/nodestore/Manager.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/core/Stoppable.h>
+#include <ripple/json/json_value.h>
 
 namespace ripple {
 
@@ -30,6 +31,7 @@ public:
         std::uint32_t deleteBatch = 100;
         std::uint32_t backOff = 100;
         std::int32_t ageThreshold = 60;
+        bool incrementalRotation = false;
         Section shardDatabase;
     };
 
@@ -64,6 +66,9 @@ public:
 
     
     virtual int fdlimit() const = 0;
+
+    /** Rotation progress, or null if online deletion is disabled. */
+    virtual Json::Value getJson() = 0;
 };
 
 
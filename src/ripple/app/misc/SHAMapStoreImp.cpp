@@ -2,14 +2,25 @@
 
 
 #include <ripple/app/ledger/TransactionMaster.h>
+#include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStoreImp.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.h>
 #include <ripple/nodestore/impl/DatabaseShardImp.h>
+#include <ripple/protocol/jss.h>
 
 namespace ripple {
+
+// Waiting jobs, pending writes and I/O latency at which incremental
+// rotation pauses for one backOff interval between batches.
+auto constexpr PACE_JOBS = 16;
+auto constexpr PACE_WRITES = 256;
+auto constexpr PACE_LATENCY = std::chrono::milliseconds {10};
+auto constexpr PACE_MAX = std::chrono::milliseconds {2000};
+
 void SHAMapStoreImp::SavedStateDB::init (BasicConfig const& config,
                                          std::string const& dbName)
 {
@@ -309,6 +320,40 @@ SHAMapStoreImp::fdlimit () const
     return fdlimit_;
 }
 
+Json::Value
+SHAMapStoreImp::getJson ()
+{
+    if (! setup_.deleteInterval)
+        return {};
+
+    Json::Value ret (Json::objectValue);
+    ret[jss::incremental] = setup_.incrementalRotation;
+    ret[jss::last_rotated] = state_db_.getState().lastRotated;
+
+    switch (phase_.load())
+    {
+        case Phase::clearing:
+            ret[jss::state] = "clearing";
+            break;
+        case Phase::copying:
+            ret[jss::state] = "copying";
+            break;
+        case Phase::rotating:
+            ret[jss::state] = "rotating";
+            break;
+        case Phase::idle:
+        default:
+            ret[jss::state] = "idle";
+    }
+
+    if (auto const seq = copiedSeq_.load())
+        ret[jss::copied_ledger] = seq;
+    ret[jss::nodes_copied] = std::to_string (nodesCopied_);
+    ret[jss::copy_rate] = std::to_string (copyRate_);
+    ret[jss::pause_ms] = std::to_string (pause_);
+    return ret;
+}
+
 bool
 SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
         SHAMapAbstractNode const& node)
@@ -318,11 +363,106 @@ SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
     {
         if (health())
             return false;
+
+        updateRate (nodeCount);
+        if (setup_.incrementalRotation)
+        {
+            std::this_thread::sleep_for (pace());
+            if (health())
+                return false;
+        }
     }
 
     return true;
 }
 
+void
+SHAMapStoreImp::copyState (Ledger const& ledger)
+{
+    auto const& stateMap = ledger.stateMap();
+    auto const root = stateMap.getHash().as_uint256();
+    if (setup_.incrementalRotation && root == copiedRoot_)
+        return;
+
+    phase_ = Phase::copying;
+    copyStart_ = std::chrono::steady_clock::now();
+    std::uint64_t nodeCount = 0;
+    try
+    {
+        // Everything under the last copied map is already in the
+        // writable backend, so only walk what changed since.
+        std::shared_ptr<SHAMap> have;
+        if (setup_.incrementalRotation && copiedRoot_.isNonZero())
+        {
+            have = std::make_shared<SHAMap> (SHAMapType::STATE,
+                copiedRoot_, app_.family(), stateMap.get_version());
+            if (! have->fetchRoot (SHAMapHash {copiedRoot_}, nullptr))
+                have.reset();
+        }
+
+        auto const copy = std::bind (&SHAMapStoreImp::copyNode, this,
+            std::ref(nodeCount), std::placeholders::_1);
+        if (have)
+            stateMap.snapShot (false)->visitDifferences (have.get(), copy);
+        else
+            stateMap.snapShot (false)->visitNodes (copy);
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        JLOG(journal_.warn()) << "copying ledger " << ledger.info().seq
+            << ": " << e.what();
+        copiedRoot_.zero();
+        healthy_ = false;
+    }
+
+    updateRate (nodeCount);
+    JLOG(journal_.debug()) << "copied ledger " << ledger.info().seq
+        << " nodecount " << nodeCount << " rate " << copyRate_;
+
+    if (health() == Health::ok)
+    {
+        copiedRoot_ = root;
+        copiedSeq_ = ledger.info().seq;
+    }
+}
+
+void
+SHAMapStoreImp::updateRate (std::uint64_t nodeCount)
+{
+    using namespace std::chrono;
+
+    nodesCopied_ = nodeCount;
+    auto const elapsed = duration_cast<milliseconds>(
+        steady_clock::now() - copyStart_).count();
+    if (elapsed > 0)
+        copyRate_ = nodeCount * 1000 / elapsed;
+}
+
+std::chrono::milliseconds
+SHAMapStoreImp::pace()
+{
+    using namespace std::chrono;
+
+    milliseconds const backOff {setup_.backOff};
+    if (! setup_.incrementalRotation)
+        return backOff;
+
+    // Back off in proportion to how busy the server is, and run
+    // flat out when it is idle.
+    auto load =
+        static_cast<double>(app_.getJobQueue().getJobCountGE (jtCLIENT)) /
+            PACE_JOBS +
+        static_cast<double>(dbRotating_->getWriteLoad()) / PACE_WRITES +
+        duration<double>(app_.getIOLatency()) / PACE_LATENCY;
+    if (app_.getFeeTrack().isLoadedLocal())
+        load += 1;
+
+    auto const pause = std::min (PACE_MAX,
+        duration_cast<milliseconds>(backOff * load));
+    pause_ = pause.count();
+    return pause;
+}
+
 void
 SHAMapStoreImp::run()
 {
@@ -346,6 +486,7 @@ SHAMapStoreImp::run()
         {
             std::unique_lock <std::mutex> lock (mutex_);
             working_ = false;
+            phase_ = Phase::idle;
             rendezvous_.notify_all();
             if (stop_)
             {
@@ -368,8 +509,22 @@ SHAMapStoreImp::run()
             state_db_.setLastRotated (lastRotated);
         }
 
-        if (validatedSeq >= lastRotated + setup_.deleteInterval
-                && canDelete_ >= lastRotated - 1)
+        bool const rotate = validatedSeq >= lastRotated + setup_.deleteInterval
+                && canDelete_ >= lastRotated - 1;
+
+        // Keep the writable backend current between rotations so that
+        // rotating only has to copy the last few ledgers' changes.
+        if (! rotate && setup_.incrementalRotation)
+        {
+            copyState (*validatedLedger);
+            if (health() == Health::stopping)
+            {
+                stopped();
+                return;
+            }
+        }
+
+        if (rotate)
         {
             JLOG(journal_.debug()) << "rotating  validatedSeq " << validatedSeq
                     << " lastRotated " << lastRotated << " deleteInterval "
@@ -387,6 +542,7 @@ SHAMapStoreImp::run()
                     ;
             }
 
+            phase_ = Phase::clearing;
             clearPrior (lastRotated);
             switch (health())
             {
@@ -400,13 +556,7 @@ SHAMapStoreImp::run()
                     ;
             }
 
-            std::uint64_t nodeCount = 0;
-            validatedLedger->stateMap().snapShot (
-                    false)->visitNodes (
-                    std::bind (&SHAMapStoreImp::copyNode, this,
-                    std::ref(nodeCount), std::placeholders::_1));
-            JLOG(journal_.debug()) << "copied ledger " << validatedSeq
-                    << " nodecount " << nodeCount;
+            copyState (*validatedLedger);
             switch (health())
             {
                 case Health::stopping:
@@ -433,6 +583,7 @@ SHAMapStoreImp::run()
                     ;
             }
 
+            phase_ = Phase::rotating;
             auto newBackend = makeBackendRotating();
             JLOG(journal_.debug()) << validatedSeq << " new backend "
                     << newBackend->getName();
@@ -463,6 +614,8 @@ SHAMapStoreImp::run()
                 oldBackend = dbRotating_->rotateBackends(
                     std::move(newBackend));
             }
+            copiedRoot_.zero();
+            copiedSeq_ = 0;
             JLOG(journal_.debug()) << "finished rotation " << validatedSeq;
 
             oldBackend->setDeletePath();
@@ -591,8 +744,7 @@ SHAMapStoreImp::clearSql (DatabaseCon& database,
         if (health())
             return true;
         if (min < lastRotated)
-            std::this_thread::sleep_for (
-                    std::chrono::milliseconds (setup_.backOff));
+            std::this_thread::sleep_for (pace());
     }
     JLOG(journal_.debug()) << "finished: " << deleteQuery;
     return true;
@@ -691,8 +843,7 @@ SHAMapStoreImp::clearPrior (LedgerIndex lastRotated)
                 if (health())
                     return;
                 if (rowsAffected >= continueLimit)
-                    std::this_thread::sleep_for(
-                        std::chrono::milliseconds(setup_.backOff));
+                    std::this_thread::sleep_for(pace());
             }
             while (rowsAffected && rowsAffected >= continueLimit);
             JLOG(journal_.debug()) << "finished: " << deleteQuery << ". Deleted "
@@ -804,6 +955,8 @@ setup_SHAMapStore (Config const& c)
     get_if_exists (setup.nodeDatabase, "delete_batch", setup.deleteBatch);
     get_if_exists (setup.nodeDatabase, "backOff", setup.backOff);
     get_if_exists (setup.nodeDatabase, "age_threshold", setup.ageThreshold);
+    get_if_exists (setup.nodeDatabase, "incremental_rotation",
+        setup.incrementalRotation);
 
     setup.shardDatabase = c.section(ConfigSection::shardDatabase());
     return setup;
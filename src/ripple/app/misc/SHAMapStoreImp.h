@@ -31,6 +31,14 @@ private:
         unhealthy
     };
 
+    enum class Phase : std::uint8_t
+    {
+        idle,
+        clearing,
+        copying,
+        rotating
+    };
+
     class SavedStateDB
     {
     public:
@@ -82,6 +90,17 @@ private:
     DatabaseCon* ledgerDb_ = nullptr;
     int fdlimit_ = 0;
 
+    // Root of the last state map known to be entirely in the writable
+    // backend. Only touched by the rotation thread.
+    uint256 copiedRoot_;
+    std::chrono::steady_clock::time_point copyStart_;
+
+    std::atomic<Phase> phase_ {Phase::idle};
+    std::atomic<LedgerIndex> copiedSeq_ {0};
+    std::atomic<std::uint64_t> nodesCopied_ {0};
+    std::atomic<std::uint64_t> copyRate_ {0};
+    std::atomic<std::int64_t> pause_ {0};
+
 public:
     SHAMapStoreImp (Application& app,
             Setup const& setup,
@@ -143,9 +162,13 @@ public:
 
     void rendezvous() const override;
     int fdlimit() const override;
+    Json::Value getJson() override;
 
 private:
     bool copyNode (std::uint64_t& nodeCount, SHAMapAbstractNode const &node);
+    void copyState (Ledger const& ledger);
+    void updateRate (std::uint64_t nodeCount);
+    std::chrono::milliseconds pace();
     void run();
     void dbPaths();
 
@@ -200,6 +200,14 @@ private:
     public:
         boost::intrusive::set_member_hook<> byFeeListHook;
 
+        // Linked while this is the first queued transaction of its account
+        boost::intrusive::set_member_hook<boost::intrusive::link_mode<
+            boost::intrusive::auto_unlink>> byHeadHook;
+
+        // Linked while the transaction has a LastLedgerSequence
+        boost::intrusive::set_member_hook<boost::intrusive::link_mode<
+            boost::intrusive::auto_unlink>> byLastValidHook;
+
         std::shared_ptr<STTx const> txn;
 
         boost::optional<TxConsequences const> consequences;
@@ -221,6 +229,9 @@ private:
         
         static constexpr int retriesAllowed = 10;
 
+        // Orders transactions with the same fee level by arrival
+        std::uint64_t order = 0;
+
     public:
         MaybeTx(std::shared_ptr<STTx const> const&,
             TxID const& txID, std::uint64_t feeLevel,
@@ -242,6 +253,31 @@ private:
         }
     };
 
+    // The order of byFee_, with ties broken by arrival
+    class GreaterFeeEarlier
+    {
+    public:
+        explicit GreaterFeeEarlier() = default;
+
+        bool operator()(const MaybeTx& lhs, const MaybeTx& rhs) const
+        {
+            if (lhs.feeLevel != rhs.feeLevel)
+                return lhs.feeLevel > rhs.feeLevel;
+            return lhs.order < rhs.order;
+        }
+    };
+
+    class EarlierLastValid
+    {
+    public:
+        explicit EarlierLastValid() = default;
+
+        bool operator()(const MaybeTx& lhs, const MaybeTx& rhs) const
+        {
+            return *lhs.lastValid < *rhs.lastValid;
+        }
+    };
+
     
     class TxQAccount
     {
@@ -287,6 +323,26 @@ private:
         < MaybeTx, FeeHook,
         boost::intrusive::compare <GreaterFee> >;
 
+    using HeadHook = boost::intrusive::member_hook
+        <MaybeTx, boost::intrusive::set_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink>>,
+        &MaybeTx::byHeadHook>;
+
+    using HeadMultiSet = boost::intrusive::multiset
+        < MaybeTx, HeadHook,
+        boost::intrusive::compare <GreaterFeeEarlier>,
+        boost::intrusive::constant_time_size<false> >;
+
+    using LastValidHook = boost::intrusive::member_hook
+        <MaybeTx, boost::intrusive::set_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink>>,
+        &MaybeTx::byLastValidHook>;
+
+    using LastValidMultiSet = boost::intrusive::multiset
+        < MaybeTx, LastValidHook,
+        boost::intrusive::compare <EarlierLastValid>,
+        boost::intrusive::constant_time_size<false> >;
+
     using AccountMap = std::map <AccountID, TxQAccount>;
 
     Setup const setup_;
@@ -296,6 +352,18 @@ private:
     FeeMetrics feeMetrics_;
     
     FeeMultiSet byFee_;
+
+    /** The first queued transaction of each account, in byFee_ order.
+        accept() walks this instead of skipping the later transactions
+        of each account in byFee_.
+    */
+    HeadMultiSet byHead_;
+
+    /** Queued transactions that expire, soonest first. */
+    LastValidMultiSet byLastValid_;
+
+    // The number of transactions ever queued, for MaybeTx::order
+    std::uint64_t arrivals_ = 0;
     
     AccountMap byAccount_;
     
@@ -316,7 +384,11 @@ private:
 
     FeeMultiSet::iterator_type erase(FeeMultiSet::const_iterator_type);
     
-    FeeMultiSet::iterator_type eraseAndAdvance(FeeMultiSet::const_iterator_type);
+    HeadMultiSet::iterator eraseAndAdvance(HeadMultiSet::iterator);
+
+    /** Make byHead_ hold the first transaction of the account. */
+    void
+    updateHead(TxQAccount& txQAccount);
     TxQAccount::TxMap::iterator
     erase(TxQAccount& txQAccount, TxQAccount::TxMap::const_iterator begin,
         TxQAccount::TxMap::const_iterator end);
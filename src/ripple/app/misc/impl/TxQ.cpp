@@ -277,6 +277,8 @@ TxQ::TxQ(Setup const& setup,
 TxQ::~TxQ()
 {
     byFee_.clear();
+    byHead_.clear();
+    byLastValid_.clear();
 }
 
 template<size_t fillPercentage>
@@ -341,33 +343,58 @@ TxQ::erase(TxQ::FeeMultiSet::const_iterator_type candidateIter)
     auto const found = txQAccount.remove(sequence);
     (void)found;
     assert(found);
+    updateHead(txQAccount);
 
     return newCandidateIter;
 }
 
 auto
-TxQ::eraseAndAdvance(TxQ::FeeMultiSet::const_iterator_type candidateIter)
-    -> FeeMultiSet::iterator_type
+TxQ::eraseAndAdvance(TxQ::HeadMultiSet::iterator candidateIter)
+    -> HeadMultiSet::iterator
 {
     auto& txQAccount = byAccount_.at(candidateIter->account);
-    auto const accountIter = txQAccount.transactions.find(
-        candidateIter->sequence);
-    assert(accountIter != txQAccount.transactions.end());
-    assert(accountIter == txQAccount.transactions.begin());
-    assert(byFee_.iterator_to(accountIter->second) == candidateIter);
+    auto const accountIter = txQAccount.transactions.begin();
+    assert(&accountIter->second == &*candidateIter);
     auto const accountNextIter = std::next(accountIter);
-    
-    auto const feeNextIter = std::next(candidateIter);
-    bool const useAccountNext = accountNextIter != txQAccount.transactions.end() &&
-        accountNextIter->first == candidateIter->sequence + 1 &&
-            (feeNextIter == byFee_.end() ||
-                accountNextIter->second.feeLevel > feeNextIter->feeLevel);
-    auto const candidateNextIter = byFee_.erase(candidateIter);
+
+    auto const sequence = candidateIter->sequence;
+    auto const feeLevel = candidateIter->feeLevel;
+    auto const order = candidateIter->order;
+    auto const headNextIter = std::next(candidateIter);
+    byFee_.erase(byFee_.iterator_to(*candidateIter));
     txQAccount.transactions.erase(accountIter);
+    if (accountNextIter == txQAccount.transactions.end())
+        return headNextIter;
+
+    // The account's next transaction is visited now if it follows
+    // directly and outbids the next head, or if a walk of byFee_ would
+    // still have reached it.
+    auto& accountNext = accountNextIter->second;
+    byHead_.insert(accountNext);
+    bool const reachable = accountNext.sequence == sequence + 1 ||
+        accountNext.feeLevel < feeLevel ||
+            (accountNext.feeLevel == feeLevel && accountNext.order > order);
+    bool const useAccountNext = reachable &&
+        (headNextIter == byHead_.end() ||
+            byHead_.value_comp()(accountNext, *headNextIter));
     return useAccountNext ?
-        byFee_.iterator_to(accountNextIter->second) :
-            candidateNextIter;
+        byHead_.iterator_to(accountNext) :
+            headNextIter;
+}
 
+void
+TxQ::updateHead(TxQ::TxQAccount& txQAccount)
+{
+    if (txQAccount.empty())
+        return;
+
+    auto const first = txQAccount.transactions.begin();
+    auto const second = std::next(first);
+    if (second != txQAccount.transactions.end() &&
+            second->second.byHeadHook.is_linked())
+        second->second.byHeadHook.unlink();
+    if (!first->second.byHeadHook.is_linked())
+        byHead_.insert(first->second);
 }
 
 auto
@@ -380,7 +407,9 @@ TxQ::erase(TxQ::TxQAccount& txQAccount,
     {
         byFee_.erase(byFee_.iterator_to(it->second));
     }
-    return txQAccount.transactions.erase(begin, end);
+    auto const next = txQAccount.transactions.erase(begin, end);
+    updateHead(txQAccount);
+    return next;
 }
 
 std::pair<TER, bool>
@@ -838,7 +867,11 @@ TxQ::apply(Application& app, OpenView& view,
     
     if (consequences)
         candidate.consequences.emplace(*consequences);
+    candidate.order = ++arrivals_;
     byFee_.insert(candidate);
+    if (candidate.lastValid)
+        byLastValid_.insert(candidate);
+    updateHead(accountIter->second);
     JLOG(j_.debug()) << "Added transaction " << candidate.txID <<
         " with result " << transToken(pfresult.ter) <<
         " from " << (accountExists ? "existing" : "new") <<
@@ -864,18 +897,12 @@ TxQ::processClosedLedger(Application& app,
         maxSize_ = std::max (snapshot.txnsExpected * setup_.ledgersInQueue,
              setup_.queueSizeMin);
 
-    for(auto candidateIter = byFee_.begin(); candidateIter != byFee_.end(); )
+    while (!byLastValid_.empty() &&
+        *byLastValid_.begin()->lastValid <= ledgerSeq)
     {
-        if (candidateIter->lastValid
-            && *candidateIter->lastValid <= ledgerSeq)
-        {
-            byAccount_.at(candidateIter->account).dropPenalty = true;
-            candidateIter = erase(candidateIter);
-        }
-        else
-        {
-            ++candidateIter;
-        }
+        auto const& candidate = *byLastValid_.begin();
+        byAccount_.at(candidate.account).dropPenalty = true;
+        erase(byFee_.iterator_to(candidate));
     }
 
     for (auto txQAccountIter = byAccount_.begin();
@@ -901,18 +928,10 @@ TxQ::accept(Application& app,
 
     auto const metricSnapshot = feeMetrics_.getSnapshot();
 
-    for (auto candidateIter = byFee_.begin(); candidateIter != byFee_.end();)
+    for (auto candidateIter = byHead_.begin(); candidateIter != byHead_.end();)
     {
         auto& account = byAccount_.at(candidateIter->account);
-        if (candidateIter->sequence >
-            account.transactions.begin()->first)
-        {
-            JLOG(j_.trace()) << "Skipping queued transaction " <<
-                candidateIter->txID << " from account " <<
-                candidateIter->account << " as it is not the first.";
-            candidateIter++;
-            continue;
-        }
+        assert(&*candidateIter == &account.transactions.begin()->second);
         auto const requiredFeeLevel = FeeMetrics::scaleFeeLevel(
             metricSnapshot, view);
         auto const feeLevelPaid = candidateIter->feeLevel;
@@ -981,7 +1000,7 @@ TxQ::accept(Application& app,
                         ". Removing last item of account " <<
                         account.account;
                     auto endIter = byFee_.iterator_to(dropRIter->second);
-                    assert(endIter != candidateIter);
+                    assert(&*endIter != &*candidateIter);
                     erase(endIter);
 
                 }
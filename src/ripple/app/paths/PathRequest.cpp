@@ -415,23 +415,104 @@ Json::Value PathRequest::doStatus (Json::Value const&)
     return jvStatus;
 }
 
-std::unique_ptr<Pathfinder> const&
-PathRequest::getPathFinder(std::shared_ptr<RippleLineCache> const& cache,
-    hash_map<Currency, std::unique_ptr<Pathfinder>>& currency_map,
-        Currency const& currency, STAmount const& dst_amount,
-            int const level)
+Json::Value
+PathRequest::findIssuePaths (Pathfinder& pathfinder,
+    std::shared_ptr<RippleLineCache> const& cache,
+        Issue const& issue, STAmount const& dst_amount,
+            STPathSet& context)
 {
-    auto i = currency_map.find(currency);
-    if (i != currency_map.end())
-        return i->second;
-    auto pathfinder = std::make_unique<Pathfinder>(
-        cache, *raSrcAccount, *raDstAccount, currency,
-            boost::none, dst_amount, saSendMax, app_);
-    if (pathfinder->findPaths(level))
-        pathfinder->computePathRanks(max_paths_);
-    else
-        pathfinder.reset();  
-    return currency_map[currency] = std::move(pathfinder);
+    JLOG(m_journal.debug())
+        << iIdentifier
+        << " Trying to find paths: "
+        << STAmount(issue, 1).getFullText();
+
+    STPath fullLiquidityPath;
+    auto ps = pathfinder.getBestPaths(max_paths_,
+        fullLiquidityPath, context, issue.account);
+    context = ps;
+
+    auto& sourceAccount = ! isXRP(issue.account)
+        ? issue.account
+        : isXRP(issue.currency)
+        ? xrpAccount()
+        : *raSrcAccount;
+    STAmount saMaxAmount = saSendMax.value_or(
+        STAmount({issue.currency, sourceAccount}, 1u, 0, true));
+
+    JLOG(m_journal.debug()) << iIdentifier
+        << " Paths found, calling rippleCalc";
+
+    path::RippleCalc::Input rcInput;
+    if (convert_all_)
+        rcInput.partialPaymentAllowed = true;
+    auto sandbox = std::make_unique<PaymentSandbox>
+        (&*cache->getLedger(), tapNONE);
+    auto rc = path::RippleCalc::rippleCalculate(
+        *sandbox,
+        saMaxAmount,    
+        dst_amount,     
+        *raDstAccount,  
+        *raSrcAccount,  
+        ps,             
+        app_.logs(),
+        &rcInput);
+
+    if (! convert_all_ &&
+        ! fullLiquidityPath.empty() &&
+        (rc.result() == terNO_LINE || rc.result() == tecPATH_PARTIAL))
+    {
+        JLOG(m_journal.debug()) << iIdentifier
+            << " Trying with an extra path element";
+
+        ps.push_back(fullLiquidityPath);
+        sandbox = std::make_unique<PaymentSandbox>
+            (&*cache->getLedger(), tapNONE);
+        rc = path::RippleCalc::rippleCalculate(
+            *sandbox,
+            saMaxAmount,    
+            dst_amount,     
+            *raDstAccount,  
+            *raSrcAccount,  
+            ps,             
+            app_.logs());
+
+        if (rc.result() != tesSUCCESS)
+        {
+            JLOG(m_journal.warn()) << iIdentifier
+                << " Failed with covering path "
+                << transHuman(rc.result());
+        }
+        else
+        {
+            JLOG(m_journal.debug()) << iIdentifier
+                << " Extra path element gives "
+                << transHuman(rc.result());
+        }
+    }
+
+    if (rc.result () != tesSUCCESS)
+    {
+        JLOG(m_journal.debug()) << iIdentifier << " rippleCalc returns "
+            << transHuman(rc.result());
+        return Json::nullValue;
+    }
+
+    Json::Value jvEntry (Json::objectValue);
+    rc.actualAmountIn.setIssuer (sourceAccount);
+    jvEntry[jss::source_amount] =
+        rc.actualAmountIn.getJson (JsonOptions::none);
+    jvEntry[jss::paths_computed] = ps.getJson(JsonOptions::none);
+
+    if (convert_all_)
+        jvEntry[jss::destination_amount] =
+            rc.actualAmountOut.getJson(JsonOptions::none);
+
+    if (hasCompletion ())
+    {
+        jvEntry[jss::paths_canonical] = Json::arrayValue;
+    }
+
+    return jvEntry;
 }
 
 bool
@@ -458,111 +539,67 @@ PathRequest::findPaths (std::shared_ptr<RippleLineCache> const& cache,
     auto const dst_amount = convert_all_ ?
         STAmount(saDstAmount.issue(), STAmount::cMaxValue, STAmount::cMaxOffset)
             : saDstAmount;
-    hash_map<Currency, std::unique_ptr<Pathfinder>> currency_map;
-    for (auto const& issue : sourceCurrencies)
-    {
-        JLOG(m_journal.debug())
-            << iIdentifier
-            << " Trying to find paths: "
-            << STAmount(issue, 1).getFullText();
 
-        auto& pathfinder = getPathFinder(cache, currency_map,
-            issue.currency, dst_amount, level);
-        if (! pathfinder)
+    boost::optional<std::chrono::steady_clock::time_point> deadline;
+    if (app_.config().PATH_SEARCH_TIME.count() > 0)
+        deadline = std::chrono::steady_clock::now() +
+            app_.config().PATH_SEARCH_TIME;
+
+    // Issues with the same currency share a Pathfinder. Each currency is
+    // searched by its own task and the results are merged in issue order.
+    std::vector<Issue> const issues (
+        sourceCurrencies.begin(), sourceCurrencies.end());
+    std::vector<std::vector<std::size_t>> groups;
+    {
+        hash_map<Currency, std::size_t> index;
+        for (std::size_t i = 0; i < issues.size(); ++i)
         {
-            assert(false);
-            JLOG(m_journal.debug()) << iIdentifier << " No paths found";
-            continue;
+            auto const it = index.emplace(issues[i].currency, groups.size());
+            if (it.second)
+                groups.emplace_back();
+            groups[it.first->second].push_back(i);
         }
+    }
 
-        STPath fullLiquidityPath;
-        auto ps = pathfinder->getBestPaths(max_paths_,
-            fullLiquidityPath, mContext[issue], issue.account);
-        mContext[issue] = ps;
-
-        auto& sourceAccount = ! isXRP(issue.account)
-            ? issue.account
-            : isXRP(issue.currency)
-            ? xrpAccount()
-            : *raSrcAccount;
-        STAmount saMaxAmount = saSendMax.value_or(
-            STAmount({issue.currency, sourceAccount}, 1u, 0, true));
-
-        JLOG(m_journal.debug()) << iIdentifier
-            << " Paths found, calling rippleCalc";
+    std::vector<STPathSet> contexts;
+    contexts.reserve(issues.size());
+    for (auto const& issue : issues)
+        contexts.push_back(mContext[issue]);
 
-        path::RippleCalc::Input rcInput;
-        if (convert_all_)
-            rcInput.partialPaymentAllowed = true;
-        auto sandbox = std::make_unique<PaymentSandbox>
-            (&*cache->getLedger(), tapNONE);
-        auto rc = path::RippleCalc::rippleCalculate(
-            *sandbox,
-            saMaxAmount,    
-            dst_amount,     
-            *raDstAccount,  
-            *raSrcAccount,  
-            ps,             
-            app_.logs(),
-            &rcInput);
+    std::vector<Json::Value> entries (issues.size());
 
-        if (! convert_all_ &&
-            ! fullLiquidityPath.empty() &&
-            (rc.result() == terNO_LINE || rc.result() == tecPATH_PARTIAL))
+    auto& pool = mOwner.searchPool();
+    pool.run(groups.size(), [&](std::size_t g)
+    {
+        auto const& group = groups[g];
+        Pathfinder pathfinder (cache, *raSrcAccount, *raDstAccount,
+            issues[group.front()].currency, boost::none, dst_amount,
+                saSendMax, app_);
+        pathfinder.setLimits(&pool, deadline);
+        if (! pathfinder.findPaths(level))
         {
-            JLOG(m_journal.debug()) << iIdentifier
-                << " Trying with an extra path element";
-
-            ps.push_back(fullLiquidityPath);
-            sandbox = std::make_unique<PaymentSandbox>
-                (&*cache->getLedger(), tapNONE);
-            rc = path::RippleCalc::rippleCalculate(
-                *sandbox,
-                saMaxAmount,    
-                dst_amount,     
-                *raDstAccount,  
-                *raSrcAccount,  
-                ps,             
-                app_.logs());
-
-            if (rc.result() != tesSUCCESS)
-            {
-                JLOG(m_journal.warn()) << iIdentifier
-                    << " Failed with covering path "
-                    << transHuman(rc.result());
-            }
-            else
-            {
-                JLOG(m_journal.debug()) << iIdentifier
-                    << " Extra path element gives "
-                    << transHuman(rc.result());
-            }
+            assert(false);
+            JLOG(m_journal.debug()) << iIdentifier << " No paths found";
+            return;
         }
+        pathfinder.computePathRanks(max_paths_);
 
-        if (rc.result () == tesSUCCESS)
-        {
-            Json::Value jvEntry (Json::objectValue);
-            rc.actualAmountIn.setIssuer (sourceAccount);
-            jvEntry[jss::source_amount] =
-                rc.actualAmountIn.getJson (JsonOptions::none);
-            jvEntry[jss::paths_computed] = ps.getJson(JsonOptions::none);
-
-            if (convert_all_)
-                jvEntry[jss::destination_amount] =
-                    rc.actualAmountOut.getJson(JsonOptions::none);
+        for (auto const i : group)
+            entries[i] = findIssuePaths(pathfinder, cache,
+                issues[i], dst_amount, contexts[i]);
+    });
 
-            if (hasCompletion ())
-            {
-                jvEntry[jss::paths_canonical] = Json::arrayValue;
-            }
+    for (std::size_t i = 0; i < issues.size(); ++i)
+    {
+        mContext[issues[i]] = std::move(contexts[i]);
+        if (! entries[i].isNull())
+            jvArray.append(entries[i]);
+    }
 
-            jvArray.append (jvEntry);
-        }
-        else
-        {
-            JLOG(m_journal.debug()) << iIdentifier << " rippleCalc returns "
-                << transHuman(rc.result());
-        }
+    if (deadline && std::chrono::steady_clock::now() >= *deadline)
+    {
+        JLOG(m_journal.debug()) << iIdentifier
+            << " Search time exhausted, returning best paths found";
     }
 
     
@@ -648,6 +685,7 @@ Json::Value PathRequest::doUpdate(
         bLastSuccess = false;
         newStatus = rpcError(rpcINTERNAL);
     }
+    cache->publish();
 
     if (fast && quick_reply_ == steady_clock::time_point{})
     {
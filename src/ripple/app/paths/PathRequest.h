@@ -79,10 +79,9 @@ private:
     bool isValid (std::shared_ptr<RippleLineCache> const& crCache);
     void setValid ();
 
-    std::unique_ptr<Pathfinder> const&
-    getPathFinder(std::shared_ptr<RippleLineCache> const&,
-        hash_map<Currency, std::unique_ptr<Pathfinder>>&, Currency const&,
-            STAmount const&, int const);
+    Json::Value
+    findIssuePaths (Pathfinder&, std::shared_ptr<RippleLineCache> const&,
+        Issue const&, STAmount const&, STPathSet&);
 
     
     bool
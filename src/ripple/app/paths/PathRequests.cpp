@@ -29,7 +29,7 @@ PathRequests::getLineCache (
          (authoritative && ((lgrSeq + 8)  < lineSeq)) ||   
          (lgrSeq > (lineSeq + 8)))                         
     {
-        mLineCache = std::make_shared<RippleLineCache> (ledger);
+        mLineCache = std::make_shared<RippleLineCache> (ledger, graph_);
     }
     return mLineCache;
 }
@@ -230,7 +230,7 @@ PathRequests::doLegacyPathRequest (
         std::shared_ptr<ReadView const> const& inLedger,
         Json::Value const& request)
 {
-    auto cache = std::make_shared<RippleLineCache> (inLedger);
+    auto cache = std::make_shared<RippleLineCache> (inLedger, graph_);
 
     auto req = std::make_shared<PathRequest> (app_, []{},
         consumer, ++mLastIdentifier, *this, mJournal);
@@ -5,7 +5,9 @@
 
 #include <ripple/app/main/Application.h>
 #include <ripple/app/paths/PathRequest.h>
+#include <ripple/app/paths/PathSearchPool.h>
 #include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/TrustLineGraph.h>
 #include <ripple/core/Job.h>
 #include <atomic>
 #include <mutex>
@@ -21,6 +23,8 @@ public:
             beast::Journal journal, beast::insight::Collector::ptr const& collector)
         : app_ (app)
         , mJournal (journal)
+        , graph_ (std::make_shared<TrustLineGraph> (journal))
+        , pool_ (app.config().PATH_SEARCH_THREADS)
         , mLastIdentifier (0)
     {
         mFast = collector->make_event ("pathfind_fast");
@@ -31,6 +35,12 @@ public:
     void updateAll (std::shared_ptr<ReadView const> const& ledger,
                     Job::CancelCallback shouldCancel);
 
+    /** Carry the shared trust line graph forward to a validated ledger. */
+    void updateGraph (std::shared_ptr<ReadView const> const& ledger)
+    {
+        graph_->onValidatedLedger (ledger);
+    }
+
     std::shared_ptr<RippleLineCache> getLineCache (
         std::shared_ptr <ReadView const> const& ledger, bool authoritative);
 
@@ -51,6 +61,11 @@ public:
         std::shared_ptr<ReadView const> const& inLedger,
         Json::Value const& request);
 
+    PathSearchPool& searchPool ()
+    {
+        return pool_;
+    }
+
     void reportFast (std::chrono::milliseconds ms)
     {
         mFast.notify (ms);
@@ -74,6 +89,10 @@ private:
 
     std::shared_ptr<RippleLineCache>         mLineCache;
 
+    std::shared_ptr<TrustLineGraph>          graph_;
+
+    PathSearchPool                   pool_;
+
     std::atomic<int>                 mLastIdentifier;
 
     using ScopedLockType = std::lock_guard <std::recursive_mutex>;
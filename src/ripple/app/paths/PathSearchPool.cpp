@@ -0,0 +1,138 @@
+#include <ripple/app/paths/PathSearchPool.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace ripple {
+
+struct PathSearchPool::Batch
+{
+    Batch (std::size_t n_, std::function<void(std::size_t)> const& f_)
+        : n (n_)
+        , f (f_)
+    {
+    }
+
+    std::size_t const n;
+    std::function<void(std::size_t)> const& f;
+    std::atomic<std::size_t> next {0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t done = 0;
+    std::exception_ptr error;
+};
+
+PathSearchPool::PathSearchPool (std::size_t threads)
+{
+    threads_.reserve (threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        threads_.emplace_back ([this, i]
+        {
+            beast::setCurrentThreadName ("pathfind #" + std::to_string (i));
+            loop ();
+        });
+    }
+}
+
+PathSearchPool::~PathSearchPool ()
+{
+    {
+        std::lock_guard<std::mutex> sl (mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all ();
+
+    for (auto& t : threads_)
+        t.join ();
+}
+
+void
+PathSearchPool::run (std::size_t n,
+    std::function<void(std::size_t)> const& f)
+{
+    if (threads_.empty () || n < 2)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            f (i);
+        return;
+    }
+
+    auto const batch = std::make_shared<Batch> (n, f);
+    {
+        std::lock_guard<std::mutex> sl (mutex_);
+        batches_.push_back (batch);
+    }
+    cv_.notify_all ();
+
+    work (*batch);
+
+    {
+        std::unique_lock<std::mutex> sl (batch->mutex);
+        batch->cv.wait (sl, [&]{ return batch->done == batch->n; });
+    }
+
+    {
+        std::lock_guard<std::mutex> sl (mutex_);
+        auto const it = std::find (batches_.begin (), batches_.end (), batch);
+        if (it != batches_.end ())
+            batches_.erase (it);
+    }
+
+    if (batch->error)
+        std::rethrow_exception (batch->error);
+}
+
+void
+PathSearchPool::work (Batch& batch)
+{
+    for (;;)
+    {
+        auto const i = batch.next++;
+        if (i >= batch.n)
+            return;
+
+        std::exception_ptr error;
+        try
+        {
+            batch.f (i);
+        }
+        catch (...)
+        {
+            error = std::current_exception ();
+        }
+
+        std::lock_guard<std::mutex> sl (batch.mutex);
+        if (error && ! batch.error)
+            batch.error = error;
+        if (++batch.done == batch.n)
+            batch.cv.notify_all ();
+    }
+}
+
+void
+PathSearchPool::loop ()
+{
+    for (;;)
+    {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> sl (mutex_);
+            cv_.wait (sl, [&]{ return stop_ || ! batches_.empty (); });
+            if (stop_)
+                return;
+
+            batch = batches_.front ();
+            if (batch->next >= batch->n)
+            {
+                batches_.pop_front ();
+                continue;
+            }
+        }
+        work (*batch);
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef RIPPLE_APP_PATHS_PATHSEARCHPOOL_H_INCLUDED
+#define RIPPLE_APP_PATHS_PATHSEARCHPOOL_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** A fixed set of threads shared by all path searches.
+
+    The thread calling run() works on its own batch too, so a search never
+    waits for a free thread and nested calls from inside a task are safe.
+    With no threads every batch runs serially on the caller.
+*/
+class PathSearchPool
+{
+public:
+    explicit
+    PathSearchPool (std::size_t threads);
+
+    PathSearchPool (PathSearchPool const&) = delete;
+    PathSearchPool& operator= (PathSearchPool const&) = delete;
+
+    ~PathSearchPool ();
+
+    std::size_t
+    size () const
+    {
+        return threads_.size ();
+    }
+
+    /** Call f(i) for each i in [0, n) and wait for all calls to finish.
+        The first exception thrown by f is rethrown here.
+    */
+    void
+    run (std::size_t n, std::function<void(std::size_t)> const& f);
+
+private:
+    struct Batch;
+
+    void
+    work (Batch& batch);
+
+    void
+    loop ();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<Batch>> batches_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}
+
+#endif
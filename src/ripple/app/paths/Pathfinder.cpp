@@ -123,6 +123,18 @@ Pathfinder::Pathfinder (
     assert (! uSrcIssuer || isXRP(uSrcCurrency) == isXRP(uSrcIssuer.get()));
 }
 
+void Pathfinder::setLimits (PathSearchPool* pool,
+    boost::optional<std::chrono::steady_clock::time_point> deadline)
+{
+    pool_ = pool;
+    deadline_ = deadline;
+}
+
+bool Pathfinder::expired () const
+{
+    return deadline_ && std::chrono::steady_clock::now () >= *deadline_;
+}
+
 bool Pathfinder::findPaths (int searchLevel)
 {
     if (mDstAmount == beast::zero)
@@ -238,6 +250,12 @@ bool Pathfinder::findPaths (int searchLevel)
 
     for (auto const& costedPath : mPathTable[paymentType])
     {
+        if (expired ())
+        {
+            JLOG (j_.debug()) << "findPaths: out of time";
+            break;
+        }
+
         if (costedPath.searchLevel <= searchLevel)
         {
             addPathsForType (costedPath.type);
@@ -401,32 +419,50 @@ void Pathfinder::rankPaths (
         saMinDstAmount = smallestUsefulAmount(mDstAmount, maxPaths);
     }
 
-    for (int i = 0; i < paths.size (); ++i)
+    // Each candidate is ranked in its own sandbox, so they can be ranked
+    // in parallel. Once out of time only the first maxPaths are ranked.
+    std::vector<boost::optional<PathRank>> ranks (paths.size ());
+    auto rank = [&](std::size_t i)
     {
         auto const& currentPath = paths[i];
-        if (! currentPath.empty())
+        if (currentPath.empty () ||
+            (i >= static_cast<std::size_t> (maxPaths) && expired ()))
+            return;
+
+        STAmount liquidity;
+        uint64_t uQuality;
+        auto const resultCode = getPathLiquidity (
+            currentPath, saMinDstAmount, liquidity, uQuality);
+        if (resultCode != tesSUCCESS)
         {
-            STAmount liquidity;
-            uint64_t uQuality;
-            auto const resultCode = getPathLiquidity (
-                currentPath, saMinDstAmount, liquidity, uQuality);
-            if (resultCode != tesSUCCESS)
-            {
-                JLOG (j_.debug()) <<
-                    "findPaths: dropping : " <<
-                    transToken (resultCode) <<
-                    ": " << currentPath.getJson (JsonOptions::none);
-            }
-            else
-            {
-                JLOG (j_.debug()) <<
-                    "findPaths: quality: " << uQuality <<
-                    ": " << currentPath.getJson (JsonOptions::none);
+            JLOG (j_.debug()) <<
+                "findPaths: dropping : " <<
+                transToken (resultCode) <<
+                ": " << currentPath.getJson (JsonOptions::none);
+        }
+        else
+        {
+            JLOG (j_.debug()) <<
+                "findPaths: quality: " << uQuality <<
+                ": " << currentPath.getJson (JsonOptions::none);
 
-                rankedPaths.push_back ({uQuality,
-                    currentPath.size (), liquidity, i});
-            }
+            ranks[i] = PathRank {uQuality, currentPath.size (),
+                liquidity, static_cast<int> (i)};
         }
+    };
+
+    if (pool_)
+        pool_->run (paths.size (), rank);
+    else
+    {
+        for (std::size_t i = 0; i < paths.size (); ++i)
+            rank (i);
+    }
+
+    for (auto& r : ranks)
+    {
+        if (r)
+            rankedPaths.push_back (std::move (*r));
     }
 
     std::sort(rankedPaths.begin(), rankedPaths.end(),
@@ -651,7 +687,11 @@ void Pathfinder::addLinks (
         << "addLink< on " << currentPaths.size ()
         << " source(s), flags=" << addFlags;
     for (auto const& path: currentPaths)
+    {
+        if (expired ())
+            break;
         addLink (path, incompletePaths, addFlags);
+    }
 }
 
 STPathSet& Pathfinder::addPathsForType (PathType const& pathType)
@@ -4,10 +4,13 @@
 #define RIPPLE_APP_PATHS_PATHFINDER_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/paths/PathSearchPool.h>
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/core/LoadEvent.h>
 #include <ripple/protocol/STAmount.h>
 #include <ripple/protocol/STPathSet.h>
+#include <boost/optional.hpp>
+#include <chrono>
 
 namespace ripple {
 
@@ -31,6 +34,12 @@ public:
 
     static void initPathTable ();
 
+    /** Rank candidate paths on a pool and stop searching once the
+        deadline passes, keeping the paths found so far.
+    */
+    void setLimits (PathSearchPool* pool,
+        boost::optional<std::chrono::steady_clock::time_point> deadline);
+
     bool findPaths (int searchLevel);
 
     
@@ -105,6 +114,8 @@ private:
 
     bool isNoRippleOut (STPath const& currentPath);
 
+    bool expired () const;
+
     bool isNoRipple (
         AccountID const& fromAccount,
         AccountID const& toAccount,
@@ -137,6 +148,9 @@ private:
 
     hash_map<Issue, int> mPathsOutCountMap;
 
+    PathSearchPool* pool_ = nullptr;
+    boost::optional<std::chrono::steady_clock::time_point> deadline_;
+
     Application& app_;
     beast::Journal j_;
 
@@ -6,14 +6,37 @@
 namespace ripple {
 
 RippleLineCache::RippleLineCache(
-    std::shared_ptr <ReadView const> const& ledger)
+    std::shared_ptr <ReadView const> const& ledger,
+    std::shared_ptr <TrustLineGraph> const& graph)
 {
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
+
+    if (graph && ! ledger->open())
+    {
+        auto snapshot = graph->current();
+        if (snapshot->seq() == ledger->info().seq &&
+            snapshot->hash() == ledger->info().hash)
+        {
+            graph_ = graph;
+            snapshot_ = std::move (snapshot);
+        }
+    }
+}
+
+RippleLineCache::~RippleLineCache ()
+{
+    publish ();
 }
 
 std::vector<RippleState::pointer> const&
 RippleLineCache::getRippleLines (AccountID const& accountID)
 {
+    if (snapshot_)
+    {
+        if (auto const lines = snapshot_->find (accountID))
+            return *lines;
+    }
+
     AccountKey key (accountID, hasher_ (accountID));
 
     std::lock_guard <std::mutex> sl (mLock);
@@ -22,12 +45,37 @@ RippleLineCache::getRippleLines (AccountID const& accountID)
         std::vector<RippleState::pointer>());
 
     if (it.second)
+    {
         it.first->second = getRippleStateItems (
             accountID, *mLedger);
 
+        if (snapshot_)
+        {
+            unpublished_.emplace_back (accountID,
+                std::make_shared<TrustLineGraph::Lines const> (
+                    it.first->second));
+        }
+    }
+
     return it.first->second;
 }
 
+void
+RippleLineCache::publish ()
+{
+    if (! snapshot_)
+        return;
+
+    TrustLineGraph::Batch batch;
+    {
+        std::lock_guard <std::mutex> sl (mLock);
+        batch.swap (unpublished_);
+    }
+
+    if (! batch.empty ())
+        graph_->insert (*snapshot_, batch);
+}
+
 } 
 
 
@@ -5,6 +5,7 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/paths/RippleState.h>
+#include <ripple/app/paths/TrustLineGraph.h>
 #include <ripple/basics/hardened_hash.h>
 #include <cstddef>
 #include <memory>
@@ -18,7 +19,10 @@ class RippleLineCache
 public:
     explicit
     RippleLineCache (
-        std::shared_ptr <ReadView const> const& l);
+        std::shared_ptr <ReadView const> const& l,
+        std::shared_ptr <TrustLineGraph> const& graph = nullptr);
+
+    ~RippleLineCache ();
 
     std::shared_ptr <ReadView const> const&
     getLedger () const
@@ -29,12 +33,21 @@ public:
     std::vector<RippleState::pointer> const&
     getRippleLines (AccountID const& accountID);
 
+    /** Add the lines read since the last call to the shared graph. */
+    void
+    publish ();
+
 private:
     std::mutex mLock;
 
     ripple::hardened_hash<> hasher_;
     std::shared_ptr <ReadView const> mLedger;
 
+    // Set when the ledger is the one the graph snapshot was taken from
+    std::shared_ptr <TrustLineGraph> graph_;
+    std::shared_ptr <TrustLineGraph::Snapshot const> snapshot_;
+    TrustLineGraph::Batch unpublished_;
+
     struct AccountKey
     {
         AccountID account_;
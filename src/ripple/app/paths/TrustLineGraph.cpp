@@ -0,0 +1,233 @@
+#include <ripple/app/paths/TrustLineGraph.h>
+#include <ripple/basics/Log.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <atomic>
+
+namespace ripple {
+
+// Most accounts kept in the graph
+std::size_t constexpr maxAccounts = 262144;
+
+std::size_t
+TrustLineGraph::Snapshot::bucket (AccountID const& account)
+{
+    // Account IDs are hashes so the leading bytes are uniform
+    return ((std::size_t (account.data ()[0]) << 8) |
+        account.data ()[1]) % bucketCount;
+}
+
+TrustLineGraph::Lines const*
+TrustLineGraph::Snapshot::find (AccountID const& account) const
+{
+    auto const& b = buckets_[bucket (account)];
+    if (! b)
+        return nullptr;
+
+    auto const it = b->find (account);
+    if (it == b->end ())
+        return nullptr;
+
+    return it->second.get ();
+}
+
+TrustLineGraph::TrustLineGraph (beast::Journal journal)
+    : journal_ (journal)
+    , current_ (std::make_shared<Snapshot> ())
+{
+}
+
+std::shared_ptr<TrustLineGraph::Snapshot const>
+TrustLineGraph::current () const
+{
+    return std::atomic_load (&current_);
+}
+
+void
+TrustLineGraph::insert (Snapshot const& snapshot, Batch const& accounts)
+{
+    std::lock_guard<std::mutex> sl (mutex_);
+
+    auto const cur = std::atomic_load (&current_);
+    if (cur->seq_ != snapshot.seq_ || cur->hash_ != snapshot.hash_ ||
+        cur->size_ >= maxAccounts)
+    {
+        return;
+    }
+
+    auto next = std::make_shared<Snapshot> (*cur);
+
+    // Buckets are copied the first time this batch changes them
+    std::array<std::shared_ptr<Snapshot::Bucket>,
+        Snapshot::bucketCount> copies;
+    for (auto const& account : accounts)
+    {
+        if (next->size_ >= maxAccounts)
+            break;
+        if (next->find (account.first))
+            continue;
+
+        auto const i = Snapshot::bucket (account.first);
+        if (! copies[i])
+        {
+            copies[i] = next->buckets_[i] ?
+                std::make_shared<Snapshot::Bucket> (*next->buckets_[i]) :
+                std::make_shared<Snapshot::Bucket> ();
+            next->buckets_[i] = copies[i];
+        }
+        copies[i]->emplace (account.first, account.second);
+        ++next->size_;
+    }
+
+    if (next->size_ == cur->size_)
+        return;
+
+    std::atomic_store (&current_,
+        std::shared_ptr<Snapshot const> (std::move (next)));
+}
+
+void
+TrustLineGraph::onValidatedLedger (
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    std::lock_guard<std::mutex> sl (mutex_);
+
+    auto const cur = std::atomic_load (&current_);
+    auto const& info = ledger->info ();
+    if (info.seq <= cur->seq_)
+        return;
+
+    auto next = std::make_shared<Snapshot> ();
+    next->seq_ = info.seq;
+    next->hash_ = info.hash;
+
+    auto publish = [&]
+    {
+        std::atomic_store (&current_,
+            std::shared_ptr<Snapshot const> (std::move (next)));
+    };
+
+    if (cur->size_ == 0 || info.seq != cur->seq_ + 1 ||
+        info.parentHash != cur->hash_)
+    {
+        if (cur->size_ != 0)
+        {
+            JLOG (journal_.debug()) << "Trust line graph reset at " <<
+                info.seq << ", had " << cur->seq_;
+        }
+        publish ();
+        return;
+    }
+
+    next->buckets_ = cur->buckets_;
+    next->size_ = cur->size_;
+
+    try
+    {
+        // Lines created, changed or deleted by this ledger and the
+        // accounts on either side of them. An account that gains a line
+        // is dropped and re-read on demand so directory order is kept.
+        hash_map<uint256, std::shared_ptr<SLE const>> changed;
+        hash_set<AccountID> touched;
+        hash_set<AccountID> dropped;
+
+        for (auto const& tx : ledger->txs)
+        {
+            if (! tx.second)
+                continue;
+
+            for (auto const& node :
+                tx.second->getFieldArray (sfAffectedNodes))
+            {
+                if (node.getFieldU16 (sfLedgerEntryType) != ltRIPPLE_STATE)
+                    continue;
+
+                bool const created = node.getFName () == sfCreatedNode;
+                auto const fields = dynamic_cast<STObject const*> (
+                    node.peekAtPField (created ? sfNewFields : sfFinalFields));
+                if (! fields)
+                    continue;
+
+                auto const low = fields->getFieldAmount (
+                    sfLowLimit).getIssuer ();
+                auto const high = fields->getFieldAmount (
+                    sfHighLimit).getIssuer ();
+
+                changed.emplace (node.getFieldH256 (sfLedgerIndex), nullptr);
+                touched.insert (low);
+                touched.insert (high);
+
+                if (created)
+                {
+                    dropped.insert (low);
+                    dropped.insert (high);
+                }
+            }
+        }
+
+        for (auto& c : changed)
+            c.second = ledger->read (keylet::line (c.first));
+
+        // Buckets are copied the first time this ledger changes them
+        std::array<std::shared_ptr<Snapshot::Bucket>,
+            Snapshot::bucketCount> copies;
+        auto bucket = [&](std::size_t i) -> Snapshot::Bucket&
+        {
+            if (! copies[i])
+            {
+                copies[i] = std::make_shared<Snapshot::Bucket> (
+                    *next->buckets_[i]);
+                next->buckets_[i] = copies[i];
+            }
+            return *copies[i];
+        };
+
+        std::size_t updated = 0;
+        std::size_t erased = 0;
+        for (auto const& account : touched)
+        {
+            auto const old = next->find (account);
+            if (! old)
+                continue;
+
+            auto& b = bucket (Snapshot::bucket (account));
+            if (dropped.count (account))
+            {
+                b.erase (account);
+                --next->size_;
+                ++erased;
+                continue;
+            }
+
+            auto lines = std::make_shared<Lines> ();
+            lines->reserve (old->size ());
+            for (auto const& line : *old)
+            {
+                auto const it = changed.find (line->key ());
+                if (it == changed.end ())
+                    lines->push_back (line);
+                else if (auto item = RippleState::makeItem (
+                        account, it->second))
+                    lines->push_back (std::move (item));
+            }
+            b[account] = std::move (lines);
+            ++updated;
+        }
+
+        JLOG (journal_.trace()) << "Trust line graph at " << info.seq <<
+            ": " << changed.size () << " lines changed, " << updated <<
+            " accounts updated, " << erased << " dropped";
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (journal_.warn()) << "Trust line graph reset at " <<
+            info.seq << ": " << e.what ();
+        next->buckets_ = {};
+        next->size_ = 0;
+    }
+
+    publish ();
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef RIPPLE_APP_PATHS_TRUSTLINEGRAPH_H_INCLUDED
+#define RIPPLE_APP_PATHS_TRUSTLINEGRAPH_H_INCLUDED
+
+#include <ripple/app/paths/RippleState.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ReadView.h>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Trust lines of the last validated ledger, shared by all line caches.
+
+    Accounts are added on demand by line caches built over the validated
+    ledger and carried forward to each following validated ledger using
+    the affected nodes in its transaction metadata, so only accounts whose
+    lines changed are re-read. Readers use an immutable Snapshot and never
+    take a lock; writers publish a new snapshot sharing unchanged buckets.
+*/
+class TrustLineGraph
+{
+public:
+    using Lines = std::vector<RippleState::pointer>;
+
+    /** Accounts and their lines, as read from one ledger. */
+    using Batch = std::vector<
+        std::pair<AccountID, std::shared_ptr<Lines const>>>;
+
+    class Snapshot
+    {
+    public:
+        std::uint32_t
+        seq () const
+        {
+            return seq_;
+        }
+
+        uint256 const&
+        hash () const
+        {
+            return hash_;
+        }
+
+        std::size_t
+        size () const
+        {
+            return size_;
+        }
+
+        /** The lines of an account, in owner directory order.
+            Returns nullptr if the account is not in the snapshot.
+        */
+        Lines const*
+        find (AccountID const& account) const;
+
+    private:
+        friend class TrustLineGraph;
+
+        using Bucket = hash_map<AccountID, std::shared_ptr<Lines const>>;
+
+        static std::size_t constexpr bucketCount = 1024;
+
+        static std::size_t
+        bucket (AccountID const& account);
+
+        std::uint32_t seq_ = 0;
+        uint256 hash_;
+        std::size_t size_ = 0;
+        std::array<std::shared_ptr<Bucket const>, bucketCount> buckets_;
+    };
+
+    explicit
+    TrustLineGraph (beast::Journal journal);
+
+    /** The snapshot for the last validated ledger. Never null. */
+    std::shared_ptr<Snapshot const>
+    current () const;
+
+    /** Add the lines of accounts as read from the snapshot's ledger.
+        Accounts already in the graph are skipped. Ignored if the graph
+        has since moved to another ledger.
+    */
+    void
+    insert (Snapshot const& snapshot, Batch const& accounts);
+
+    /** Advance to a newly validated ledger.
+        If the ledger does not directly follow the current one the graph
+        starts over empty.
+    */
+    void
+    onValidatedLedger (std::shared_ptr<ReadView const> const& ledger);
+
+private:
+    beast::Journal journal_;
+
+    // Serializes writers
+    std::mutex mutex_;
+
+    // Accessed with std::atomic_load and std::atomic_store
+    std::shared_ptr<Snapshot const> current_;
+};
+
+}
+
+#endif
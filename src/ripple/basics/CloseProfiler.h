@@ -0,0 +1,104 @@
+#ifndef RIPPLE_BASICS_CLOSEPROFILER_H_INCLUDED
+#define RIPPLE_BASICS_CLOSEPROFILER_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace perf {
+
+/** Work done by the calling thread, attributed to the scopes around it. */
+struct WorkCounters
+{
+    std::uint64_t nodesHashed = 0;
+    std::uint64_t nodesWritten = 0;
+    std::uint64_t slesRead = 0;
+};
+
+/** The counters of the calling thread. */
+WorkCounters&
+workCounters ();
+
+/** Where the time of recent ledger closes went.
+
+    Each phase of a close is timed by a Scope naming the ledger it works
+    on. Scopes may nest and may run on any thread; the work counted on
+    their thread while they are open is recorded with them. Phases of the
+    last few ledgers are kept and can be exported in the Chrome trace
+    event format.
+*/
+class CloseProfiler
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Event
+    {
+        char const* name;
+        std::uint32_t thread;
+        int depth;
+        clock_type::time_point start;
+        clock_type::duration duration;
+        WorkCounters work;
+    };
+
+    class Scope
+    {
+    public:
+        Scope (CloseProfiler& profiler, std::uint32_t seq,
+            char const* name);
+
+        Scope (Scope const&) = delete;
+        Scope& operator= (Scope const&) = delete;
+
+        ~Scope ();
+
+    private:
+        CloseProfiler& profiler_;
+        std::uint32_t seq_;
+        char const* name_;
+        clock_type::time_point start_;
+        WorkCounters work_;
+    };
+
+    /** Create a profiler keeping the phases of `closes` ledgers. */
+    explicit
+    CloseProfiler (std::size_t closes);
+
+    /** The phases of a ledger, in the order they finished. */
+    std::vector<Event>
+    getEvents (std::uint32_t seq) const;
+
+    /** The last `closes` ledgers kept, in the Chrome trace event format.
+        Each ledger is shown as its own process.
+    */
+    Json::Value
+    getJson (std::size_t closes) const;
+
+private:
+    struct Close
+    {
+        std::uint32_t seq;
+        std::vector<Event> events;
+    };
+
+    void
+    record (std::uint32_t seq, Event const& event);
+
+    std::size_t const capacity_;
+    clock_type::time_point const epoch_;
+
+    std::mutex mutable mutex_;
+
+    // Ordered by ledger sequence, oldest first
+    std::deque<Close> closes_;
+};
+
+}
+}
+
+#endif
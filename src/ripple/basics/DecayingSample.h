@@ -3,8 +3,11 @@
 #ifndef RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 #define RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
 namespace ripple {
 
@@ -72,6 +75,112 @@ private:
 
 
 
+/** A DecayingSample which may be added to from many threads at once.
+
+    The value and the second it was last decayed at are packed in a single
+    word, so adding is one compare and swap and reading never writes. The
+    value decays once for each whole second of the clock which passes, and
+    never goes below zero or above what fits in 32 bits.
+*/
+template <int Window, typename Clock>
+class AtomicDecayingSample
+{
+public:
+    using value_type = typename Clock::duration::rep;
+    using time_point = typename Clock::time_point;
+
+    AtomicDecayingSample () = delete;
+
+    explicit AtomicDecayingSample (time_point now)
+        : m_state (pack (0, seconds (now)))
+    {
+    }
+
+    AtomicDecayingSample (AtomicDecayingSample const&) = delete;
+    AtomicDecayingSample& operator= (AtomicDecayingSample const&) = delete;
+
+    value_type add (value_type value, time_point now)
+    {
+        auto const when = seconds (now);
+        auto state = m_state.load (std::memory_order_relaxed);
+        for (;;)
+        {
+            std::int64_t next = decayed (state, when) + value;
+            if (next < 0)
+                next = 0;
+            else if (next > maxValue)
+                next = maxValue;
+
+            if (m_state.compare_exchange_weak (state,
+                    pack (static_cast<std::uint32_t> (next),
+                        later (last (state), when)),
+                    std::memory_order_relaxed))
+                return next / Window;
+        }
+    }
+
+    value_type value (time_point now) const
+    {
+        return decayed (m_state.load (std::memory_order_relaxed),
+            seconds (now)) / Window;
+    }
+
+    void reset (time_point now)
+    {
+        m_state.store (pack (0, seconds (now)), std::memory_order_relaxed);
+    }
+
+private:
+    static std::int64_t constexpr maxValue =
+        std::numeric_limits<std::uint32_t>::max ();
+
+    static std::uint32_t seconds (time_point now)
+    {
+        return static_cast<std::uint32_t> (std::chrono::duration_cast<
+            std::chrono::seconds>(now.time_since_epoch ()).count ());
+    }
+
+    static std::uint64_t pack (std::uint32_t value, std::uint32_t when)
+    {
+        return (std::uint64_t (when) << 32) | value;
+    }
+
+    static std::uint32_t last (std::uint64_t state)
+    {
+        return static_cast<std::uint32_t> (state >> 32);
+    }
+
+    // Seconds wrap, so compare by the sign of the difference
+    static std::int32_t elapsed (std::uint32_t from, std::uint32_t to)
+    {
+        return static_cast<std::int32_t> (to - from);
+    }
+
+    static std::uint32_t later (std::uint32_t a, std::uint32_t b)
+    {
+        return elapsed (a, b) > 0 ? b : a;
+    }
+
+    static std::int64_t decayed (std::uint64_t state, std::uint32_t when)
+    {
+        std::int64_t value = static_cast<std::uint32_t> (state);
+        auto n = elapsed (last (state), when);
+
+        if (value == 0 || n <= 0)
+            return value;
+
+        if (n > 4 * Window)
+            return 0;
+
+        while (n--)
+            value -= (value + Window - 1) / Window;
+        return value;
+    }
+
+    std::atomic<std::uint64_t> m_state;
+};
+
+
 template <int HalfLife, class Clock>
 class DecayWindow
 {
@@ -0,0 +1,131 @@
+#ifndef RIPPLE_BASICS_LATENCYHISTOGRAM_H_INCLUDED
+#define RIPPLE_BASICS_LATENCYHISTOGRAM_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+/** A histogram of durations with a bounded relative error.
+
+    As in HdrHistogram, durations are counted in microseconds, in buckets
+    splitting each power of two into 32 parts, so percentiles are within
+    about 3% of the true value. Durations from zero to about 71 minutes
+    are told apart; longer ones are counted as 71 minutes.
+
+    Recording never locks: each thread adds to one of a few stripes of
+    counters, allocated the first time a thread using it records.
+    Snapshots are plain values that can be merged, to combine the
+    histograms of several sources before taking percentiles.
+*/
+class LatencyHistogram
+{
+public:
+    static std::size_t constexpr subBucketBits = 5;
+    static std::size_t constexpr maxBits = 32;
+    static std::size_t constexpr bucketCount =
+        (maxBits - subBucketBits + 1) << subBucketBits;
+
+    class Snapshot
+    {
+    public:
+        Snapshot ();
+
+        void
+        merge (Snapshot const& other);
+
+        std::uint64_t
+        count () const
+        {
+            return count_;
+        }
+
+        /** The total of the durations, in microseconds. */
+        std::uint64_t
+        sum () const
+        {
+            return sum_;
+        }
+
+        std::uint64_t
+        max () const
+        {
+            return max_;
+        }
+
+        /** The largest duration, in microseconds, that is counted in the
+            same bucket as the given fraction of the durations.
+        */
+        std::uint64_t
+        percentile (double fraction) const;
+
+        /** The count, mean, max and common percentiles, in microseconds. */
+        Json::Value
+        getJson () const;
+
+    private:
+        friend class LatencyHistogram;
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t count_ = 0;
+        std::uint64_t sum_ = 0;
+        std::uint64_t max_ = 0;
+    };
+
+    LatencyHistogram ();
+
+    LatencyHistogram (LatencyHistogram const&) = delete;
+    LatencyHistogram& operator= (LatencyHistogram const&) = delete;
+
+    ~LatencyHistogram ();
+
+    void
+    insert (std::uint64_t us);
+
+    template <class Rep, class Period>
+    void
+    insert (std::chrono::duration<Rep, Period> d)
+    {
+        auto const us = std::chrono::duration_cast<
+            std::chrono::microseconds> (d).count ();
+        insert (static_cast<std::uint64_t> (us > 0 ? us : 0));
+    }
+
+    Snapshot
+    snapshot () const;
+
+    /** The bucket counting a duration. */
+    static
+    std::size_t
+    bucket (std::uint64_t us);
+
+    /** The largest duration counted in a bucket. */
+    static
+    std::uint64_t
+    highest (std::size_t bucket);
+
+private:
+    static std::size_t constexpr stripes = 16;
+
+    struct Stripe
+    {
+        Stripe ();
+
+        std::array<std::atomic<std::uint64_t>, bucketCount> counts;
+        std::atomic<std::uint64_t> sum;
+        std::atomic<std::uint64_t> max;
+    };
+
+    Stripe&
+    stripe ();
+
+    std::array<std::atomic<Stripe*>, stripes> stripes_;
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RIPPLE_BASICS_PARALLELFOR_H_INCLUDED
+#define RIPPLE_BASICS_PARALLELFOR_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** Call f(i) for every i in [0, n), from up to threads threads.
+
+    The calling thread takes part, so no thread is started when threads
+    is one or there is at most one call to make. The calls are handed out
+    in order, but may run in any order and at the same time, so f must be
+    thread safe.
+
+    If f returns false, or throws, no further calls are started and the
+    calls already running are waited for. The first exception thrown is
+    then rethrown.
+
+    @return false if any call to f returned false.
+*/
+template <class F>
+bool
+parallelFor (std::size_t n, int threads, F&& f)
+{
+    if (threads <= 1 || n <= 1)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            if (! f (i))
+                return false;
+        return true;
+    }
+
+    std::atomic<std::size_t> next {0};
+    std::atomic<bool> stopped {false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]
+    {
+        try
+        {
+            for (auto i = next++; i < n && ! stopped; i = next++)
+            {
+                if (! f (i))
+                    stopped = true;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (! error)
+                error = std::current_exception ();
+            stopped = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    auto const count = std::min<std::size_t> (threads, n);
+    pool.reserve (count - 1);
+    for (std::size_t i = 1; i < count; ++i)
+        pool.emplace_back (worker);
+    worker ();
+    for (auto& t : pool)
+        t.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+
+    return ! stopped;
+}
+
+}
+
+#endif
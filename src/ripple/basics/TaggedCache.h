@@ -8,6 +8,7 @@
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <vector>
@@ -411,6 +412,34 @@ public:
         return v;
     }
 
+    /** Returns up to max strongly cached entries, most recently used first. */
+    std::vector <mapped_ptr> getRecent (std::size_t max) const
+    {
+        using entry_type = std::pair <clock_type::time_point, mapped_ptr>;
+        std::vector <entry_type> v;
+
+        {
+            lock_guard lock (m_mutex);
+            v.reserve (m_cache_count);
+            for (auto const& _ : m_cache)
+                if (_.second.isCached ())
+                    v.emplace_back (_.second.last_access, _.second.ptr);
+        }
+
+        auto const n = std::min (max, v.size ());
+        std::partial_sort (v.begin (), v.begin () + n, v.end (),
+            [](entry_type const& a, entry_type const& b)
+            {
+                return a.first > b.first;
+            });
+
+        std::vector <mapped_ptr> result;
+        result.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+            result.push_back (std::move (v[i].second));
+        return result;
+    }
+
 private:
     void collect_metrics ()
     {
@@ -0,0 +1,181 @@
+#include <ripple/basics/CloseProfiler.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace ripple {
+namespace perf {
+
+// Most phases kept for one ledger
+std::size_t constexpr maxEvents = 1024;
+
+namespace {
+
+struct ThreadState
+{
+    std::uint32_t const id;
+    int depth = 0;
+    WorkCounters work;
+
+    ThreadState ()
+        : id (next ())
+    {
+    }
+
+    static
+    std::uint32_t
+    next ()
+    {
+        static std::atomic<std::uint32_t> ids {0};
+        return ++ids;
+    }
+};
+
+ThreadState&
+threadState ()
+{
+    thread_local ThreadState state;
+    return state;
+}
+
+double
+micros (CloseProfiler::clock_type::duration d)
+{
+    return std::chrono::duration<double, std::micro> (d).count ();
+}
+
+}
+
+WorkCounters&
+workCounters ()
+{
+    return threadState ().work;
+}
+
+CloseProfiler::Scope::Scope (CloseProfiler& profiler,
+        std::uint32_t seq, char const* name)
+    : profiler_ (profiler)
+    , seq_ (seq)
+    , name_ (name)
+    , start_ (clock_type::now ())
+    , work_ (threadState ().work)
+{
+    ++threadState ().depth;
+}
+
+CloseProfiler::Scope::~Scope ()
+{
+    auto& state = threadState ();
+    --state.depth;
+
+    Event event;
+    event.name = name_;
+    event.thread = state.id;
+    event.depth = state.depth;
+    event.start = start_;
+    event.duration = clock_type::now () - start_;
+    event.work.nodesHashed = state.work.nodesHashed - work_.nodesHashed;
+    event.work.nodesWritten = state.work.nodesWritten - work_.nodesWritten;
+    event.work.slesRead = state.work.slesRead - work_.slesRead;
+    profiler_.record (seq_, event);
+}
+
+CloseProfiler::CloseProfiler (std::size_t closes)
+    : capacity_ (std::max<std::size_t> (closes, 1))
+    , epoch_ (clock_type::now ())
+{
+}
+
+void
+CloseProfiler::record (std::uint32_t seq, Event const& event)
+{
+    std::lock_guard<std::mutex> sl (mutex_);
+
+    auto it = std::lower_bound (closes_.begin (), closes_.end (), seq,
+        [](Close const& c, std::uint32_t s)
+        {
+            return c.seq < s;
+        });
+
+    if (it == closes_.end () || it->seq != seq)
+    {
+        // Too old to be kept
+        if (closes_.size () >= capacity_ && it == closes_.begin ())
+            return;
+
+        auto index = std::distance (closes_.begin (), it);
+        closes_.insert (it, Close {seq, {}});
+        if (closes_.size () > capacity_)
+        {
+            closes_.pop_front ();
+            --index;
+        }
+        it = closes_.begin () + index;
+    }
+
+    if (it->events.size () < maxEvents)
+        it->events.push_back (event);
+}
+
+auto
+CloseProfiler::getEvents (std::uint32_t seq) const ->
+    std::vector<Event>
+{
+    std::lock_guard<std::mutex> sl (mutex_);
+    for (auto const& c : closes_)
+    {
+        if (c.seq == seq)
+            return c.events;
+    }
+    return {};
+}
+
+Json::Value
+CloseProfiler::getJson (std::size_t closes) const
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::displayTimeUnit] = "ms";
+    auto& events = ret[jss::traceEvents] = Json::arrayValue;
+
+    std::lock_guard<std::mutex> sl (mutex_);
+    auto const first = closes_.size () > closes
+        ? closes_.end () - closes
+        : closes_.begin ();
+
+    for (auto it = first; it != closes_.end (); ++it)
+    {
+        Json::Value process (Json::objectValue);
+        process[jss::name] = jss::process_name;
+        process[jss::ph] = "M";
+        process[jss::pid] = it->seq;
+        process[jss::args][jss::name] = "ledger " + std::to_string (it->seq);
+        events.append (process);
+
+        for (auto const& e : it->events)
+        {
+            Json::Value event (Json::objectValue);
+            event[jss::name] = e.name;
+            event[jss::cat] = "close";
+            event[jss::ph] = "X";
+            event[jss::pid] = it->seq;
+            event[jss::tid] = e.thread;
+            event[jss::ts] = micros (e.start - epoch_);
+            event[jss::dur] = micros (e.duration);
+
+            auto& args = event[jss::args] = Json::objectValue;
+            args[jss::depth] = e.depth;
+            args[jss::nodes_hashed] =
+                static_cast<Json::UInt> (e.work.nodesHashed);
+            args[jss::nodes_written] =
+                static_cast<Json::UInt> (e.work.nodesWritten);
+            args[jss::sles_read] =
+                static_cast<Json::UInt> (e.work.slesRead);
+            events.append (event);
+        }
+    }
+    return ret;
+}
+
+}
+}
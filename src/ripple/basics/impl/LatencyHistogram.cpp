@@ -0,0 +1,166 @@
+#include <ripple/basics/LatencyHistogram.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace ripple {
+
+std::size_t constexpr LatencyHistogram::subBucketBits;
+std::size_t constexpr LatencyHistogram::maxBits;
+std::size_t constexpr LatencyHistogram::bucketCount;
+std::size_t constexpr LatencyHistogram::stripes;
+
+LatencyHistogram::Snapshot::Snapshot ()
+    : counts_ (bucketCount, 0)
+{
+}
+
+void
+LatencyHistogram::Snapshot::merge (Snapshot const& other)
+{
+    for (std::size_t i = 0; i < bucketCount; ++i)
+        counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max (max_, other.max_);
+}
+
+std::uint64_t
+LatencyHistogram::Snapshot::percentile (double fraction) const
+{
+    if (count_ == 0)
+        return 0;
+
+    auto const rank = std::max<std::uint64_t> (1, static_cast<std::uint64_t> (
+        std::ceil (fraction * count_)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        seen += counts_[i];
+        if (seen >= rank)
+            return std::min (highest (i), max_);
+    }
+    return max_;
+}
+
+Json::Value
+LatencyHistogram::Snapshot::getJson () const
+{
+    // Counts and latencies are 64-bit, so all of them are strings
+    Json::Value ret (Json::objectValue);
+    ret["count"] = std::to_string (count_);
+    ret["mean_us"] = std::to_string (count_ ? sum_ / count_ : 0);
+    ret["p50_us"] = std::to_string (percentile (0.5));
+    ret["p90_us"] = std::to_string (percentile (0.9));
+    ret["p99_us"] = std::to_string (percentile (0.99));
+    ret["p999_us"] = std::to_string (percentile (0.999));
+    ret["max_us"] = std::to_string (max_);
+    return ret;
+}
+
+LatencyHistogram::Stripe::Stripe ()
+    : sum (0)
+    , max (0)
+{
+    for (auto& c : counts)
+        c = 0;
+}
+
+LatencyHistogram::LatencyHistogram ()
+{
+    for (auto& s : stripes_)
+        s = nullptr;
+}
+
+LatencyHistogram::~LatencyHistogram ()
+{
+    for (auto& s : stripes_)
+        delete s.load ();
+}
+
+void
+LatencyHistogram::insert (std::uint64_t us)
+{
+    auto& s = stripe ();
+    s.counts[bucket (us)].fetch_add (1, std::memory_order_relaxed);
+    s.sum.fetch_add (us, std::memory_order_relaxed);
+
+    auto max = s.max.load (std::memory_order_relaxed);
+    while (us > max && ! s.max.compare_exchange_weak (
+        max, us, std::memory_order_relaxed))
+        ;
+}
+
+auto
+LatencyHistogram::snapshot () const -> Snapshot
+{
+    Snapshot snap;
+    for (auto const& p : stripes_)
+    {
+        auto const s = p.load (std::memory_order_acquire);
+        if (! s)
+            continue;
+
+        for (std::size_t i = 0; i < bucketCount; ++i)
+        {
+            auto const n = s->counts[i].load (std::memory_order_relaxed);
+            snap.counts_[i] += n;
+            snap.count_ += n;
+        }
+        snap.sum_ += s->sum.load (std::memory_order_relaxed);
+        snap.max_ = std::max (snap.max_,
+            s->max.load (std::memory_order_relaxed));
+    }
+    return snap;
+}
+
+std::size_t
+LatencyHistogram::bucket (std::uint64_t us)
+{
+    std::uint64_t constexpr subBuckets = 1 << subBucketBits;
+    if (us < subBuckets)
+        return static_cast<std::size_t> (us);
+
+    std::size_t magnitude = subBucketBits;
+    while (magnitude + 1 < maxBits && (us >> (magnitude + 1)) != 0)
+        ++magnitude;
+
+    auto const shift = magnitude - subBucketBits;
+    auto const sub = std::min (us >> shift, 2 * subBuckets - 1);
+    return ((shift + 1) << subBucketBits) +
+        static_cast<std::size_t> (sub - subBuckets);
+}
+
+std::uint64_t
+LatencyHistogram::highest (std::size_t bucket)
+{
+    std::uint64_t constexpr subBuckets = 1 << subBucketBits;
+    auto const group = bucket >> subBucketBits;
+    if (group == 0)
+        return bucket;
+
+    auto const shift = group - 1;
+    auto const lowest = ((bucket & (subBuckets - 1)) + subBuckets) << shift;
+    return lowest + (std::uint64_t (1) << shift) - 1;
+}
+
+auto
+LatencyHistogram::stripe () -> Stripe&
+{
+    static std::atomic<std::size_t> next {0};
+    thread_local std::size_t const index = next++ % stripes;
+
+    auto& slot = stripes_[index];
+    auto s = slot.load (std::memory_order_acquire);
+    if (s)
+        return *s;
+
+    auto fresh = std::make_unique<Stripe> ();
+    if (slot.compare_exchange_strong (s, fresh.get (),
+            std::memory_order_acq_rel))
+        s = fresh.release ();
+    return *s;
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef BEAST_INSIGHT_AGGREGATEDCOLLECTOR_H_INCLUDED
+#define BEAST_INSIGHT_AGGREGATEDCOLLECTOR_H_INCLUDED
+
+#include <ripple/beast/insight/Collector.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/beast/net/IPEndpoint.h>
+#include <boost/optional.hpp>
+#include <chrono>
+
+namespace beast {
+namespace insight {
+
+/** A Collector that aggregates metrics in memory.
+
+    Updates are added to atomic cells striped by thread, so recording a
+    sample never takes a lock or formats a string. At each interval the
+    cells are summed into a snapshot holding one record per metric: the
+    running total of a counter or meter, the value of a gauge, and the
+    count, sum and power of two millisecond buckets of an event.
+
+    If an address is given, each snapshot is sent there in UDP packets of
+    varint encoded records. The last snapshot can also be rendered in the
+    Prometheus text exposition format.
+*/
+class AggregatedCollector : public Collector
+{
+public:
+    explicit AggregatedCollector() = default;
+
+    /** Take a snapshot now rather than waiting for the interval. */
+    virtual void flush () = 0;
+
+    /** The last snapshot in the Prometheus text exposition format. */
+    virtual std::string prometheus () = 0;
+
+    static
+    std::shared_ptr <AggregatedCollector>
+    New (std::string const& prefix, std::chrono::milliseconds interval,
+        boost::optional <IP::Endpoint> const& address, Journal journal);
+};
+
+}
+}
+
+#endif
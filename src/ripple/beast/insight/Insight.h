@@ -3,6 +3,7 @@
 #ifndef BEAST_INSIGHT_H_INCLUDED
 #define BEAST_INSIGHT_H_INCLUDED
 
+#include <ripple/beast/insight/AggregatedCollector.h>
 #include <ripple/beast/insight/Counter.h>
 #include <ripple/beast/insight/CounterImpl.h>
 #include <ripple/beast/insight/Event.h>
@@ -0,0 +1,786 @@
+#include <ripple/beast/net/IPAddressConversion.h>
+#include <ripple/beast/insight/HookImpl.h>
+#include <ripple/beast/insight/CounterImpl.h>
+#include <ripple/beast/insight/EventImpl.h>
+#include <ripple/beast/insight/GaugeImpl.h>
+#include <ripple/beast/insight/MeterImpl.h>
+#include <ripple/beast/insight/AggregatedCollector.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/beast/core/List.h>
+#include <boost/asio/ip/udp.hpp>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace beast {
+namespace insight {
+
+namespace detail {
+
+class AggregatedCollectorImp;
+
+// Number of cells each metric spreads its updates over
+static std::size_t constexpr stripes = 16;
+
+// Power of two millisecond buckets of an event, the last unbounded
+static std::size_t constexpr eventBuckets = 21;
+
+// The cell used by the calling thread
+static
+std::size_t
+stripe ()
+{
+    static std::atomic <std::size_t> next {0};
+    thread_local std::size_t const index = next++ % stripes;
+    return index;
+}
+
+// The bucket counting an event of the given duration
+static
+std::size_t
+eventBucket (std::uint64_t ms)
+{
+    std::size_t i = 0;
+    for (std::uint64_t bound = 1; ms > bound && i + 1 < eventBuckets;
+            bound <<= 1)
+        ++i;
+    return i;
+}
+
+enum class Kind : std::uint8_t
+{
+    counter,
+    gauge,
+    meter,
+    event
+};
+
+struct Record
+{
+    Kind kind;
+    std::int64_t value = 0;
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::array <std::uint64_t, eventBuckets> buckets {};
+};
+
+// One record per metric name, in name order
+using Snapshot = std::map <std::string, Record>;
+
+// Metrics sharing a name are merged into one record
+static
+void
+merge (Snapshot& snapshot, std::string const& name, Record const& record)
+{
+    auto const result = snapshot.emplace (name, record);
+    if (result.second)
+        return;
+
+    auto& r = result.first->second;
+    if (r.kind != record.kind)
+        return;
+
+    if (r.kind == Kind::gauge)
+    {
+        r.value = record.value;
+        return;
+    }
+
+    r.value += record.value;
+    r.count += record.count;
+    r.sum += record.sum;
+    for (std::size_t i = 0; i < eventBuckets; ++i)
+        r.buckets[i] += record.buckets[i];
+}
+
+// A sum whose updates from different threads land on different cache lines
+template <class T>
+class StripedSum
+{
+public:
+    StripedSum () = default;
+    StripedSum (StripedSum const&) = delete;
+    StripedSum& operator= (StripedSum const&) = delete;
+
+    void add (T amount)
+    {
+        cells_[stripe ()].value.fetch_add (
+            amount, std::memory_order_relaxed);
+    }
+
+    T load () const
+    {
+        T total = 0;
+        for (auto const& cell : cells_)
+            total += cell.value.load (std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic <T> value {0};
+        char pad[64 - sizeof (std::atomic <T>)];
+    };
+
+    std::array <Cell, stripes> cells_;
+};
+
+
+class AggregatedMetricBase : public List <AggregatedMetricBase>::Node
+{
+public:
+    virtual void do_hook ()
+    {
+    }
+
+    virtual void do_collect (Snapshot&)
+    {
+    }
+
+    virtual ~AggregatedMetricBase() = default;
+    AggregatedMetricBase() = default;
+    AggregatedMetricBase(AggregatedMetricBase const&) = delete;
+    AggregatedMetricBase& operator=(AggregatedMetricBase const&) = delete;
+};
+
+
+class AggregatedHookImpl
+    : public HookImpl
+    , public AggregatedMetricBase
+{
+public:
+    AggregatedHookImpl (HandlerType const& handler,
+        std::shared_ptr <AggregatedCollectorImp> const& impl);
+
+    ~AggregatedHookImpl () override;
+
+    void do_hook () override;
+
+private:
+    AggregatedHookImpl& operator= (AggregatedHookImpl const&);
+
+    std::shared_ptr <AggregatedCollectorImp> m_impl;
+    HandlerType m_handler;
+};
+
+
+class AggregatedCounterImpl
+    : public CounterImpl
+    , public AggregatedMetricBase
+{
+public:
+    AggregatedCounterImpl (std::string const& name,
+        std::shared_ptr <AggregatedCollectorImp> const& impl);
+
+    ~AggregatedCounterImpl () override;
+
+    void increment (CounterImpl::value_type amount) override;
+
+    void do_collect (Snapshot& snapshot) override;
+
+private:
+    AggregatedCounterImpl& operator= (AggregatedCounterImpl const&);
+
+    std::shared_ptr <AggregatedCollectorImp> m_impl;
+    std::string m_name;
+    StripedSum <CounterImpl::value_type> m_value;
+};
+
+
+class AggregatedEventImpl
+    : public EventImpl
+    , public AggregatedMetricBase
+{
+public:
+    AggregatedEventImpl (std::string const& name,
+        std::shared_ptr <AggregatedCollectorImp> const& impl);
+
+    ~AggregatedEventImpl () override;
+
+    void notify (EventImpl::value_type const& value) override;
+
+    void do_collect (Snapshot& snapshot) override;
+
+private:
+    AggregatedEventImpl& operator= (AggregatedEventImpl const&);
+
+    struct alignas(64) Cell
+    {
+        std::array <std::atomic <std::uint64_t>, eventBuckets> buckets;
+        std::atomic <std::uint64_t> count;
+        std::atomic <std::uint64_t> sum;
+    };
+
+    std::shared_ptr <AggregatedCollectorImp> m_impl;
+    std::string m_name;
+    std::array <Cell, stripes> m_cells;
+};
+
+
+class AggregatedGaugeImpl
+    : public GaugeImpl
+    , public AggregatedMetricBase
+{
+public:
+    AggregatedGaugeImpl (std::string const& name,
+        std::shared_ptr <AggregatedCollectorImp> const& impl);
+
+    ~AggregatedGaugeImpl () override;
+
+    void set (GaugeImpl::value_type value) override;
+    void increment (GaugeImpl::difference_type amount) override;
+
+    void do_collect (Snapshot& snapshot) override;
+
+private:
+    AggregatedGaugeImpl& operator= (AggregatedGaugeImpl const&);
+
+    std::shared_ptr <AggregatedCollectorImp> m_impl;
+    std::string m_name;
+    std::atomic <GaugeImpl::value_type> m_value;
+};
+
+
+class AggregatedMeterImpl
+    : public MeterImpl
+    , public AggregatedMetricBase
+{
+public:
+    explicit AggregatedMeterImpl (std::string const& name,
+        std::shared_ptr <AggregatedCollectorImp> const& impl);
+
+    ~AggregatedMeterImpl () override;
+
+    void increment (MeterImpl::value_type amount) override;
+
+    void do_collect (Snapshot& snapshot) override;
+
+private:
+    AggregatedMeterImpl& operator= (AggregatedMeterImpl const&);
+
+    std::shared_ptr <AggregatedCollectorImp> m_impl;
+    std::string m_name;
+    StripedSum <MeterImpl::value_type> m_value;
+};
+
+
+class AggregatedCollectorImp
+    : public AggregatedCollector
+    , public std::enable_shared_from_this <AggregatedCollectorImp>
+{
+private:
+    enum
+    {
+        max_packet_size = 1472,
+        version = 1
+    };
+
+    Journal m_journal;
+    std::string m_prefix;
+    std::chrono::milliseconds m_interval;
+    boost::asio::io_service m_io_service;
+    boost::asio::ip::udp::socket m_socket;
+    std::recursive_mutex metricsLock_;
+    List <AggregatedMetricBase> metrics_;
+
+    // Serializes snapshots
+    std::mutex flushLock_;
+    std::uint64_t sequence_ = 0;
+
+    std::mutex snapshotLock_;
+    std::shared_ptr <Snapshot const> snapshot_;
+
+    std::mutex stopLock_;
+    std::condition_variable stopCond_;
+    bool stopping_ = false;
+
+    std::thread m_thread;
+
+    static
+    void
+    put_varint (std::string& s, std::uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            s.push_back (static_cast <char> ((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        s.push_back (static_cast <char> (v));
+    }
+
+    static
+    void
+    put_string (std::string& s, std::string const& v)
+    {
+        auto const size = std::min <std::size_t> (v.size (), 255);
+        s.push_back (static_cast <char> (size));
+        s.append (v, 0, size);
+    }
+
+    static
+    std::string
+    metric_name (std::string const& prefix, std::string const& name)
+    {
+        std::string s = prefix.empty () ? name : prefix + "_" + name;
+        for (auto& c : s)
+        {
+            if (! std::isalnum (static_cast <unsigned char> (c)) &&
+                    c != '_' && c != ':')
+                c = '_';
+        }
+        if (s.empty () || std::isdigit (static_cast <unsigned char> (s[0])))
+            s.insert (0, 1, '_');
+        return s;
+    }
+
+public:
+    AggregatedCollectorImp (
+        std::string const& prefix,
+        std::chrono::milliseconds interval,
+        boost::optional <IP::Endpoint> const& address,
+        Journal journal)
+        : m_journal (journal)
+        , m_prefix (prefix)
+        , m_interval (interval)
+        , m_socket (m_io_service)
+    {
+        if (address)
+        {
+            boost::system::error_code ec;
+            m_socket.connect (boost::asio::ip::udp::endpoint (
+                address->address (), address->port ()), ec);
+            if (ec)
+            {
+                if (auto stream = m_journal.error())
+                    stream << "Connect failed: " << ec.message();
+                m_socket.close (ec);
+            }
+        }
+
+        m_thread = std::thread (&AggregatedCollectorImp::run, this);
+    }
+
+    ~AggregatedCollectorImp () override
+    {
+        {
+            std::lock_guard<std::mutex> _(stopLock_);
+            stopping_ = true;
+        }
+        stopCond_.notify_all ();
+        m_thread.join ();
+
+        boost::system::error_code ec;
+        m_socket.close (ec);
+    }
+
+    Hook make_hook (HookImpl::HandlerType const& handler) override
+    {
+        return Hook (std::make_shared <detail::AggregatedHookImpl> (
+            handler, shared_from_this ()));
+    }
+
+    Counter make_counter (std::string const& name) override
+    {
+        return Counter (std::make_shared <detail::AggregatedCounterImpl> (
+            name, shared_from_this ()));
+    }
+
+    Event make_event (std::string const& name) override
+    {
+        return Event (std::make_shared <detail::AggregatedEventImpl> (
+            name, shared_from_this ()));
+    }
+
+    Gauge make_gauge (std::string const& name) override
+    {
+        return Gauge (std::make_shared <detail::AggregatedGaugeImpl> (
+            name, shared_from_this ()));
+    }
+
+    Meter make_meter (std::string const& name) override
+    {
+        return Meter (std::make_shared <detail::AggregatedMeterImpl> (
+            name, shared_from_this ()));
+    }
+
+
+    void add (AggregatedMetricBase& metric)
+    {
+        std::lock_guard<std::recursive_mutex> _(metricsLock_);
+        metrics_.push_back (metric);
+    }
+
+    void remove (AggregatedMetricBase& metric)
+    {
+        std::lock_guard<std::recursive_mutex> _(metricsLock_);
+        metrics_.erase (metrics_.iterator_to (metric));
+    }
+
+
+    void flush () override
+    {
+        std::lock_guard<std::mutex> _(flushLock_);
+
+        auto snapshot = std::make_shared <Snapshot> ();
+        {
+            std::lock_guard<std::recursive_mutex> lock (metricsLock_);
+
+            // Hooks usually set gauges, so they run first
+            for (auto& m : metrics_)
+                m.do_hook ();
+
+            for (auto& m : metrics_)
+                m.do_collect (*snapshot);
+        }
+
+        ++sequence_;
+        if (m_socket.is_open ())
+            send (*snapshot);
+
+        std::lock_guard<std::mutex> lock (snapshotLock_);
+        snapshot_ = std::move (snapshot);
+    }
+
+    std::string prometheus () override
+    {
+        std::shared_ptr <Snapshot const> snapshot;
+        {
+            std::lock_guard<std::mutex> _(snapshotLock_);
+            snapshot = snapshot_;
+        }
+
+        std::ostringstream ss;
+        if (! snapshot)
+            return ss.str ();
+
+        for (auto const& item : *snapshot)
+        {
+            auto const name = metric_name (m_prefix, item.first);
+            auto const& r = item.second;
+            switch (r.kind)
+            {
+            case Kind::counter:
+            case Kind::meter:
+                ss << "# TYPE " << name << " counter\n" <<
+                    name << " " << r.value << "\n";
+                break;
+
+            case Kind::gauge:
+                ss << "# TYPE " << name << " gauge\n" <<
+                    name << " " << r.value << "\n";
+                break;
+
+            case Kind::event:
+            {
+                ss << "# TYPE " << name << " histogram\n";
+                std::uint64_t cumulative = 0;
+                for (std::size_t i = 0; i < eventBuckets; ++i)
+                {
+                    cumulative += r.buckets[i];
+                    ss << name << "_bucket{le=\"";
+                    if (i + 1 < eventBuckets)
+                        ss << (std::uint64_t (1) << i);
+                    else
+                        ss << "+Inf";
+                    ss << "\"} " << cumulative << "\n";
+                }
+                ss << name << "_sum " << r.sum << "\n" <<
+                    name << "_count " << r.count << "\n";
+                break;
+            }
+            }
+        }
+        return ss.str ();
+    }
+
+    // Each packet holds a header followed by whole records:
+    //
+    //   header: version, varint sequence, prefix
+    //   record: kind, name, then by kind
+    //     counter: zigzag varint total
+    //     gauge:   varint value
+    //     meter:   varint total
+    //     event:   varint count, varint sum, bucket count n,
+    //              n varint bucket counts
+    //
+    // Strings are a length byte followed by at most 255 characters.
+    void send (Snapshot const& snapshot)
+    {
+        std::string header;
+        header.push_back (static_cast <char> (version));
+        put_varint (header, sequence_);
+        put_string (header, m_prefix);
+
+        std::string packet = header;
+        std::string record;
+        for (auto const& item : snapshot)
+        {
+            auto const& r = item.second;
+            record.clear ();
+            record.push_back (static_cast <char> (r.kind));
+            put_string (record, item.first);
+            switch (r.kind)
+            {
+            case Kind::counter:
+            {
+                auto const v = static_cast <std::uint64_t> (r.value);
+                put_varint (record, (v << 1) ^
+                    static_cast <std::uint64_t> (r.value >> 63));
+                break;
+            }
+
+            case Kind::gauge:
+            case Kind::meter:
+                put_varint (record, static_cast <std::uint64_t> (r.value));
+                break;
+
+            case Kind::event:
+            {
+                put_varint (record, r.count);
+                put_varint (record, r.sum);
+                std::size_t n = eventBuckets;
+                while (n > 0 && r.buckets[n - 1] == 0)
+                    --n;
+                record.push_back (static_cast <char> (n));
+                for (std::size_t i = 0; i < n; ++i)
+                    put_varint (record, r.buckets[i]);
+                break;
+            }
+            }
+
+            if (packet.size () > header.size () &&
+                packet.size () + record.size () > max_packet_size)
+            {
+                send_packet (packet);
+                packet = header;
+            }
+            packet += record;
+        }
+
+        if (packet.size () > header.size ())
+            send_packet (packet);
+    }
+
+    void send_packet (std::string const& packet)
+    {
+        boost::system::error_code ec;
+        m_socket.send (boost::asio::buffer (packet), 0, ec);
+        if (ec)
+        {
+            if (auto stream = m_journal.error())
+                stream << "send failed: " << ec.message();
+        }
+    }
+
+    void run ()
+    {
+        beast::setCurrentThreadName ("insight");
+
+        std::unique_lock<std::mutex> lock (stopLock_);
+        for (;;)
+        {
+            if (stopCond_.wait_for (lock, m_interval,
+                    [this] { return stopping_; }))
+                return;
+
+            lock.unlock ();
+            flush ();
+            lock.lock ();
+        }
+    }
+};
+
+
+AggregatedHookImpl::AggregatedHookImpl (HandlerType const& handler,
+    std::shared_ptr <AggregatedCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_handler (handler)
+{
+    m_impl->add (*this);
+}
+
+AggregatedHookImpl::~AggregatedHookImpl ()
+{
+    m_impl->remove (*this);
+}
+
+void AggregatedHookImpl::do_hook ()
+{
+    m_handler ();
+}
+
+
+AggregatedCounterImpl::AggregatedCounterImpl (std::string const& name,
+    std::shared_ptr <AggregatedCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_name (name)
+{
+    m_impl->add (*this);
+}
+
+AggregatedCounterImpl::~AggregatedCounterImpl ()
+{
+    m_impl->remove (*this);
+}
+
+void AggregatedCounterImpl::increment (CounterImpl::value_type amount)
+{
+    m_value.add (amount);
+}
+
+void AggregatedCounterImpl::do_collect (Snapshot& snapshot)
+{
+    Record r;
+    r.kind = Kind::counter;
+    r.value = m_value.load ();
+    merge (snapshot, m_name, r);
+}
+
+
+AggregatedEventImpl::AggregatedEventImpl (std::string const& name,
+    std::shared_ptr <AggregatedCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_name (name)
+{
+    for (auto& cell : m_cells)
+    {
+        for (auto& b : cell.buckets)
+            b = 0;
+        cell.count = 0;
+        cell.sum = 0;
+    }
+    m_impl->add (*this);
+}
+
+AggregatedEventImpl::~AggregatedEventImpl ()
+{
+    m_impl->remove (*this);
+}
+
+void AggregatedEventImpl::notify (EventImpl::value_type const& value)
+{
+    auto const ms = static_cast <std::uint64_t> (
+        std::max <EventImpl::value_type::rep> (value.count (), 0));
+    auto& cell = m_cells[stripe ()];
+    cell.buckets[eventBucket (ms)].fetch_add (1, std::memory_order_relaxed);
+    cell.count.fetch_add (1, std::memory_order_relaxed);
+    cell.sum.fetch_add (ms, std::memory_order_relaxed);
+}
+
+void AggregatedEventImpl::do_collect (Snapshot& snapshot)
+{
+    Record r;
+    r.kind = Kind::event;
+    for (auto const& cell : m_cells)
+    {
+        for (std::size_t i = 0; i < eventBuckets; ++i)
+            r.buckets[i] += cell.buckets[i].load (std::memory_order_relaxed);
+        r.count += cell.count.load (std::memory_order_relaxed);
+        r.sum += cell.sum.load (std::memory_order_relaxed);
+    }
+    merge (snapshot, m_name, r);
+}
+
+
+AggregatedGaugeImpl::AggregatedGaugeImpl (std::string const& name,
+    std::shared_ptr <AggregatedCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_name (name)
+    , m_value (0)
+{
+    m_impl->add (*this);
+}
+
+AggregatedGaugeImpl::~AggregatedGaugeImpl ()
+{
+    m_impl->remove (*this);
+}
+
+void AggregatedGaugeImpl::set (GaugeImpl::value_type value)
+{
+    m_value.store (value, std::memory_order_relaxed);
+}
+
+void AggregatedGaugeImpl::increment (GaugeImpl::difference_type amount)
+{
+    auto value = m_value.load (std::memory_order_relaxed);
+    GaugeImpl::value_type next;
+    do
+    {
+        next = value;
+        if (amount > 0)
+        {
+            GaugeImpl::value_type const d (
+                static_cast <GaugeImpl::value_type> (amount));
+            next +=
+                (d >= std::numeric_limits <GaugeImpl::value_type>::max() - value)
+                ? std::numeric_limits <GaugeImpl::value_type>::max() - value
+                : d;
+        }
+        else if (amount < 0)
+        {
+            GaugeImpl::value_type const d (
+                static_cast <GaugeImpl::value_type> (-amount));
+            next = (d >= value) ? 0 : value - d;
+        }
+    }
+    while (! m_value.compare_exchange_weak (value, next,
+        std::memory_order_relaxed));
+}
+
+void AggregatedGaugeImpl::do_collect (Snapshot& snapshot)
+{
+    Record r;
+    r.kind = Kind::gauge;
+    r.value = static_cast <std::int64_t> (
+        m_value.load (std::memory_order_relaxed));
+    merge (snapshot, m_name, r);
+}
+
+
+AggregatedMeterImpl::AggregatedMeterImpl (std::string const& name,
+    std::shared_ptr <AggregatedCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_name (name)
+{
+    m_impl->add (*this);
+}
+
+AggregatedMeterImpl::~AggregatedMeterImpl ()
+{
+    m_impl->remove (*this);
+}
+
+void AggregatedMeterImpl::increment (MeterImpl::value_type amount)
+{
+    m_value.add (amount);
+}
+
+void AggregatedMeterImpl::do_collect (Snapshot& snapshot)
+{
+    Record r;
+    r.kind = Kind::meter;
+    r.value = static_cast <std::int64_t> (m_value.load ());
+    merge (snapshot, m_name, r);
+}
+
+}
+
+
+std::shared_ptr <AggregatedCollector> AggregatedCollector::New (
+    std::string const& prefix, std::chrono::milliseconds interval,
+    boost::optional <IP::Endpoint> const& address, Journal journal)
+{
+    return std::make_shared <detail::AggregatedCollectorImp> (
+        prefix, interval, address, journal);
+}
+
+}
+}
@@ -4,6 +4,7 @@
 
 #include <ripple/beast/insight/Insight.h>
 
+#include <ripple/beast/insight/impl/AggregatedCollector.cpp>
 #include <ripple/beast/insight/impl/Collector.cpp>
 #include <ripple/beast/insight/impl/Groups.cpp>
 #include <ripple/beast/insight/impl/Hook.cpp>
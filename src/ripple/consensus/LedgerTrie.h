@@ -3,12 +3,16 @@
 #ifndef RIPPLE_APP_CONSENSUS_LEDGERS_TRIE_H_INCLUDED
 #define RIPPLE_APP_CONSENSUS_LEDGERS_TRIE_H_INCLUDED
 
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/json/json_value.h>
 #include <boost/optional.hpp>
 #include <algorithm>
-#include <memory>
+#include <iomanip>
+#include <limits>
+#include <map>
 #include <sstream>
 #include <stack>
+#include <tuple>
 #include <vector>
 
 namespace ripple {
@@ -156,11 +160,11 @@ private:
 template <class Ledger>
 struct Node
 {
-    Node() = default;
+    using Index = std::uint32_t;
 
-    explicit Node(Ledger const& l) : span{l}, tipSupport{1}, branchSupport{1}
-    {
-    }
+    static Index constexpr none = std::numeric_limits<Index>::max();
+
+    Node() = default;
 
     explicit Node(Span<Ledger> s) : span{std::move(s)}
     {
@@ -170,19 +174,19 @@ struct Node
     std::uint32_t tipSupport = 0;
     std::uint32_t branchSupport = 0;
 
-    std::vector<std::unique_ptr<Node>> children;
-    Node* parent = nullptr;
+    std::vector<Index> children;
+    Index parent = none;
+
+    // The two children with the most branch support, ties going to the
+    // larger starting ledger ID
+    Index best = none;
+    Index second = none;
 
     
     void
-    erase(Node const* child)
-    {
-        auto it = std::find_if(
-            children.begin(),
-            children.end(),
-            [child](std::unique_ptr<Node> const& curr) {
-                return curr.get() == child;
-            });
+    erase(Index child)
+    {
+        auto it = std::find(children.begin(), children.end(), child);
         assert(it != children.end());
         std::swap(*it, children.back());
         children.pop_back();
@@ -194,28 +198,6 @@ struct Node
         return o << s.span << "(T:" << s.tipSupport << ",B:" << s.branchSupport
                  << ")";
     }
-
-    Json::Value
-    getJson() const
-    {
-        Json::Value res;
-        std::stringstream sps;
-        sps << span;
-        res["span"] = sps.str();
-        res["startID"] = to_string(span.startID());
-        res["seq"] = static_cast<std::uint32_t>(span.tip().seq);
-        res["tipSupport"] = tipSupport;
-        res["branchSupport"] = branchSupport;
-        if (!children.empty())
-        {
-            Json::Value& cs = (res["children"] = Json::arrayValue);
-            for (auto const& child : children)
-            {
-                cs.append(child->getJson());
-            }
-        }
-        return res;
-    }
 };
 }  
 
@@ -228,33 +210,153 @@ class LedgerTrie
 
     using Node = ledger_trie_detail::Node<Ledger>;
     using Span = ledger_trie_detail::Span<Ledger>;
+    using Index = typename Node::Index;
+
+    static Index constexpr root = 0;
+    static Index constexpr none = Node::none;
 
-    std::unique_ptr<Node> root;
+    // Nodes by index, the root first. Removed nodes are reused.
+    std::vector<Node> nodes_;
+    std::vector<Index> free_;
+
+    // Node by the sequence and ID of the ledger at its tip
+    using TipKey = std::pair<Seq, ID>;
+    hash_map<TipKey, Index> tips_;
 
     std::map<Seq, std::uint32_t> seqSupport;
 
+    // The preferred ledger for the largest sequence last asked about,
+    // until support next changes
+    mutable boost::optional<Seq> cachedIssued_;
+    mutable boost::optional<SpanTip<Ledger>> cachedPreferred_;
+
+    static TipKey
+    tipKey(Span const& span)
+    {
+        auto const tip = span.tip();
+        return {tip.seq, tip.id};
+    }
+
+    void
+    addTip(Index i)
+    {
+        bool const added = tips_.emplace(tipKey(nodes_[i].span), i).second;
+        assert(added);
+        (void)added;
+    }
+
+    void
+    removeTip(Index i)
+    {
+        auto const it = tips_.find(tipKey(nodes_[i].span));
+        assert(it != tips_.end() && it->second == i);
+        if (it != tips_.end() && it->second == i)
+            tips_.erase(it);
+    }
+
+    bool
+    ranksAbove(Index a, Index b) const
+    {
+        return std::make_tuple(
+                   nodes_[a].branchSupport, nodes_[a].span.startID()) >
+            std::make_tuple(nodes_[b].branchSupport, nodes_[b].span.startID());
+    }
+
+    // Places a child that is not one of the two best of its parent
+    void
+    consider(Index parent, Index child)
+    {
+        Node& node = nodes_[parent];
+        if (node.best == none || ranksAbove(child, node.best))
+        {
+            node.second = node.best;
+            node.best = child;
+        }
+        else if (node.second == none || ranksAbove(child, node.second))
+            node.second = child;
+    }
+
+    void
+    rank(Index parent)
+    {
+        nodes_[parent].best = none;
+        nodes_[parent].second = none;
+        for (Index child : nodes_[parent].children)
+            consider(parent, child);
+    }
+
+    // Updates the ranking in its parent of a node whose branch support
+    // was just raised or lowered
+    void
+    reranked(Index child, bool raised)
+    {
+        Index const parent = nodes_[child].parent;
+        if (parent == none)
+            return;
+
+        Node& node = nodes_[parent];
+        if (child == node.best)
+        {
+            if (!raised && node.second != none && ranksAbove(node.second, child))
+                rank(parent);
+        }
+        else if (child == node.second)
+        {
+            if (raised && ranksAbove(child, node.best))
+                std::swap(node.best, node.second);
+            else if (!raised && node.children.size() > 2)
+                rank(parent);
+        }
+        else if (raised)
+            consider(parent, child);
+    }
+
+    Index
+    allocate(Span const& span)
+    {
+        Index i;
+        if (!free_.empty())
+        {
+            i = free_.back();
+            free_.pop_back();
+            nodes_[i] = Node{span};
+        }
+        else
+        {
+            i = static_cast<Index>(nodes_.size());
+            nodes_.emplace_back(span);
+        }
+        return i;
+    }
+
+    void
+    release(Index i)
+    {
+        removeTip(i);
+        nodes_[i].children.clear();
+        free_.push_back(i);
+    }
+
     
-    std::pair<Node*, Seq>
+    std::pair<Index, Seq>
     find(Ledger const& ledger) const
     {
-        Node* curr = root.get();
-
-        assert(curr);
-        Seq pos = curr->span.diff(ledger);
+        Index curr = root;
+        Seq pos = nodes_[curr].span.diff(ledger);
 
         bool done = false;
 
-        while (!done && pos == curr->span.end())
+        while (!done && pos == nodes_[curr].span.end())
         {
             done = true;
-            for (std::unique_ptr<Node> const& child : curr->children)
+            for (Index child : nodes_[curr].children)
             {
-                auto const childPos = child->span.diff(ledger);
+                auto const childPos = nodes_[child].span.diff(ledger);
                 if (childPos > pos)
                 {
                     done = false;
                     pos = childPos;
-                    curr = child.get();
+                    curr = child;
                     break;
                 }
             }
@@ -263,107 +365,199 @@ class LedgerTrie
     }
 
     
-    Node*
-    findByLedgerID(Ledger const& ledger, Node* parent = nullptr) const
-    {
-        if (!parent)
-            parent = root.get();
-        if (ledger.id() == parent->span.tip().id)
-            return parent;
-        for (auto const& child : parent->children)
+    Index
+    findByLedgerID(Ledger const& ledger) const
+    {
+        auto const it = tips_.find(TipKey{ledger.seq(), ledger.id()});
+        if (it == tips_.end())
+            return none;
+        return it->second;
+    }
+
+    boost::optional<SpanTip<Ledger>>
+    findPreferred(Seq const largestIssued) const
+    {
+        if (empty())
+            return boost::none;
+
+        Index curr = root;
+
+        bool done = false;
+
+        std::uint32_t uncommitted = 0;
+        auto uncommittedIt = seqSupport.begin();
+
+        while (!done)
         {
-            auto cl = findByLedgerID(ledger, child.get());
-            if (cl)
-                return cl;
+            Node const& node = nodes_[curr];
+            {
+                Seq nextSeq = node.span.start() + Seq{1};
+                while (uncommittedIt != seqSupport.end() &&
+                       uncommittedIt->first < std::max(nextSeq, largestIssued))
+                {
+                    uncommitted += uncommittedIt->second;
+                    uncommittedIt++;
+                }
+
+                while (nextSeq < node.span.end() &&
+                       node.branchSupport > uncommitted)
+                {
+                    if (uncommittedIt != seqSupport.end() &&
+                        uncommittedIt->first < node.span.end())
+                    {
+                        nextSeq = uncommittedIt->first + Seq{1};
+                        uncommitted += uncommittedIt->second;
+                        uncommittedIt++;
+                    }
+                    else  
+                        nextSeq = node.span.end();
+                }
+                if (nextSeq < node.span.end())
+                    return node.span.before(nextSeq)->tip();
+            }
+
+            Index const best = node.best;
+            Index const second = node.second;
+
+            std::uint32_t margin = 0;
+            if (second == none)
+            {
+                if (best != none)
+                    margin = nodes_[best].branchSupport;
+            }
+            else
+            {
+                margin =
+                    nodes_[best].branchSupport - nodes_[second].branchSupport;
+
+                if (nodes_[best].span.startID() > nodes_[second].span.startID())
+                    margin++;
+            }
+
+            if (best != none && ((margin > uncommitted) || (uncommitted == 0)))
+                curr = best;
+            else  
+                done = true;
         }
-        return nullptr;
+        return nodes_[curr].span.tip();
     }
 
     void
-    dumpImpl(std::ostream& o, std::unique_ptr<Node> const& curr, int offset)
-        const
+    dumpImpl(std::ostream& o, Index curr, int offset) const
+    {
+        if (offset > 0)
+            o << std::setw(offset) << "|-";
+
+        std::stringstream ss;
+        ss << nodes_[curr];
+        o << ss.str() << std::endl;
+        for (Index child : nodes_[curr].children)
+            dumpImpl(o, child, offset + 1 + ss.str().size() + 2);
+    }
+
+    Json::Value
+    getJson(Index curr) const
     {
-        if (curr)
+        Node const& node = nodes_[curr];
+        Json::Value res;
+        std::stringstream sps;
+        sps << node.span;
+        res["span"] = sps.str();
+        res["startID"] = to_string(node.span.startID());
+        res["seq"] = static_cast<std::uint32_t>(node.span.tip().seq);
+        res["tipSupport"] = node.tipSupport;
+        res["branchSupport"] = node.branchSupport;
+        if (!node.children.empty())
         {
-            if (offset > 0)
-                o << std::setw(offset) << "|-";
-
-            std::stringstream ss;
-            ss << *curr;
-            o << ss.str() << std::endl;
-            for (std::unique_ptr<Node> const& child : curr->children)
-                dumpImpl(o, child, offset + 1 + ss.str().size() + 2);
+            Json::Value& cs = (res["children"] = Json::arrayValue);
+            for (Index child : node.children)
+            {
+                cs.append(getJson(child));
+            }
         }
+        return res;
     }
 
 public:
-    LedgerTrie() : root{std::make_unique<Node>()}
+    LedgerTrie()
     {
+        nodes_.emplace_back();
+        addTip(root);
     }
 
     
     void
     insert(Ledger const& ledger, std::uint32_t count = 1)
     {
-        Node* loc;
+        Index loc;
         Seq diffSeq;
         std::tie(loc, diffSeq) = find(ledger);
 
-        assert(loc);
-
-        Node* incNode = loc;
+        Index incNode = loc;
 
 
-        boost::optional<Span> prefix = loc->span.before(diffSeq);
-        boost::optional<Span> oldSuffix = loc->span.from(diffSeq);
+        boost::optional<Span> prefix = nodes_[loc].span.before(diffSeq);
+        boost::optional<Span> oldSuffix = nodes_[loc].span.from(diffSeq);
         boost::optional<Span> newSuffix = Span{ledger}.from(diffSeq);
 
         if (oldSuffix)
         {
-
-            auto newNode = std::make_unique<Node>(*oldSuffix);
-            newNode->tipSupport = loc->tipSupport;
-            newNode->branchSupport = loc->branchSupport;
-            newNode->children = std::move(loc->children);
-            assert(loc->children.empty());
-            for (std::unique_ptr<Node>& child : newNode->children)
-                child->parent = newNode.get();
+            // The old tip moves to the suffix, which takes over the children
+            removeTip(loc);
+            Index const suffix = allocate(*oldSuffix);
+            Node& oldNode = nodes_[loc];
+            Node& newNode = nodes_[suffix];
+            newNode.tipSupport = oldNode.tipSupport;
+            newNode.branchSupport = oldNode.branchSupport;
+            newNode.children = std::move(oldNode.children);
+            newNode.best = oldNode.best;
+            newNode.second = oldNode.second;
+            oldNode.children.clear();
+            for (Index child : newNode.children)
+                nodes_[child].parent = suffix;
+            addTip(suffix);
 
             assert(prefix);
-            loc->span = *prefix;
-            newNode->parent = loc;
-            loc->children.emplace_back(std::move(newNode));
-            loc->tipSupport = 0;
+            oldNode.span = *prefix;
+            addTip(loc);
+            newNode.parent = loc;
+            oldNode.children.push_back(suffix);
+            oldNode.best = suffix;
+            oldNode.second = none;
+            oldNode.tipSupport = 0;
         }
         if (newSuffix)
         {
-
-            auto newNode = std::make_unique<Node>(*newSuffix);
-            newNode->parent = loc;
-            incNode = newNode.get();
-            loc->children.push_back(std::move(newNode));
+            Index const suffix = allocate(*newSuffix);
+            addTip(suffix);
+            nodes_[suffix].parent = loc;
+            nodes_[loc].children.push_back(suffix);
+            consider(loc, suffix);
+            incNode = suffix;
         }
 
-        incNode->tipSupport += count;
-        while (incNode)
+        nodes_[incNode].tipSupport += count;
+        while (incNode != none)
         {
-            incNode->branchSupport += count;
-            incNode = incNode->parent;
+            nodes_[incNode].branchSupport += count;
+            reranked(incNode, true);
+            incNode = nodes_[incNode].parent;
         }
 
         seqSupport[ledger.seq()] += count;
+        cachedIssued_ = boost::none;
     }
 
     
     bool
     remove(Ledger const& ledger, std::uint32_t count = 1)
     {
-        Node* loc = findByLedgerID(ledger);
-        if (!loc || loc->tipSupport == 0)
+        Index loc = findByLedgerID(ledger);
+        if (loc == none || nodes_[loc].tipSupport == 0)
             return false;
 
-        count = std::min(count, loc->tipSupport);
-        loc->tipSupport -= count;
+        count = std::min(count, nodes_[loc].tipSupport);
+        nodes_[loc].tipSupport -= count;
 
         auto const it = seqSupport.find(ledger.seq());
         assert(it != seqSupport.end() && it->second >= count);
@@ -371,33 +565,46 @@ public:
         if (it->second == 0)
             seqSupport.erase(it->first);
 
-        Node* decNode = loc;
-        while (decNode)
+        for (Index decNode = loc; decNode != none;
+             decNode = nodes_[decNode].parent)
         {
-            decNode->branchSupport -= count;
-            decNode = decNode->parent;
+            nodes_[decNode].branchSupport -= count;
+            reranked(decNode, false);
         }
 
-        while (loc->tipSupport == 0 && loc != root.get())
+        while (nodes_[loc].tipSupport == 0 && loc != root)
         {
-            Node* parent = loc->parent;
-            if (loc->children.empty())
+            Index const parent = nodes_[loc].parent;
+            Node& node = nodes_[parent];
+            if (nodes_[loc].children.empty())
             {
-                parent->erase(loc);
+                node.erase(loc);
+                release(loc);
+                if (node.best == loc || node.second == loc)
+                    rank(parent);
             }
-            else if (loc->children.size() == 1)
+            else if (nodes_[loc].children.size() == 1)
             {
-                std::unique_ptr<Node> child =
-                    std::move(loc->children.front());
-                child->span = merge(loc->span, child->span);
-                child->parent = parent;
-                parent->children.emplace_back(std::move(child));
-                parent->erase(loc);
+                // The child takes the place of the node with the same
+                // support and starting ledger, so ranks where it did
+                Index const child = nodes_[loc].children.front();
+                nodes_[child].span =
+                    merge(nodes_[loc].span, nodes_[child].span);
+                nodes_[child].parent = parent;
+                node.children.push_back(child);
+                node.erase(loc);
+                if (node.best == loc)
+                    node.best = child;
+                else if (node.second == loc)
+                    node.second = child;
+                release(loc);
             }
             else
                 break;
             loc = parent;
         }
+
+        cachedIssued_ = boost::none;
         return true;
     }
 
@@ -405,8 +612,9 @@ public:
     std::uint32_t
     tipSupport(Ledger const& ledger) const
     {
-        if (auto const* loc = findByLedgerID(ledger))
-            return loc->tipSupport;
+        Index const loc = findByLedgerID(ledger);
+        if (loc != none)
+            return nodes_[loc].tipSupport;
         return 0;
     }
 
@@ -414,101 +622,37 @@ public:
     std::uint32_t
     branchSupport(Ledger const& ledger) const
     {
-        Node const* loc = findByLedgerID(ledger);
-        if (!loc)
+        Index loc = findByLedgerID(ledger);
+        if (loc == none)
         {
             Seq diffSeq;
             std::tie(loc, diffSeq) = find(ledger);
-            if (! (diffSeq > ledger.seq() && ledger.seq() < loc->span.end()))
-                loc = nullptr;
+            if (! (diffSeq > ledger.seq() &&
+                   ledger.seq() < nodes_[loc].span.end()))
+                loc = none;
         }
-        return loc ? loc->branchSupport : 0;
+        return loc != none ? nodes_[loc].branchSupport : 0;
     }
 
     
     boost::optional<SpanTip<Ledger>>
     getPreferred(Seq const largestIssued) const
     {
-        if (empty())
-            return boost::none;
-
-        Node* curr = root.get();
-
-        bool done = false;
-
-        std::uint32_t uncommitted = 0;
-        auto uncommittedIt = seqSupport.begin();
-
-        while (curr && !done)
+        if (!cachedIssued_ || *cachedIssued_ != largestIssued)
         {
-            {
-                Seq nextSeq = curr->span.start() + Seq{1};
-                while (uncommittedIt != seqSupport.end() &&
-                       uncommittedIt->first < std::max(nextSeq, largestIssued))
-                {
-                    uncommitted += uncommittedIt->second;
-                    uncommittedIt++;
-                }
-
-                while (nextSeq < curr->span.end() &&
-                       curr->branchSupport > uncommitted)
-                {
-                    if (uncommittedIt != seqSupport.end() &&
-                        uncommittedIt->first < curr->span.end())
-                    {
-                        nextSeq = uncommittedIt->first + Seq{1};
-                        uncommitted += uncommittedIt->second;
-                        uncommittedIt++;
-                    }
-                    else  
-                        nextSeq = curr->span.end();
-                }
-                if (nextSeq < curr->span.end())
-                    return curr->span.before(nextSeq)->tip();
-            }
-
-            Node* best = nullptr;
-            std::uint32_t margin = 0;
-            if (curr->children.size() == 1)
-            {
-                best = curr->children[0].get();
-                margin = best->branchSupport;
-            }
-            else if (!curr->children.empty())
-            {
-                std::partial_sort(
-                    curr->children.begin(),
-                    curr->children.begin() + 2,
-                    curr->children.end(),
-                    [](std::unique_ptr<Node> const& a,
-                       std::unique_ptr<Node> const& b) {
-                        return std::make_tuple(
-                                   a->branchSupport, a->span.startID()) >
-                            std::make_tuple(
-                                   b->branchSupport, b->span.startID());
-                    });
-
-                best = curr->children[0].get();
-                margin = curr->children[0]->branchSupport -
-                    curr->children[1]->branchSupport;
-
-                if (best->span.startID() > curr->children[1]->span.startID())
-                    margin++;
-            }
-
-            if (best && ((margin > uncommitted) || (uncommitted == 0)))
-                curr = best;
-            else  
-                done = true;
+            cachedPreferred_ = boost::none;
+            if (auto preferred = findPreferred(largestIssued))
+                cachedPreferred_.emplace(std::move(*preferred));
+            cachedIssued_ = largestIssued;
         }
-        return curr->span.tip();
+        return cachedPreferred_;
     }
 
     
     bool
     empty() const
     {
-        return !root || root->branchSupport == 0;
+        return nodes_[root].branchSupport == 0;
     }
 
     
@@ -523,7 +667,7 @@ public:
     getJson() const
     {
         Json::Value res;
-        res["trie"] = root->getJson();
+        res["trie"] = getJson(root);
         res["seq_support"] = Json::objectValue;
         for (auto const& mit : seqSupport)
             res["seq_support"][to_string(mit.first)] = mit.second;
@@ -535,47 +679,74 @@ public:
     checkInvariants() const
     {
         std::map<Seq, std::uint32_t> expectedSeqSupport;
+        std::size_t reached = 0;
 
-        std::stack<Node const*> nodes;
-        nodes.push(root.get());
+        std::stack<Index> nodes;
+        nodes.push(Index{root});
         while (!nodes.empty())
         {
-            Node const* curr = nodes.top();
+            Index const curr = nodes.top();
             nodes.pop();
-            if (!curr)
-                continue;
+            Node const& node = nodes_[curr];
+            ++reached;
+
+            if (curr != root && node.tipSupport == 0 &&
+                node.children.size() < 2)
+                return false;
 
-            if (curr != root.get() && curr->tipSupport == 0 &&
-                curr->children.size() < 2)
+            auto const tip = tips_.find(tipKey(node.span));
+            if (tip == tips_.end() || tip->second != curr)
+                return false;
+
+            Index best = none;
+            Index second = none;
+            for (Index child : node.children)
+            {
+                if (best == none || ranksAbove(child, best))
+                {
+                    second = best;
+                    best = child;
+                }
+                else if (second == none || ranksAbove(child, second))
+                    second = child;
+            }
+            if (best != node.best || second != node.second)
                 return false;
 
-            std::size_t support = curr->tipSupport;
-            if (curr->tipSupport != 0)
-                expectedSeqSupport[curr->span.end() - Seq{1}] +=
-                    curr->tipSupport;
+            std::size_t support = node.tipSupport;
+            if (node.tipSupport != 0)
+                expectedSeqSupport[node.span.end() - Seq{1}] +=
+                    node.tipSupport;
 
-            for (auto const& child : curr->children)
+            for (Index child : node.children)
             {
-                if (child->parent != curr)
+                if (nodes_[child].parent != curr)
                     return false;
 
-                support += child->branchSupport;
-                nodes.push(child.get());
+                support += nodes_[child].branchSupport;
+                nodes.push(child);
             }
-            if (support != curr->branchSupport)
+            if (support != node.branchSupport)
+                return false;
+        }
+
+        if (reached != nodes_.size() - free_.size() ||
+            reached != tips_.size())
+            return false;
+
+        if (cachedIssued_)
+        {
+            auto const preferred = findPreferred(*cachedIssued_);
+            if (bool(preferred) != bool(cachedPreferred_) ||
+                (preferred &&
+                 (preferred->seq != cachedPreferred_->seq ||
+                  preferred->id != cachedPreferred_->id)))
                 return false;
         }
+
         return expectedSeqSupport == seqSupport;
     }
 };
 
 }  
 #endif
-
-
-
-
-
-
-
-
@@ -8,9 +8,11 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/container/aged_container_utility.h>
 #include <ripple/beast/container/aged_unordered_map.h>
+#include <ripple/beast/hash/uhash.h>
 #include <ripple/consensus/LedgerTrie.h>
 #include <ripple/protocol/PublicKey.h>
 #include <boost/optional.hpp>
+#include <deque>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -121,20 +123,47 @@ class Validations
 
     using ScopedLock = std::lock_guard<Mutex>;
 
-    mutable Mutex mutex_;
+    static std::size_t constexpr shards = 16;
 
-    hash_map<NodeID, Validation> current_;
+    // A trusted validation not yet reflected in the trie
+    struct Pending
+    {
+        std::pair<Seq, ID> val;
+        boost::optional<std::pair<Seq, ID>> prior;
+    };
+
+    // The validations of a set of nodes. A validation is added under the
+    // lock of its node's shard alone; the trie catches up when it is next
+    // read. The number of trusted, full validations of each ledger is kept
+    // up to date as validations arrive, change trust or expire.
+    struct Shard
+    {
+        Mutex mutex;
+        hash_map<NodeID, Validation> current;
+        hash_map<NodeID, SeqEnforcer<Seq>> enforcers;
+        hash_map<NodeID, Pending> pending;
+        beast::aged_unordered_map<
+            ID,
+            hash_map<NodeID, Validation>,
+            std::chrono::steady_clock,
+            beast::uhash<>>
+            byLedger;
+        hash_map<ID, std::size_t> trusted;
+
+        explicit Shard(beast::abstract_clock<std::chrono::steady_clock>& c)
+            : byLedger(c)
+        {
+        }
+    };
 
-    SeqEnforcer<Seq> localSeqEnforcer_;
+    beast::abstract_clock<std::chrono::steady_clock>& clock_;
 
-    hash_map<NodeID, SeqEnforcer<Seq>> seqEnforcers_;
+    mutable std::deque<Shard> shards_;
 
-    beast::aged_unordered_map<
-        ID,
-        hash_map<NodeID, Validation>,
-        std::chrono::steady_clock,
-        beast::uhash<>>
-        byLedger_;
+    // Guards the trie and what is derived from it
+    mutable Mutex mutex_;
+
+    SeqEnforcer<Seq> localSeqEnforcer_;
 
     LedgerTrie<Ledger> trie_;
 
@@ -147,6 +176,34 @@ class Validations
     Adaptor adaptor_;
 
 private:
+    Shard&
+    shardOf(NodeID const& nodeID)
+    {
+        return shards_[beast::uhash<>{}(nodeID) % shards];
+    }
+
+    static void
+    count(
+        ScopedLock const&,
+        Shard& shard,
+        ID const& ledgerID,
+        Validation const& val,
+        bool insert)
+    {
+        if (!val.trusted() || !val.full())
+            return;
+
+        if (insert)
+        {
+            ++shard.trusted[ledgerID];
+            return;
+        }
+
+        auto it = shard.trusted.find(ledgerID);
+        if (it != shard.trusted.end() && --it->second == 0)
+            shard.trusted.erase(it);
+    }
+
     void
     removeTrie(ScopedLock const&, NodeID const& nodeID, Validation const& val)
     {
@@ -205,11 +262,9 @@ private:
     updateTrie(
         ScopedLock const& lock,
         NodeID const& nodeID,
-        Validation const& val,
+        std::pair<Seq, ID> const& valPair,
         boost::optional<std::pair<Seq, ID>> prior)
     {
-        assert(val.trusted());
-
         if (prior)
         {
             auto it = acquiring_.find(*prior);
@@ -223,7 +278,6 @@ private:
 
         checkAcquired(lock);
 
-        std::pair<Seq, ID> valPair{val.seq(), val.ledgerID()};
         auto it = acquiring_.find(valPair);
         if (it != acquiring_.end())
         {
@@ -232,13 +286,33 @@ private:
         else
         {
             if (boost::optional<Ledger> ledger =
-                    adaptor_.acquire(val.ledgerID()))
+                    adaptor_.acquire(valPair.second))
                 updateTrie(lock, nodeID, *ledger);
             else
                 acquiring_[valPair].insert(nodeID);
         }
     }
 
+    // Bring the trie up to date with the validations of a shard, whose
+    // lock the caller holds
+    void
+    drain(ScopedLock const& lock, Shard& shard)
+    {
+        for (auto const& p : shard.pending)
+            updateTrie(lock, p.first, p.second.val, p.second.prior);
+        shard.pending.clear();
+    }
+
+    void
+    drain(ScopedLock const& lock)
+    {
+        for (auto& shard : shards_)
+        {
+            ScopedLock shardLock{shard.mutex};
+            drain(lock, shard);
+        }
+    }
+
     
     template <class F>
     auto
@@ -256,22 +330,40 @@ private:
     current(ScopedLock const& lock, Pre&& pre, F&& f)
     {
         NetClock::time_point t = adaptor_.now();
-        pre(current_.size());
-        auto it = current_.begin();
-        while (it != current_.end())
+
+        std::size_t size = 0;
+        for (auto& shard : shards_)
         {
-            if (!isCurrent(
-                    parms_, t, it->second.signTime(), it->second.seenTime()))
-            {
-                removeTrie(lock, it->first, it->second);
-                adaptor_.onStale(std::move(it->second));
-                it = current_.erase(it);
-            }
-            else
+            ScopedLock shardLock{shard.mutex};
+            size += shard.current.size();
+        }
+        pre(size);
+
+        for (auto& shard : shards_)
+        {
+            ScopedLock shardLock{shard.mutex};
+            drain(lock, shard);
+
+            auto it = shard.current.begin();
+            while (it != shard.current.end())
             {
-                auto cit = typename decltype(current_)::const_iterator{it};
-                f(cit->first, cit->second);
-                ++it;
+                if (!isCurrent(
+                        parms_,
+                        t,
+                        it->second.signTime(),
+                        it->second.seenTime()))
+                {
+                    removeTrie(lock, it->first, it->second);
+                    adaptor_.onStale(std::move(it->second));
+                    it = shard.current.erase(it);
+                }
+                else
+                {
+                    auto cit =
+                        typename decltype(shard.current)::const_iterator{it};
+                    f(cit->first, cit->second);
+                    ++it;
+                }
             }
         }
     }
@@ -279,15 +371,28 @@ private:
     
     template <class Pre, class F>
     void
-    byLedger(ScopedLock const&, ID const& ledgerID, Pre&& pre, F&& f)
+    byLedger(ID const& ledgerID, Pre&& pre, F&& f)
     {
-        auto it = byLedger_.find(ledgerID);
-        if (it != byLedger_.end())
+        std::size_t size = 0;
+        for (auto& shard : shards_)
         {
-            byLedger_.touch(it);
-            pre(it->second.size());
-            for (auto const& keyVal : it->second)
-                f(keyVal.first, keyVal.second);
+            ScopedLock lock{shard.mutex};
+            auto it = shard.byLedger.find(ledgerID);
+            if (it != shard.byLedger.end())
+                size += it->second.size();
+        }
+        pre(size);
+
+        for (auto& shard : shards_)
+        {
+            ScopedLock lock{shard.mutex};
+            auto it = shard.byLedger.find(ledgerID);
+            if (it != shard.byLedger.end())
+            {
+                shard.byLedger.touch(it);
+                for (auto const& keyVal : it->second)
+                    f(keyVal.first, keyVal.second);
+            }
         }
     }
 
@@ -298,8 +403,10 @@ public:
         ValidationParms const& p,
         beast::abstract_clock<std::chrono::steady_clock>& c,
         Ts&&... ts)
-        : byLedger_(c), parms_(p), adaptor_(std::forward<Ts>(ts)...)
+        : clock_(c), parms_(p), adaptor_(std::forward<Ts>(ts)...)
     {
+        for (std::size_t i = 0; i < shards; ++i)
+            shards_.emplace_back(c);
     }
 
     
@@ -321,7 +428,7 @@ public:
     canValidateSeq(Seq const s)
     {
         ScopedLock lock{mutex_};
-        return localSeqEnforcer_(byLedger_.clock().now(), s, parms_);
+        return localSeqEnforcer_(clock_.now(), s, parms_);
     }
 
     
@@ -331,37 +438,43 @@ public:
         if (!isCurrent(parms_, adaptor_.now(), val.signTime(), val.seenTime()))
             return ValStatus::stale;
 
+        auto& shard = shardOf(nodeID);
+        ScopedLock lock{shard.mutex};
+
+        SeqEnforcer<Seq>& enforcer = shard.enforcers[nodeID];
+        if (!enforcer(clock_.now(), val.seq(), parms_))
+            return ValStatus::badSeq;
+
+        auto byLedgerIt = shard.byLedger[val.ledgerID()].emplace(nodeID, val);
+        if (!byLedgerIt.second)
         {
-            ScopedLock lock{mutex_};
+            count(lock, shard, val.ledgerID(), byLedgerIt.first->second, false);
+            byLedgerIt.first->second = val;
+        }
+        count(lock, shard, val.ledgerID(), val, true);
 
-            auto const now = byLedger_.clock().now();
-            SeqEnforcer<Seq>& enforcer = seqEnforcers_[nodeID];
-            if (!enforcer(now, val.seq(), parms_))
-                return ValStatus::badSeq;
+        boost::optional<std::pair<Seq, ID>> prior;
+        auto const ins = shard.current.emplace(nodeID, val);
+        if (!ins.second)
+        {
+            Validation& oldVal = ins.first->second;
+            if (val.signTime() <= oldVal.signTime())
+                return ValStatus::stale;
 
-            auto byLedgerIt = byLedger_[val.ledgerID()].emplace(nodeID, val);
-            if (!byLedgerIt.second)
-                byLedgerIt.first->second = val;
+            prior.emplace(oldVal.seq(), oldVal.ledgerID());
+            adaptor_.onStale(std::move(oldVal));
+            ins.first->second = val;
+        }
 
-            auto const ins = current_.emplace(nodeID, val);
-            if (!ins.second)
-            {
-                Validation& oldVal = ins.first->second;
-                if (val.signTime() > oldVal.signTime())
-                {
-                    std::pair<Seq, ID> old(oldVal.seq(), oldVal.ledgerID());
-                    adaptor_.onStale(std::move(oldVal));
-                    ins.first->second = val;
-                    if (val.trusted())
-                        updateTrie(lock, nodeID, val, old);
-                }
-                else
-                    return ValStatus::stale;
-            }
-            else if (val.trusted())
-            {
-                updateTrie(lock, nodeID, val, boost::none);
-            }
+        if (val.trusted())
+        {
+            // A replacement not yet in the trie keeps the prior of the
+            // validation it replaces
+            std::pair<Seq, ID> valPair{val.seq(), val.ledgerID()};
+            auto const pending =
+                shard.pending.emplace(nodeID, Pending{valPair, prior});
+            if (!pending.second)
+                pending.first->second.val = valPair;
         }
         return ValStatus::current;
     }
@@ -370,8 +483,19 @@ public:
     void
     expire()
     {
-        ScopedLock lock{mutex_};
-        beast::expire(byLedger_, parms_.validationSET_EXPIRES);
+        for (auto& shard : shards_)
+        {
+            ScopedLock lock{shard.mutex};
+            beast::expire(shard.byLedger, parms_.validationSET_EXPIRES);
+
+            for (auto it = shard.trusted.begin(); it != shard.trusted.end();)
+            {
+                if (shard.byLedger.find(it->first) == shard.byLedger.end())
+                    it = shard.trusted.erase(it);
+                else
+                    ++it;
+            }
+        }
     }
 
     
@@ -380,31 +504,48 @@ public:
     {
         ScopedLock lock{mutex_};
 
-        for (auto& it : current_)
+        for (auto& shard : shards_)
         {
-            if (added.find(it.first) != added.end())
-            {
-                it.second.setTrusted();
-                updateTrie(lock, it.first, it.second, boost::none);
-            }
-            else if (removed.find(it.first) != removed.end())
-            {
-                it.second.setUntrusted();
-                removeTrie(lock, it.first, it.second);
-            }
-        }
+            ScopedLock shardLock{shard.mutex};
+            drain(lock, shard);
 
-        for (auto& it : byLedger_)
-        {
-            for (auto& nodeVal : it.second)
+            for (auto& it : shard.current)
             {
-                if (added.find(nodeVal.first) != added.end())
+                if (added.find(it.first) != added.end())
+                {
+                    it.second.setTrusted();
+                    updateTrie(
+                        lock,
+                        it.first,
+                        {it.second.seq(), it.second.ledgerID()},
+                        boost::none);
+                }
+                else if (removed.find(it.first) != removed.end())
                 {
-                    nodeVal.second.setTrusted();
+                    it.second.setUntrusted();
+                    removeTrie(lock, it.first, it.second);
                 }
-                else if (removed.find(nodeVal.first) != removed.end())
+            }
+
+            for (auto& it : shard.byLedger)
+            {
+                for (auto& nodeVal : it.second)
                 {
-                    nodeVal.second.setUntrusted();
+                    if (added.find(nodeVal.first) != added.end())
+                    {
+                        if (!nodeVal.second.trusted())
+                        {
+                            nodeVal.second.setTrusted();
+                            count(shardLock, shard, it.first,
+                                nodeVal.second, true);
+                        }
+                    }
+                    else if (removed.find(nodeVal.first) != removed.end())
+                    {
+                        count(shardLock, shard, it.first,
+                            nodeVal.second, false);
+                        nodeVal.second.setUntrusted();
+                    }
                 }
             }
         }
@@ -497,6 +638,7 @@ public:
     getNodesAfter(Ledger const& ledger, ID const& ledgerID)
     {
         ScopedLock lock{mutex_};
+        drain(lock);
 
         if (ledger.id() == ledgerID)
             return withTrie(lock, [&ledger](LedgerTrie<Ledger>& trie) {
@@ -545,18 +687,16 @@ public:
 
     
     std::size_t
-    numTrustedForLedger(ID const& ledgerID)
+    numTrustedForLedger(ID const& ledgerID) const
     {
         std::size_t count = 0;
-        ScopedLock lock{mutex_};
-        byLedger(
-            lock,
-            ledgerID,
-            [&](std::size_t) {},  
-            [&](NodeID const&, Validation const& v) {
-                if (v.trusted() && v.full())
-                    ++count;
-            });
+        for (auto& shard : shards_)
+        {
+            ScopedLock lock{shard.mutex};
+            auto const it = shard.trusted.find(ledgerID);
+            if (it != shard.trusted.end())
+                count += it->second;
+        }
         return count;
     }
 
@@ -565,9 +705,7 @@ public:
     getTrustedForLedger(ID const& ledgerID)
     {
         std::vector<WrappedValidationType> res;
-        ScopedLock lock{mutex_};
         byLedger(
-            lock,
             ledgerID,
             [&](std::size_t numValidations) { res.reserve(numValidations); },
             [&](NodeID const&, Validation const& v) {
@@ -583,9 +721,7 @@ public:
     fees(ID const& ledgerID, std::uint32_t baseFee)
     {
         std::vector<std::uint32_t> res;
-        ScopedLock lock{mutex_};
         byLedger(
-            lock,
             ledgerID,
             [&](std::size_t numValidations) { res.reserve(numValidations); },
             [&](NodeID const&, Validation const& v) {
@@ -608,11 +744,16 @@ public:
         hash_map<NodeID, Validation> flushed;
         {
             ScopedLock lock{mutex_};
-            for (auto it : current_)
+            for (auto& shard : shards_)
             {
-                flushed.emplace(it.first, std::move(it.second));
+                ScopedLock shardLock{shard.mutex};
+                drain(lock, shard);
+                for (auto it : shard.current)
+                {
+                    flushed.emplace(it.first, std::move(it.second));
+                }
+                shard.current.clear();
             }
-            current_.clear();
         }
 
         adaptor_.flush(std::move(flushed));
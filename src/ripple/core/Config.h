@@ -12,6 +12,7 @@
 #include <boost/filesystem.hpp> 
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
+#include <chrono>
 #include <cstdint>
 #include <map>
 #include <string>
@@ -113,6 +114,8 @@ public:
     int                         PATH_SEARCH = 7;
     int                         PATH_SEARCH_FAST = 2;
     int                         PATH_SEARCH_MAX = 10;
+    std::size_t                 PATH_SEARCH_THREADS = 4;
+    std::chrono::milliseconds   PATH_SEARCH_TIME {0};
 
     boost::optional<std::size_t> VALIDATION_QUORUM;     
 
@@ -123,7 +126,10 @@ public:
 
     std::uint32_t                      LEDGER_HISTORY = 256;
     std::uint32_t                      FETCH_DEPTH = 1000000000;
+    std::size_t                        LEDGER_APPLY_THREADS = 0;
+    bool                               LEDGER_PIPELINE = false;
     int                         NODE_SIZE = 0;
+    std::size_t                 IO_SHARDS = 0;
 
     bool                        SSL_VERIFY = true;
     std::string                 SSL_VERIFY_FILE;
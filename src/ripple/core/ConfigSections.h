@@ -26,7 +26,10 @@ struct ConfigSection
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
+#define SECTION_LEDGER_APPLY_THREADS    "ledger_apply_threads"
+#define SECTION_LEDGER_PIPELINE         "ledger_pipeline"
 #define SECTION_INSIGHT                 "insight"
+#define SECTION_IO_SHARDS               "io_shards"
 #define SECTION_IPS                     "ips"
 #define SECTION_IPS_FIXED               "ips_fixed"
 #define SECTION_NETWORK_QUORUM          "network_quorum"
@@ -36,6 +39,8 @@ struct ConfigSection
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
 #define SECTION_PATH_SEARCH_MAX         "path_search_max"
+#define SECTION_PATH_SEARCH_THREADS     "path_search_threads"
+#define SECTION_PATH_SEARCH_TIME        "path_search_time"
 #define SECTION_PEER_PRIVATE            "peer_private"
 #define SECTION_PEERS_MAX               "peers_max"
 #define SECTION_RPC_STARTUP             "rpc_startup"
@@ -128,6 +128,9 @@ public:
 
     Json::Value getJson (int c = 0);
 
+    /** Percentiles of the time each type of job waited and ran. */
+    Json::Value getLatencyJson ();
+
     
     void
     rendezvous();
@@ -3,6 +3,7 @@
 #ifndef RIPPLE_CORE_JOBTYPEDATA_H_INCLUDED
 #define RIPPLE_CORE_JOBTYPEDATA_H_INCLUDED
 
+#include <ripple/basics/LatencyHistogram.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/beast/insight/Collector.h>
@@ -35,6 +36,10 @@ public:
     beast::insight::Event dequeue;
     beast::insight::Event execute;
 
+    // Time jobs of this type waited in the queue and then ran
+    LatencyHistogram waitTimes;
+    LatencyHistogram runTimes;
+
     JobTypeData (JobTypeInfo const& info_,
             beast::insight::Collector::ptr const& collector, Logs& logs) noexcept
         : m_load (logs.journal ("LoadMonitor"))
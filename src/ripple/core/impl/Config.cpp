@@ -347,6 +347,15 @@ void Config::loadFromString (std::string const& fileContents)
             FETCH_DEPTH = 10;
     }
 
+    if (getSingleSection (secConfig, SECTION_LEDGER_APPLY_THREADS, strTemp, j_))
+        LEDGER_APPLY_THREADS = beast::lexicalCastThrow <std::size_t> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_PIPELINE, strTemp, j_))
+        LEDGER_PIPELINE = beast::lexicalCastThrow <bool> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_IO_SHARDS, strTemp, j_))
+        IO_SHARDS = beast::lexicalCastThrow <std::size_t> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH_OLD, strTemp, j_))
         PATH_SEARCH_OLD     = beast::lexicalCastThrow <int> (strTemp);
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH, strTemp, j_))
@@ -355,6 +364,11 @@ void Config::loadFromString (std::string const& fileContents)
         PATH_SEARCH_FAST    = beast::lexicalCastThrow <int> (strTemp);
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH_MAX, strTemp, j_))
         PATH_SEARCH_MAX     = beast::lexicalCastThrow <int> (strTemp);
+    if (getSingleSection (secConfig, SECTION_PATH_SEARCH_THREADS, strTemp, j_))
+        PATH_SEARCH_THREADS = beast::lexicalCastThrow <std::size_t> (strTemp);
+    if (getSingleSection (secConfig, SECTION_PATH_SEARCH_TIME, strTemp, j_))
+        PATH_SEARCH_TIME    = std::chrono::milliseconds (
+            beast::lexicalCastThrow <std::uint32_t> (strTemp));
 
     if (getSingleSection (secConfig, SECTION_DEBUG_LOGFILE, strTemp, j_))
         DEBUG_LOGFILE       = strTemp;
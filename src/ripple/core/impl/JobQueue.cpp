@@ -240,6 +240,29 @@ JobQueue::getJson (int c)
     return ret;
 }
 
+Json::Value
+JobQueue::getLatencyJson ()
+{
+    // The job types are all added on construction, so they can be read
+    // without the lock
+    Json::Value ret (Json::objectValue);
+    for (auto& x : m_jobData)
+    {
+        if (x.first == jtGENERIC)
+            continue;
+
+        JobTypeData& data (x.second);
+        auto const wait = data.waitTimes.snapshot ();
+        if (wait.count () == 0)
+            continue;
+
+        Json::Value& jv = ret[data.name ()] = Json::objectValue;
+        jv["wait"] = wait.getJson ();
+        jv["run"] = data.runTimes.snapshot ().getJson ();
+    }
+    return ret;
+}
+
 void
 JobQueue::rendezvous()
 {
@@ -375,6 +398,7 @@ JobQueue::processTask (int instance)
             auto const us = date::ceil<microseconds>(
                 start_time - job.queue_time());
             perfLog_.jobStart(type, us, start_time, instance);
+            data.waitTimes.insert(us);
             if (us >= 10ms)
                 getJobTypeData(type).dequeue.notify(us);
             job.doJob ();
@@ -382,6 +406,7 @@ JobQueue::processTask (int instance)
         auto const us (
             date::ceil<microseconds>(Job::clock_type::now() - start_time));
         perfLog_.jobFinish(type, us, instance);
+        getJobTypeData(type).runTimes.insert(us);
         if (us >= 10ms)
             getJobTypeData(type).execute.notify(us);
     }
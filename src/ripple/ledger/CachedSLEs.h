@@ -6,12 +6,21 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/protocol/STLedgerEntry.h>
 #include <ripple/beast/container/aged_unordered_map.h>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
 
+/** Deserialized ledger entries shared by every ledger.
+
+    Entries are found by the digest of their state map leaf, so an entry
+    that did not change is shared by every ledger holding it. The cache is
+    split into partitions, each with its own lock.
+*/
 class CachedSLEs
 {
 public:
@@ -28,58 +37,98 @@ public:
         Rep, Period> const& timeToLive,
             Stopwatch& clock)
         : timeToLive_ (timeToLive)
-        , map_ (clock)
     {
+        partitions_.reserve (partitionCount);
+        for (std::size_t i = 0; i < partitionCount; ++i)
+            partitions_.emplace_back (
+                std::make_unique<Partition> (clock));
     }
 
-    
+    /** Discard entries unused for longer than the time to live. */
     void
     expire();
 
-    
+    /** Return the entry with the digest, calling h() to read it if needed. */
     template <class Handler>
     value_type
     fetch (digest_type const& digest,
         Handler const& h)
     {
+        auto& p = partition (digest);
         {
             std::lock_guard<
-                std::mutex> lock(mutex_);
+                std::mutex> lock(p.mutex);
             auto iter =
-                map_.find(digest);
-            if (iter != map_.end())
+                p.map.find(digest);
+            if (iter != p.map.end())
             {
                 ++hit_;
-                map_.touch(iter);
+                p.map.touch(iter);
                 return iter->second;
             }
         }
         auto sle = h();
         if (! sle)
             return nullptr;
-        std::lock_guard<
-            std::mutex> lock(mutex_);
         ++miss_;
+        std::lock_guard<
+            std::mutex> lock(p.mutex);
         auto const result =
-            map_.emplace(
+            p.map.emplace(
                 digest, std::move(sle));
         if (! result.second)
-            map_.touch(result.first);
+            p.map.touch(result.first);
         return  result.first->second;
     }
 
-    
+    /** The fraction of fetches found in the cache. */
     double
     rate() const;
 
+    std::uint64_t
+    hits() const
+    {
+        return hit_;
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return miss_;
+    }
+
+    /** The number of entries held. */
+    std::size_t
+    size() const;
+
 private:
-    std::size_t hit_ = 0;
-    std::size_t miss_ = 0;
-    std::mutex mutable mutex_;
+    static std::size_t constexpr partitionCount = 16;
+
+    struct Partition
+    {
+        explicit
+        Partition (Stopwatch& clock)
+            : map (clock)
+        {
+        }
+
+        std::mutex mutex;
+        beast::aged_unordered_map <digest_type,
+            value_type, Stopwatch::clock_type,
+                hardened_hash<strong_hash>> map;
+    };
+
+    Partition&
+    partition (digest_type const& digest)
+    {
+        // The digest is a hash, so any of its bytes will do
+        return *partitions_[*digest.begin() % partitionCount];
+    }
+
+    std::atomic<std::uint64_t> hit_ {0};
+    std::atomic<std::uint64_t> miss_ {0};
     Stopwatch::duration timeToLive_;
-    beast::aged_unordered_map <digest_type,
-        value_type, Stopwatch::clock_type,
-            hardened_hash<strong_hash>> map_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
 };
 
 } 
@@ -93,3 +142,4 @@ private:
 
 
 
+
@@ -30,12 +30,18 @@ class OpenView final
 private:
     class txs_iter_impl;
 
-    using txs_map = std::map<key_type,
-        std::pair<std::shared_ptr<Serializer const>,
-        std::shared_ptr<Serializer const>>,
+    struct txData
+    {
+        std::shared_ptr<Serializer const> txn;
+        std::shared_ptr<Serializer const> meta;
+
+        // Set when the writer already had the parsed form
+        tx_type parsed;
+    };
+
+    using txs_map = std::map<key_type, txData,
         std::less<key_type>, qalloc_type<std::pair<key_type const,
-        std::pair<std::shared_ptr<Serializer const>,
-        std::shared_ptr<Serializer const>>>, false>>;
+        txData>, false>>;
 
     Rules rules_;
     txs_map txs_;
@@ -152,6 +158,14 @@ public:
             const& txn, std::shared_ptr<
                 Serializer const>
                     const& metaData) override;
+
+    void
+    rawTxInsert (key_type const& key,
+        std::shared_ptr<Serializer const>
+            const& txn, std::shared_ptr<
+                Serializer const>
+                    const& metaData,
+                        tx_type const& parsed) override;
 };
 
 } 
@@ -55,6 +55,23 @@ public:
         std::shared_ptr<Serializer const>
             const& txn, std::shared_ptr<
                 Serializer const> const& metaData) = 0;
+
+    /** Add a transaction whose parsed form is already known.
+
+        A view may hand the parsed form to its readers instead of
+        parsing the serialized transaction again. By default it is
+        discarded.
+    */
+    virtual
+    void
+    rawTxInsert (ReadView::key_type const& key,
+        std::shared_ptr<Serializer const>
+            const& txn, std::shared_ptr<
+                Serializer const> const& metaData,
+                    ReadView::tx_type const& parsed)
+    {
+        rawTxInsert (key, txn, metaData);
+    }
 };
 
 } 
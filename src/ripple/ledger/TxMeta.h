@@ -91,6 +91,11 @@ public:
     void addRaw (Serializer&, TER, std::uint32_t index);
 
     STObject getAsObject () const;
+
+    /** Like getAsObject, but the affected nodes are moved into the
+        returned object instead of copied.
+    */
+    STObject takeAsObject ();
     STArray& getNodes ()
     {
         return (mNodes);
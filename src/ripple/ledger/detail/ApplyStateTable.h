@@ -10,7 +10,11 @@
 #include <ripple/protocol/TER.h>
 #include <ripple/protocol/XRPAmount.h>
 #include <ripple/beast/utility/Journal.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <type_traits>
 
 namespace ripple {
 namespace detail {
@@ -29,15 +33,111 @@ private:
         modify,
     };
 
-    using items_t = std::map<key_type,
-        std::pair<Action, std::shared_ptr<SLE>>>;
+    struct item_t
+        : std::pair<Action, std::shared_ptr<SLE>>
+    {
+        using pair::pair;
+
+        // The entry as it is in the base, once it has been read. It is
+        // shared by the invariant checks and the metadata.
+        std::shared_ptr<SLE const> mutable orig;
+    };
+
+    // A transaction touches few entries. The nodes of the first of them
+    // come from storage inside the table, so a small table does not
+    // allocate, while a large one is still a tree.
+    class Arena
+    {
+    public:
+        static std::size_t constexpr slots = 16;
+        static std::size_t constexpr slotSize = 128;
+
+        Arena() = default;
+        Arena (Arena const&) = delete;
+        Arena& operator= (Arena const&) = delete;
+
+        void*
+        allocate (std::size_t bytes, std::size_t align);
+
+        void
+        deallocate (void* p) noexcept;
+
+    private:
+        std::aligned_storage_t<slotSize,
+            alignof(std::max_align_t)> slots_[slots];
+        std::uint32_t used_ = 0;
+    };
 
-    items_t items_;
+    template <class T>
+    class ArenaAllocator
+    {
+    private:
+        template <class>
+        friend class ArenaAllocator;
+
+        Arena* arena_;
+
+    public:
+        using value_type = T;
+
+        explicit
+        ArenaAllocator (Arena& arena) noexcept
+            : arena_ (&arena)
+        {
+        }
+
+        template <class U>
+        ArenaAllocator (ArenaAllocator<U> const& u) noexcept
+            : arena_ (u.arena_)
+        {
+        }
+
+        T*
+        allocate (std::size_t n)
+        {
+            return static_cast<T*>(arena_->allocate(
+                n * sizeof(T), alignof(T)));
+        }
+
+        void
+        deallocate (T* p, std::size_t) noexcept
+        {
+            arena_->deallocate(p);
+        }
+
+        template <class U>
+        bool
+        operator== (ArenaAllocator<U> const& u) const noexcept
+        {
+            return arena_ == u.arena_;
+        }
+
+        template <class U>
+        bool
+        operator!= (ArenaAllocator<U> const& u) const noexcept
+        {
+            return arena_ != u.arena_;
+        }
+    };
+
+    using items_t = std::map<key_type, item_t, std::less<key_type>,
+        ArenaAllocator<std::pair<key_type const, item_t>>>;
+
+    Arena arena_;
+    items_t items_ {std::less<key_type>{},
+        items_t::allocator_type{arena_}};
     XRPAmount dropsDestroyed_ = 0;
 
 public:
     ApplyStateTable() = default;
-    ApplyStateTable (ApplyStateTable&&) = default;
+
+    // The entries are moved into the nodes of this table's arena
+    ApplyStateTable (ApplyStateTable&& other)
+        : items_ (std::move(other.items_),
+            items_t::allocator_type{arena_})
+        , dropsDestroyed_ (other.dropsDestroyed_)
+    {
+    }
 
     ApplyStateTable (ApplyStateTable const&) = delete;
     ApplyStateTable& operator= (ApplyStateTable&&) = delete;
@@ -112,6 +212,11 @@ private:
     using Mods = hash_map<key_type,
         std::shared_ptr<SLE>>;
 
+    static
+    std::shared_ptr<SLE const> const&
+    original (ReadView const& base,
+        items_t::value_type const& item);
+
     static
     void
     threadItem (TxMeta& meta,
@@ -5,10 +5,46 @@
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/st.h>
 #include <cassert>
+#include <functional>
+#include <iterator>
+#include <new>
 
 namespace ripple {
 namespace detail {
 
+void*
+ApplyStateTable::Arena::allocate (
+    std::size_t bytes, std::size_t align)
+{
+    if (bytes <= slotSize && align <= alignof(std::max_align_t))
+    {
+        for (std::size_t i = 0; i < slots; ++i)
+        {
+            auto const bit = std::uint32_t{1} << i;
+            if (! (used_ & bit))
+            {
+                used_ |= bit;
+                return &slots_[i];
+            }
+        }
+    }
+    return ::operator new (bytes);
+}
+
+void
+ApplyStateTable::Arena::deallocate (void* p) noexcept
+{
+    std::less<void const*> const less;
+    if (less (p, std::begin (slots_)) || ! less (p, std::end (slots_)))
+    {
+        ::operator delete (p);
+        return;
+    }
+    auto const i = static_cast<decltype(std::begin (slots_))>(p) -
+        std::begin (slots_);
+    used_ &= ~(std::uint32_t{1} << i);
+}
+
 void
 ApplyStateTable::apply (RawView& to) const
 {
@@ -67,7 +103,7 @@ ApplyStateTable::visit (ReadView const& to,
         {
         case Action::erase:
             func (item.first, true,
-                to.read (keylet::unchecked (item.first)), item.second.second);
+                original (to, item), item.second.second);
             break;
 
         case Action::insert:
@@ -77,7 +113,7 @@ ApplyStateTable::visit (ReadView const& to,
 
         case Action::modify:
             func (item.first, false,
-                to.read (keylet::unchecked (item.first)), item.second.second);
+                original (to, item), item.second.second);
             break;
 
         default:
@@ -96,6 +132,7 @@ ApplyStateTable::apply (OpenView& to,
         std::make_shared<Serializer>();
     tx.add(*sTx);
     std::shared_ptr<Serializer> sMeta;
+    ReadView::tx_type parsed;
     if (!to.open())
     {
         TxMeta meta;
@@ -121,8 +158,9 @@ ApplyStateTable::apply (OpenView& to,
                 type = &sfModifiedNode;
                 break;
             }
-            auto const origNode =
-                to.read(keylet::unchecked(item.first));
+            auto const origNode = type == &sfCreatedNode
+                ? to.read(keylet::unchecked(item.first))
+                : original(to, item);
             auto curNode = item.second.second;
             if ((type == &sfModifiedNode) && (*curNode == *origNode))
                 continue;
@@ -217,12 +255,17 @@ ApplyStateTable::apply (OpenView& to,
         sMeta = std::make_shared<Serializer>();
         meta.addRaw (*sMeta, ter, to.txCount());
 
+        // Readers of the ledger being built use these as they are
+        parsed.first = std::make_shared<STTx const>(tx);
+        parsed.second = std::make_shared<STObject const>(
+            meta.takeAsObject());
+
         JLOG(j.trace()) <<
-            "metadata " << meta.getJson (JsonOptions::none);
+            "metadata " << parsed.second->getJson (JsonOptions::none);
     }
     to.rawTxInsert(
         tx.getTransactionID(),
-            sTx, sMeta);
+            sTx, sMeta, parsed);
     apply(to);
 }
 
@@ -322,6 +365,7 @@ ApplyStateTable::peek (ReadView const& base,
                 forward_as_tuple(sle->key()),
                     forward_as_tuple(Action::cache,
                         make_shared<SLE>(*sle)));
+        iter->second.orig = sle;
         return iter->second.second;
     }
     auto const& item = iter->second;
@@ -489,6 +533,15 @@ ApplyStateTable::destroyXRP(XRPAmount const& fee)
 }
 
 
+std::shared_ptr<SLE const> const&
+ApplyStateTable::original (ReadView const& base,
+    items_t::value_type const& item)
+{
+    if (! item.second.orig)
+        item.second.orig = base.read (keylet::unchecked (item.first));
+    return item.second.orig;
+}
+
 void
 ApplyStateTable::threadItem (TxMeta& meta,
     std::shared_ptr<SLE> const& sle)
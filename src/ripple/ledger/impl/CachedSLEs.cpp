@@ -8,23 +8,29 @@ namespace ripple {
 void
 CachedSLEs::expire()
 {
-    std::vector<
-        std::shared_ptr<void const>> trash;
+    for (auto& p : partitions_)
     {
-        auto const expireTime =
-            map_.clock().now() - timeToLive_;
-        std::lock_guard<
-            std::mutex> lock(mutex_);
-        for (auto iter = map_.chronological.begin();
-            iter != map_.chronological.end(); ++iter)
+        std::vector<
+            std::shared_ptr<void const>> trash;
         {
-            if (iter.when() > expireTime)
-                break;
-            if (iter->second.unique())
+            auto const expireTime =
+                p->map.clock().now() - timeToLive_;
+            std::lock_guard<
+                std::mutex> lock(p->mutex);
+            auto iter = p->map.chronological.begin();
+            while (iter != p->map.chronological.end() &&
+                iter.when() <= expireTime)
             {
-                trash.emplace_back(
-                    std::move(iter->second));
-                iter = map_.erase(iter);
+                if (iter->second.unique())
+                {
+                    trash.emplace_back(
+                        std::move(iter->second));
+                    iter = p->map.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
             }
         }
     }
@@ -33,12 +39,24 @@ CachedSLEs::expire()
 double
 CachedSLEs::rate() const
 {
-    std::lock_guard<
-        std::mutex> lock(mutex_);
-    auto const tot = hit_ + miss_;
+    auto const hit = hit_.load();
+    auto const tot = hit + miss_.load();
     if (tot == 0)
         return 0;
-    return double(hit_) / tot;
+    return double(hit) / tot;
+}
+
+std::size_t
+CachedSLEs::size() const
+{
+    std::size_t n = 0;
+    for (auto const& p : partitions_)
+    {
+        std::lock_guard<
+            std::mutex> lock(p->mutex);
+        n += p->map.size();
+    }
+    return n;
 }
 
 } 
@@ -48,17 +48,29 @@ public:
     value_type
     dereference() const override
     {
+        auto const& item = iter_->second;
         value_type result;
+        if (item.parsed.first)
+        {
+            result.first = item.parsed.first;
+        }
+        else
         {
             SerialIter sit(
-                iter_->second.first->slice());
+                item.txn->slice());
             result.first = std::make_shared<
                 STTx const>(sit);
         }
-        if (metadata_)
+        if (! metadata_)
+            return result;
+        if (item.parsed.second)
+        {
+            result.second = item.parsed.second;
+        }
+        else
         {
             SerialIter sit(
-                iter_->second.second->slice());
+                item.meta->slice());
             result.second = std::make_shared<
                 STObject const>(sit, sfMetadata);
         }
@@ -104,8 +116,9 @@ OpenView::apply (TxsRawView& to) const
     items_.apply(to);
     for (auto const& item : txs_)
         to.rawTxInsert (item.first,
-            item.second.first,
-                item.second.second);
+            item.second.txn,
+                item.second.meta,
+                    item.second.parsed);
 }
 
 
@@ -198,12 +211,14 @@ OpenView::txRead (key_type const& key) const ->
     if (iter == txs_.end())
         return base_->txRead(key);
     auto const& item = iter->second;
+    if (item.parsed.first && (item.parsed.second || ! item.meta))
+        return item.parsed;
     auto stx = std::make_shared<STTx const
-        >(SerialIter{ item.first->slice() });
+        >(SerialIter{ item.txn->slice() });
     decltype(tx_type::second) sto;
-    if (item.second)
+    if (item.meta)
         sto = std::make_shared<STObject const>(
-                SerialIter{ item.second->slice() },
+                SerialIter{ item.meta->slice() },
                     sfMetadata);
     else
         sto = nullptr;
@@ -246,9 +261,20 @@ OpenView::rawTxInsert (key_type const& key,
         const& txn, std::shared_ptr<
             Serializer const>
                 const& metaData)
+{
+    rawTxInsert (key, txn, metaData, {});
+}
+
+void
+OpenView::rawTxInsert (key_type const& key,
+    std::shared_ptr<Serializer const>
+        const& txn, std::shared_ptr<
+            Serializer const>
+                const& metaData,
+                    tx_type const& parsed)
 {
     auto const result = txs_.emplace (key,
-        std::make_pair(txn, metaData));
+        txData {txn, metaData, parsed});
     if (! result.second)
         LogicError("rawTxInsert: duplicate TX id" +
             to_string(key));
@@ -5,6 +5,9 @@
 #include <ripple/basics/Log.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/STAccount.h>
+#include <ripple/protocol/STInteger.h>
+#include <algorithm>
+#include <array>
 #include <string>
 
 namespace ripple {
@@ -230,6 +233,19 @@ STObject TxMeta::getAsObject () const
     return metaData;
 }
 
+STObject TxMeta::takeAsObject ()
+{
+    STObject metaData (sfTransactionMetaData);
+    assert (mResult != 255);
+    metaData.setFieldU8 (sfTransactionResult, mResult);
+    metaData.setFieldU32 (sfTransactionIndex, mIndex);
+    metaData.emplace_back (std::move (mNodes));
+    mNodes = STArray (sfAffectedNodes, 32);
+    if (hasDeliveredAmount ())
+        metaData.setFieldAmount (sfDeliveredAmount, getDeliveredAmount ());
+    return metaData;
+}
+
 void TxMeta::addRaw (Serializer& s, TER result, std::uint32_t index)
 {
     mResult = TERtoInt (result);
@@ -238,7 +254,35 @@ void TxMeta::addRaw (Serializer& s, TER result, std::uint32_t index)
 
     mNodes.sort (compare);
 
-    getAsObject ().add (s);
+    // Write the fields in canonical order, as the object from
+    // getAsObject would, without copying the affected nodes into it.
+    STUInt8 const txResult (sfTransactionResult,
+        static_cast<unsigned char> (mResult));
+    STUInt32 const txIndex (sfTransactionIndex, mIndex);
+
+    std::array<std::pair<SField const*, STBase const*>, 4> fields {{
+        {&sfTransactionResult, &txResult},
+        {&sfTransactionIndex, &txIndex},
+        {&sfAffectedNodes, &mNodes},
+        {&sfDeliveredAmount, mDelivered ? &*mDelivered : nullptr}}};
+
+    std::sort (fields.begin (), fields.end (),
+        [](auto const& a, auto const& b)
+        {
+            return a.first->fieldCode < b.first->fieldCode;
+        });
+
+    for (auto const& field : fields)
+    {
+        if (! field.second)
+            continue;
+
+        auto const type = field.first->fieldType;
+        s.addFieldID (type, field.first->fieldValue);
+        field.second->add (s);
+        if (type == STI_ARRAY || type == STI_OBJECT)
+            s.addFieldID (type, 1);
+    }
 }
 
 } 
@@ -611,6 +611,16 @@ private:
         return jvRequest;
     }
 
+    Json::Value parseLedgerProfile (Json::Value const& jvParams)
+    {
+        Json::Value     jvRequest (Json::objectValue);
+
+        if (jvParams.size ())
+            jvRequest[jss::limit]  = jvParams[0u].asUInt ();
+
+        return jvRequest;
+    }
+
     Json::Value parseLogLevel (Json::Value const& jvParams)
     {
         Json::Value     jvRequest (Json::objectValue);
@@ -1007,6 +1017,7 @@ public:
             {   "ledger_closed",        &RPCParser::parseAsIs,                  0,  0   },
             {   "ledger_current",       &RPCParser::parseAsIs,                  0,  0   },
             {   "ledger_header",        &RPCParser::parseLedgerId,              1,  1   },
+            {   "ledger_profile",       &RPCParser::parseLedgerProfile,         0,  1   },
             {   "ledger_request",       &RPCParser::parseLedgerId,              1,  1   },
             {   "log_level",            &RPCParser::parseLogLevel,              0,  2   },
             {   "logrotate",            &RPCParser::parseAsIs,                  0,  0   },
@@ -5,6 +5,7 @@
 
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/basics/KeyCache.h>
+#include <ripple/basics/LatencyHistogram.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/Backend.h>
 #include <ripple/nodestore/impl/Tuning.h>
@@ -111,6 +112,14 @@ public:
     std::uint32_t
     getFetchSize() const { return fetchSz_; }
 
+    /** Time spent in backend fetches. */
+    LatencyHistogram const&
+    getFetchLatency() const { return fetchLatency_; }
+
+    /** Time spent in backend stores. */
+    LatencyHistogram const&
+    getStoreLatency() const { return storeLatency_; }
+
     
     int
     fdlimit() const { return fdLimit_; }
@@ -148,6 +157,10 @@ protected:
     std::shared_ptr<NodeObject>
     fetchInternal(uint256 const& hash, Backend& srcBackend);
 
+    void
+    storeInternal(std::shared_ptr<NodeObject> const& nObj,
+        Backend& dstBackend);
+
     void
     importInternal(Backend& dstBackend, Database& srcDB);
 
@@ -160,7 +173,8 @@ protected:
     copyLedger(Backend& dstBackend, Ledger const& srcLedger,
         std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
             std::shared_ptr<KeyCache<uint256>> const& nCache,
-                std::shared_ptr<Ledger const> const& srcNext);
+                std::shared_ptr<Ledger const> const& srcNext,
+                    int threads = 1);
 
 private:
     std::atomic<std::uint32_t> storeCount_ {0};
@@ -168,6 +182,8 @@ private:
     std::atomic<std::uint32_t> fetchHitCount_ {0};
     std::atomic<std::uint32_t> storeSz_ {0};
     std::atomic<std::uint32_t> fetchSz_ {0};
+    LatencyHistogram fetchLatency_;
+    LatencyHistogram storeLatency_;
 
     std::mutex readLock_;
     std::condition_variable readCondVar_;
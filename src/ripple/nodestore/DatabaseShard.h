@@ -6,6 +6,7 @@
 #include <ripple/nodestore/Database.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/basics/RangeSet.h>
+#include <ripple/json/json_value.h>
 #include <ripple/nodestore/Types.h>
 
 #include <boost/optional.hpp>
@@ -87,6 +88,13 @@ public:
     void
     validate() = 0;
 
+    /** Progress of the running or last shard import or validation, or
+        null if there has been none.
+    */
+    virtual
+    Json::Value
+    getProgress() const = 0;
+
     
     virtual
     std::uint32_t
@@ -85,6 +85,7 @@ Database::fetchInternal(uint256 const& hash, Backend& srcBackend)
 {
     std::shared_ptr<NodeObject> nObj;
     Status status;
+    auto const start = std::chrono::steady_clock::now();
     try
     {
         status = srcBackend.fetch(hash.begin(), &nObj);
@@ -95,6 +96,7 @@ Database::fetchInternal(uint256 const& hash, Backend& srcBackend)
             "Exception, " << e.what();
         Rethrow();
     }
+    fetchLatency_.insert(std::chrono::steady_clock::now() - start);
 
     switch(status)
     {
@@ -117,6 +119,15 @@ Database::fetchInternal(uint256 const& hash, Backend& srcBackend)
     return nObj;
 }
 
+void
+Database::storeInternal(std::shared_ptr<NodeObject> const& nObj,
+    Backend& dstBackend)
+{
+    auto const start = std::chrono::steady_clock::now();
+    dstBackend.store(nObj);
+    storeLatency_.insert(std::chrono::steady_clock::now() - start);
+}
+
 void
 Database::importInternal(Backend& dstBackend, Database& srcDB)
 {
@@ -187,7 +198,8 @@ bool
 Database::copyLedger(Backend& dstBackend, Ledger const& srcLedger,
     std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
         std::shared_ptr<KeyCache<uint256>> const& nCache,
-            std::shared_ptr<Ledger const> const& srcNext)
+            std::shared_ptr<Ledger const> const& srcNext,
+                int threads)
 {
     assert(static_cast<bool>(pCache) == static_cast<bool>(nCache));
     if (srcLedger.info().hash.isZero() ||
@@ -237,11 +249,13 @@ Database::copyLedger(Backend& dstBackend, Ledger const& srcLedger,
         batch.clear();
         batch.reserve(batchWritePreallocationSize);
     };
-    bool error = false;
+    std::mutex batchMutex;
+    std::atomic<bool> error {false};
     auto f = [&](SHAMapAbstractNode& node) {
         if (auto nObj = srcDB.fetch(
             node.getNodeHash().as_uint256(), srcLedger.info().seq))
         {
+            std::lock_guard<std::mutex> lock(batchMutex);
             batch.emplace_back(std::move(nObj));
             if (batch.size() >= batchWritePreallocationSize)
                 storeBatch();
@@ -273,10 +287,11 @@ Database::copyLedger(Backend& dstBackend, Ledger const& srcLedger,
         {
             auto have = srcNext->stateMap().snapShot(false);
             srcLedger.stateMap().snapShot(
-                false)->visitDifferences(&(*have), f);
+                false)->visitDifferences(&(*have), f, threads);
         }
         else
-            srcLedger.stateMap().snapShot(false)->visitNodes(f);
+            srcLedger.stateMap().snapShot(
+                false)->visitDifferences(nullptr, f, threads);
         if (error)
             return false;
     }
@@ -290,7 +305,8 @@ Database::copyLedger(Backend& dstBackend, Ledger const& srcLedger,
                 " transaction map invalid";
             return false;
         }
-        srcLedger.txMap().snapShot(false)->visitNodes(f);
+        srcLedger.txMap().snapShot(
+            false)->visitDifferences(nullptr, f, threads);
         if (error)
             return false;
     }
@@ -16,7 +16,7 @@ DatabaseNodeImp::store(NodeObjectType type, Blob&& data,
 #endif
     auto nObj = NodeObject::createObject(type, std::move(data), hash);
     pCache_->canonicalize(hash, nObj, true);
-    backend_->store(nObj);
+    storeInternal(nObj, *backend_);
     nCache_->erase(hash);
     storeStats(nObj->getData().size());
 }
@@ -49,7 +49,7 @@ DatabaseRotatingImp::store(NodeObjectType type, Blob&& data,
 #endif
     auto nObj = NodeObject::createObject(type, std::move(data), hash);
     pCache_->canonicalize(hash, nObj, true);
-    getWritableBackend()->store(nObj);
+    storeInternal(nObj, *getWritableBackend());
     nCache_->erase(hash);
     storeStats(nObj->getData().size());
 }
@@ -91,7 +91,7 @@ DatabaseRotatingImp::fetchFrom(uint256 const& hash, std::uint32_t seq)
         nObj = fetchInternal(hash, *b.archiveBackend);
         if (nObj)
         {
-            getWritableBackend()->store(nObj);
+            storeInternal(nObj, *getWritableBackend());
             nCache_->erase(hash);
         }
     }
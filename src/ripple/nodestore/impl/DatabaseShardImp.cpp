@@ -5,12 +5,14 @@
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/basics/chrono.h>
+#include <ripple/basics/ParallelFor.h>
 #include <ripple/basics/random.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/jss.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -37,6 +39,8 @@ DatabaseShardImp::DatabaseShardImp(
         config, "ledgers_per_shard", ledgersPerShardDefault))
     , earliestShardIndex_(seqToShardIndex(earliestSeq()))
     , avgShardSz_(ledgersPerShard_ * (192 * 1024))
+    , workers_(std::max(1, get<int>(config, "worker_threads",
+        std::min(4, static_cast<int>(std::thread::hardware_concurrency())))))
 {
     ctx_->start();
 }
@@ -549,6 +553,7 @@ DatabaseShardImp::getCompleteShards()
 void
 DatabaseShardImp::validate()
 {
+    std::vector<Shard*> shards;
     {
         std::lock_guard<std::mutex> lock(m_);
         assert(init_);
@@ -561,25 +566,45 @@ DatabaseShardImp::validate()
 
         std::string s {"Found shards "};
         for (auto& e : complete_)
+        {
             s += std::to_string(e.second->index()) + ",";
+            shards.push_back(e.second.get());
+        }
         if (incomplete_)
+        {
             s += std::to_string(incomplete_->index());
+            shards.push_back(incomplete_.get());
+        }
         else
             s.pop_back();
         JLOG(j_.debug()) << s;
     }
 
-    for (auto& e : complete_)
-    {
-        app_.shardFamily()->reset();
-        e.second->validate(app_);
-    }
-    if (incomplete_)
-    {
-        app_.shardFamily()->reset();
-        incomplete_->validate(app_);
-    }
-    app_.shardFamily()->reset();
+    // Validate several shards at once and split each ledger's maps across
+    // whatever threads are left over
+    int const parallel = std::min<std::size_t>(workers_, shards.size());
+    int const threads = std::max(1, workers_ / parallel);
+    auto& family = *app_.shardFamily();
+
+    beginProgress("validate", shards.size());
+    family.reset();
+    parallelFor(shards.size(), parallel,
+        [&](std::size_t i)
+        {
+            shards[i]->validate(app_, threads,
+                [this]{ updateProgress(1, 0); });
+            if (parallel == 1)
+                family.reset();
+            else
+            {
+                family.treecache().sweep();
+                family.fullbelow().sweep();
+            }
+            updateProgress(0, 1);
+            return true;
+        });
+    family.reset();
+    endProgress();
 }
 
 void
@@ -643,24 +668,10 @@ DatabaseShardImp::import(Database& source)
         }
     }
 
+    std::vector<std::uint32_t> shardIndexes;
     for (std::uint32_t shardIndex = earliestIndex;
         shardIndex <= latestIndex; ++shardIndex)
     {
-        if (usedDiskSpace_ + avgShardSz_ > maxDiskSpace_)
-        {
-            JLOG(j_.error()) <<
-                "Maximum size reached";
-            canAdd_ = false;
-            break;
-        }
-        if (avgShardSz_ > available())
-        {
-            JLOG(j_.error()) <<
-                "Insufficient disk space";
-            canAdd_ = false;
-            break;
-        }
-
         if (complete_.find(shardIndex) != complete_.end() ||
             (incomplete_ && incomplete_->index() == shardIndex))
         {
@@ -694,75 +705,195 @@ DatabaseShardImp::import(Database& source)
             if (!valid)
                 continue;
         }
+        shardIndexes.push_back(shardIndex);
+    }
+
+    // Import several shards at once. Each worker reserves space for the
+    // shard it takes so the disk space checks still hold.
+    int const parallel = std::min<std::size_t>(workers_, shardIndexes.size());
+    int const threads = std::max(1, workers_ / std::max(1, parallel));
+    std::mutex spaceMutex;
+    std::uint64_t reserved {0};
 
-        app_.shardFamily()->reset();
-        auto const shardDir {dir_ / std::to_string(shardIndex)};
-        auto shard = std::make_unique<Shard>(
-            *this, shardIndex, shardCacheSz, cacheAge_, j_);
-        if (!shard->open(config_, scheduler_, *ctx_))
+    beginProgress("import", shardIndexes.size());
+    app_.shardFamily()->reset();
+    parallelFor(shardIndexes.size(), parallel,
+        [&](std::size_t i)
         {
-            shard.reset();
-            continue;
-        }
+            importFromNodeStore(shardIndexes[i], source, threads,
+                spaceMutex, reserved);
+            updateProgress(0, 1);
+            return true;
+        });
+    endProgress();
+
+    init_ = false;
+    complete_.clear();
+    incomplete_.reset();
+    usedDiskSpace_ = 0;
+    lock.unlock();
+
+    if (!init())
+        Throw<std::runtime_error>("Failed to initialize");
+}
 
-        auto const markerFile {shardDir / importMarker_};
-        std::ofstream ofs {markerFile.string()};
-        if (!ofs.is_open())
+void
+DatabaseShardImp::importFromNodeStore(std::uint32_t shardIndex,
+    Database& source, int threads, std::mutex& spaceMutex,
+        std::uint64_t& reserved)
+{
+    {
+        std::lock_guard<std::mutex> lock(spaceMutex);
+        if (!canAdd_)
+            return;
+        if (usedDiskSpace_ + reserved + avgShardSz_ > maxDiskSpace_)
         {
             JLOG(j_.error()) <<
-                "shard " << shardIndex <<
-                " unable to create temp marker file";
-            shard.reset();
-            removeAll(shardDir, j_);
-            continue;
+                "Maximum size reached";
+            canAdd_ = false;
+            return;
+        }
+        if (reserved + avgShardSz_ > available())
+        {
+            JLOG(j_.error()) <<
+                "Insufficient disk space";
+            canAdd_ = false;
+            return;
         }
-        ofs.close();
+        reserved += avgShardSz_;
+    }
+
+    auto const shardDir {dir_ / std::to_string(shardIndex)};
+    auto shard = std::make_unique<Shard>(
+        *this, shardIndex, shardCacheSz, cacheAge_, j_);
+
+    auto release = [&]
+    {
+        std::lock_guard<std::mutex> lock(spaceMutex);
+        reserved -= avgShardSz_;
+    };
+
+    if (!shard->open(config_, scheduler_, *ctx_))
+    {
+        release();
+        return;
+    }
+
+    auto const markerFile {shardDir / importMarker_};
+    std::ofstream ofs {markerFile.string()};
+    if (!ofs.is_open())
+    {
+        JLOG(j_.error()) <<
+            "shard " << shardIndex <<
+            " unable to create temp marker file";
+        shard.reset();
+        removeAll(shardDir, j_);
+        release();
+        return;
+    }
+    ofs.close();
 
-        while (auto seq = shard->prepare())
+    while (auto seq = shard->prepare())
+    {
+        auto ledger = loadByIndex(*seq, app_, false);
+        if (!ledger || ledger->info().seq != seq ||
+            !Database::copyLedger(*shard->getBackend(), *ledger,
+                nullptr, nullptr, shard->lastStored(), threads))
+            break;
+
+        auto const before {shard->fileSize()};
+        if (!shard->setStored(ledger))
+            break;
+        auto const after {shard->fileSize()};
         {
-            auto ledger = loadByIndex(*seq, app_, false);
-            if (!ledger || ledger->info().seq != seq ||
-                !Database::copyLedger(*shard->getBackend(), *ledger,
-                    nullptr, nullptr, shard->lastStored()))
-                break;
-
-            auto const before {shard->fileSize()};
-            if (!shard->setStored(ledger))
-                break;
-            auto const after {shard->fileSize()};
+            std::lock_guard<std::mutex> lock(spaceMutex);
             if (after > before)
                 usedDiskSpace_ += (after - before);
             else if(after < before)
                 usedDiskSpace_ -= std::min(before - after, usedDiskSpace_);
-
-            if (shard->complete())
-            {
-                JLOG(j_.debug()) <<
-                    "shard " << shardIndex <<
-                    " successfully imported";
-                removeAll(markerFile, j_);
-                break;
-            }
         }
+        updateProgress(1, 0);
 
-        if (!shard->complete())
+        if (shard->complete())
         {
-            JLOG(j_.error()) <<
+            JLOG(j_.debug()) <<
                 "shard " << shardIndex <<
-                " failed to import";
-            shard.reset();
-            removeAll(shardDir, j_);
+                " successfully imported";
+            removeAll(markerFile, j_);
+            break;
         }
     }
 
-    init_ = false;
-    complete_.clear();
-    incomplete_.reset();
-    usedDiskSpace_ = 0;
-    lock.unlock();
+    if (!shard->complete())
+    {
+        JLOG(j_.error()) <<
+            "shard " << shardIndex <<
+            " failed to import";
+        shard.reset();
+        removeAll(shardDir, j_);
+    }
+    release();
+}
 
-    if (!init())
-        Throw<std::runtime_error>("Failed to initialize");
+Json::Value
+DatabaseShardImp::getProgress() const
+{
+    using namespace std::chrono;
+
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    if (!progress_)
+        return {};
+
+    Json::Value ret {Json::objectValue};
+    ret[jss::task] = progress_->task;
+    ret[jss::state] = progress_->running ? "running" : "finished";
+    ret[jss::workers] = workers_;
+    ret[jss::shards] = progress_->shards;
+    ret[jss::shards_done] = progress_->shardsDone;
+    ret[jss::ledgers] = std::to_string(progress_->ledgers);
+
+    auto const end {progress_->running ?
+        steady_clock::now() : progress_->end};
+    auto const ms = duration_cast<milliseconds>(
+        end - progress_->start).count();
+    if (ms > 0)
+    {
+        ret[jss::ledger_rate] = static_cast<double>(
+            progress_->ledgers) * 1000 / ms;
+    }
+    return ret;
+}
+
+void
+DatabaseShardImp::beginProgress(std::string task, std::uint32_t shards)
+{
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    progress_.emplace();
+    progress_->task = std::move(task);
+    progress_->shards = shards;
+    progress_->start = std::chrono::steady_clock::now();
+}
+
+void
+DatabaseShardImp::updateProgress(std::uint64_t ledgers, std::uint32_t shards)
+{
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    if (progress_)
+    {
+        progress_->ledgers += ledgers;
+        progress_->shardsDone += shards;
+    }
+}
+
+void
+DatabaseShardImp::endProgress()
+{
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    if (progress_)
+    {
+        progress_->running = false;
+        progress_->end = std::chrono::steady_clock::now();
+    }
 }
 
 std::int32_t
@@ -802,7 +933,7 @@ DatabaseShardImp::store(NodeObjectType type,
         nObj = NodeObject::createObject(
             type, std::move(data), hash);
         incomplete_->pCache()->canonicalize(hash, nObj, true);
-        incomplete_->getBackend()->store(nObj);
+        storeInternal(nObj, *incomplete_->getBackend());
         incomplete_->nCache()->erase(hash);
     }
     storeStats(nObj->getData().size());
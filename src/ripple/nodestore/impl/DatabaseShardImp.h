@@ -63,6 +63,9 @@ public:
     void
     validate() override;
 
+    Json::Value
+    getProgress() const override;
+
     std::uint32_t
     ledgersPerShard() const override
     {
@@ -180,6 +183,23 @@ private:
     int cacheSz_ {shardCacheSz};
     std::chrono::seconds cacheAge_ {shardCacheAge};
 
+    // Threads shared by the shards being imported or validated at once
+    int const workers_;
+
+    struct Progress
+    {
+        std::string task;
+        bool running {true};
+        std::uint32_t shards {0};
+        std::uint32_t shardsDone {0};
+        std::uint64_t ledgers {0};
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    mutable std::mutex progressMutex_;
+    boost::optional<Progress> progress_;
+
     static constexpr auto importMarker_ = "import";
 
     std::shared_ptr<NodeObject>
@@ -210,6 +230,19 @@ private:
 
     std::uint64_t
     available() const;
+
+    void
+    importFromNodeStore(std::uint32_t shardIndex, Database& source,
+        int threads, std::mutex& spaceMutex, std::uint64_t& reserved);
+
+    void
+    beginProgress(std::string task, std::uint32_t shards);
+
+    void
+    updateProgress(std::uint64_t ledgers, std::uint32_t shards);
+
+    void
+    endProgress();
 };
 
 } 
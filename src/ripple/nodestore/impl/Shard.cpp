@@ -5,6 +5,7 @@
 #include <ripple/nodestore/impl/DatabaseShardImp.h>
 #include <ripple/nodestore/Manager.h>
 
+#include <atomic>
 #include <fstream>
 
 namespace ripple {
@@ -206,7 +207,8 @@ Shard::contains(std::uint32_t seq) const
 }
 
 bool
-Shard::validate(Application& app)
+Shard::validate(Application& app, int threads,
+    std::function<void()> const& onLedger)
 {
     uint256 hash;
     std::uint32_t seq;
@@ -296,8 +298,10 @@ Shard::validate(Application& app)
                 break;
             }
         }
-        if (!valLedger(l, next))
+        if (!valLedger(l, next, threads))
             break;
+        if (onLedger)
+            onLedger();
         hash = l->info().parentHash;
         --seq;
         next = l;
@@ -327,7 +331,7 @@ Shard::validate(Application& app)
 
 bool
 Shard::valLedger(std::shared_ptr<Ledger const> const& l,
-    std::shared_ptr<Ledger const> const& next)
+    std::shared_ptr<Ledger const> const& next, int threads)
 {
     if (l->info().hash.isZero() || l->info().accountHash.isZero())
     {
@@ -335,7 +339,7 @@ Shard::valLedger(std::shared_ptr<Ledger const> const& l,
             "invalid ledger";
         return false;
     }
-    bool error {false};
+    std::atomic<bool> error {false};
     auto f = [&, this](SHAMapAbstractNode& node) {
         if (!valFetch(node.getNodeHash().as_uint256()))
             error = true;
@@ -352,9 +356,9 @@ Shard::valLedger(std::shared_ptr<Ledger const> const& l,
         try
         {
             if (next && next->info().parentHash == l->info().hash)
-                l->stateMap().visitDifferences(&next->stateMap(), f);
+                l->stateMap().visitDifferences(&next->stateMap(), f, threads);
             else
-                l->stateMap().visitNodes(f);
+                l->stateMap().visitDifferences(nullptr, f, threads);
         }
         catch (std::exception const& e)
         {
@@ -375,7 +379,7 @@ Shard::valLedger(std::shared_ptr<Ledger const> const& l,
         }
         try
         {
-            l->txMap().visitNodes(f);
+            l->txMap().visitDifferences(nullptr, f, threads);
         }
         catch (std::exception const& e)
         {
@@ -58,8 +58,12 @@ public:
     bool
     contains(std::uint32_t seq) const;
 
+    /** Verify every ledger in the shard, walking each map with up to
+        threads threads. onLedger is called after each ledger verified.
+    */
     bool
-    validate(Application& app);
+    validate(Application& app, int threads = 1,
+        std::function<void()> const& onLedger = {});
 
     std::uint32_t
     index() const {return index_;}
@@ -131,7 +135,7 @@ private:
 
     bool
     valLedger(std::shared_ptr<Ledger const> const& l,
-        std::shared_ptr<Ledger const> const& next);
+        std::shared_ptr<Ledger const> const& next, int threads);
 
     std::shared_ptr<NodeObject>
     valFetch(uint256 const& hash);
@@ -50,6 +50,13 @@ public:
         beast::IP::Address public_ip;
         int ipLimit = 0;
         std::uint32_t crawlOptions = 0;
+
+        // Threads running the work of each class of inbound message.
+        // Zero uses the default.
+        std::size_t consensusThreads = 0;
+        std::size_t transactionThreads = 0;
+        std::size_t ledgerDataThreads = 0;
+        std::size_t discoveryThreads = 0;
     };
 
     using PeerSequence = std::vector <std::shared_ptr<Peer>>;
@@ -174,6 +181,13 @@ public:
     virtual
     Json::Value
     crawlShards(bool pubKey, std::uint32_t hops) = 0;
+
+    /** Percentiles of the time inbound messages waited and were handled,
+        by class of message.
+    */
+    virtual
+    Json::Value
+    messageLatencyJson() const = 0;
 };
 
 struct ScoreHasLedger
@@ -0,0 +1,264 @@
+#include <ripple/overlay/impl/MessageDispatch.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+namespace ripple {
+
+MessageDispatch::MessageDispatch (std::array<Setup, classes> const& setup)
+    : Source ("dispatch")
+{
+    for (std::size_t i = 0; i < classes; ++i)
+    {
+        pools_[i] = std::make_unique<Pool> ();
+        pools_[i]->setup = setup[i];
+    }
+
+    for (std::size_t i = 0; i < classes; ++i)
+    {
+        auto& pool = *pools_[i];
+        auto const threadName =
+            std::string ("dispatch:") + name (static_cast<Class> (i));
+        for (std::size_t t = 0; t < std::max<std::size_t> (
+            pool.setup.threads, 1); ++t)
+        {
+            pool.threads.emplace_back ([this, &pool, threadName]
+                {
+                    beast::setCurrentThreadName (threadName);
+                    run (pool);
+                });
+        }
+    }
+}
+
+MessageDispatch::~MessageDispatch ()
+{
+    stop ();
+    join ();
+}
+
+MessageDispatch::Class
+MessageDispatch::classify (TrafficCount::category cat)
+{
+    switch (cat)
+    {
+    case TrafficCount::category::manifests:
+    case TrafficCount::category::proposal:
+    case TrafficCount::category::validation:
+    case TrafficCount::category::get_set:
+    case TrafficCount::category::share_set:
+    case TrafficCount::category::ld_tsc_get:
+    case TrafficCount::category::ld_tsc_share:
+    case TrafficCount::category::gl_tsc_share:
+    case TrafficCount::category::gl_tsc_get:
+        return Class::consensus;
+
+    case TrafficCount::category::transaction:
+        return Class::transactions;
+
+    case TrafficCount::category::base:
+    case TrafficCount::category::cluster:
+    case TrafficCount::category::overlay:
+    case TrafficCount::category::shards:
+        return Class::discovery;
+
+    default:
+        return Class::ledgerData;
+    }
+}
+
+char const*
+MessageDispatch::name (Class c)
+{
+    switch (c)
+    {
+    case Class::consensus:      return "consensus";
+    case Class::transactions:   return "transactions";
+    case Class::ledgerData:     return "ledger_data";
+    case Class::discovery:      return "discovery";
+    }
+    return "unknown";
+}
+
+bool
+MessageDispatch::post (Class c, Priority priority,
+    std::function<void ()> work)
+{
+    auto& pool = *pools_[static_cast<std::size_t> (c)];
+    {
+        std::lock_guard<std::mutex> lock (pool.mutex);
+        if (pool.stopping)
+            return false;
+
+        Item item {clock_type::now (), pool.posted++, std::move (work)};
+        if (priority == Priority::urgent)
+        {
+            pool.urgent.push_back (std::move (item));
+        }
+        else if (priority == Priority::required)
+        {
+            pool.required.push_back (std::move (item));
+        }
+        else
+        {
+            if (pool.normal.size () >= pool.setup.limit)
+            {
+                ++pool.dropped;
+                if (pool.setup.policy == DropPolicy::newest ||
+                    pool.normal.empty ())
+                {
+                    return false;
+                }
+                pool.normal.pop_front ();
+            }
+            pool.normal.push_back (std::move (item));
+        }
+    }
+    pool.cond.notify_one ();
+    return true;
+}
+
+void
+MessageDispatch::stop ()
+{
+    for (auto& p : pools_)
+    {
+        std::deque<Item> urgent;
+        std::deque<Item> required;
+        std::deque<Item> normal;
+        {
+            std::lock_guard<std::mutex> lock (p->mutex);
+            p->stopping = true;
+            p->dropped += p->urgent.size () + p->required.size () +
+                p->normal.size ();
+            urgent.swap (p->urgent);
+            required.swap (p->required);
+            normal.swap (p->normal);
+        }
+        p->cond.notify_all ();
+    }
+}
+
+void
+MessageDispatch::join ()
+{
+    for (auto& p : pools_)
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock (p->mutex);
+            assert (p->stopping);
+            threads.swap (p->threads);
+        }
+
+        for (auto& t : threads)
+        {
+            assert (t.get_id () != std::this_thread::get_id ());
+            t.join ();
+        }
+    }
+}
+
+auto
+MessageDispatch::getStats (Class c) const -> Stats
+{
+    auto const& pool = *pools_[static_cast<std::size_t> (c)];
+    std::lock_guard<std::mutex> lock (pool.mutex);
+    return {pool.urgent.size () + pool.required.size () +
+        pool.normal.size (),
+        pool.executed.load (), pool.dropped.load ()};
+}
+
+LatencyHistogram const&
+MessageDispatch::waitTimes (Class c) const
+{
+    return pools_[static_cast<std::size_t> (c)]->wait;
+}
+
+LatencyHistogram const&
+MessageDispatch::runTimes (Class c) const
+{
+    return pools_[static_cast<std::size_t> (c)]->run;
+}
+
+Json::Value
+MessageDispatch::getLatencyJson () const
+{
+    Json::Value ret (Json::objectValue);
+    for (std::size_t i = 0; i < classes; ++i)
+    {
+        auto const c = static_cast<Class> (i);
+        Json::Value& jv = ret[name (c)] = Json::objectValue;
+        jv["wait"] = waitTimes (c).snapshot ().getJson ();
+        jv["run"] = runTimes (c).snapshot ().getJson ();
+    }
+    return ret;
+}
+
+void
+MessageDispatch::onWrite (beast::PropertyStream::Map& stream)
+{
+    for (std::size_t i = 0; i < classes; ++i)
+    {
+        auto const c = static_cast<Class> (i);
+        auto const stats = getStats (c);
+        auto const& setup = pools_[i]->setup;
+
+        beast::PropertyStream::Map item (name (c), stream);
+        item["threads"] = setup.threads;
+        item["limit"] = setup.limit;
+        item["queued"] = stats.queued;
+        item["executed"] = stats.executed;
+        item["dropped"] = stats.dropped;
+
+        auto const percentiles = [&item](
+            std::string const& prefix, LatencyHistogram const& h)
+        {
+            auto const snapshot = h.snapshot ();
+            item[prefix + "_p50_us"] = snapshot.percentile (0.5);
+            item[prefix + "_p90_us"] = snapshot.percentile (0.9);
+            item[prefix + "_p99_us"] = snapshot.percentile (0.99);
+        };
+        percentiles ("wait", waitTimes (c));
+        percentiles ("run", runTimes (c));
+    }
+}
+
+void
+MessageDispatch::run (Pool& pool)
+{
+    std::unique_lock<std::mutex> lock (pool.mutex);
+    for (;;)
+    {
+        pool.cond.wait (lock, [&pool]
+            {
+                return pool.stopping || ! pool.urgent.empty () ||
+                    ! pool.required.empty () || ! pool.normal.empty ();
+            });
+        if (pool.stopping)
+            return;
+
+        // Required and normal work run in the order they were posted
+        auto& queue = ! pool.urgent.empty () ? pool.urgent :
+            pool.required.empty () ? pool.normal :
+            pool.normal.empty () ? pool.required :
+            pool.required.front ().order < pool.normal.front ().order ?
+                pool.required : pool.normal;
+        Item item = std::move (queue.front ());
+        queue.pop_front ();
+        lock.unlock ();
+
+        auto const start = clock_type::now ();
+        pool.wait.insert (start - item.queued);
+        item.work ();
+        pool.run.insert (clock_type::now () - start);
+        ++pool.executed;
+
+        // Release what the work captured before waiting for more
+        item.work = nullptr;
+        lock.lock ();
+    }
+}
+
+}
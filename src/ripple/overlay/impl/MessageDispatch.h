@@ -0,0 +1,168 @@
+#ifndef RIPPLE_OVERLAY_MESSAGEDISPATCH_H_INCLUDED
+#define RIPPLE_OVERLAY_MESSAGEDISPATCH_H_INCLUDED
+
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/basics/LatencyHistogram.h>
+#include <ripple/beast/utility/PropertyStream.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** Runs the work of inbound peer messages on a bounded pool per class.
+
+    Each class of message has its own threads and queue, so a burst of
+    bulk ledger traffic can not delay consensus messages. Urgent work,
+    such as messages from trusted validators, runs before the rest of its
+    class and is never dropped. Required work runs in order with normal
+    work but is never dropped either. Normal work is dropped once its
+    class has too much queued, according to the class policy.
+*/
+class MessageDispatch : public beast::PropertyStream::Source
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    enum class Class
+    {
+        consensus,
+        transactions,
+        ledgerData,
+        discovery
+    };
+
+    static std::size_t constexpr classes = 4;
+
+    enum class Priority
+    {
+        // Dropped once its class has too much queued
+        normal,
+
+        // Runs in order with normal work, but is never dropped
+        required,
+
+        // Runs before the rest of its class and is never dropped
+        urgent
+    };
+
+    enum class DropPolicy
+    {
+        // Refuse the new work
+        newest,
+
+        // Make room by dropping the work queued longest
+        oldest
+    };
+
+    struct Setup
+    {
+        std::size_t threads;
+        std::size_t limit;
+        DropPolicy policy;
+    };
+
+    struct Stats
+    {
+        std::size_t queued;
+        std::uint64_t executed;
+        std::uint64_t dropped;
+    };
+
+    explicit
+    MessageDispatch (std::array<Setup, classes> const& setup);
+
+    MessageDispatch (MessageDispatch const&) = delete;
+    MessageDispatch& operator= (MessageDispatch const&) = delete;
+
+    ~MessageDispatch ();
+
+    /** The class of an inbound message. */
+    static
+    Class
+    classify (TrafficCount::category cat);
+
+    static
+    char const*
+    name (Class c);
+
+    /** Queue work to run on the pool of a class.
+
+        @return `false` if the work was refused.
+    */
+    bool
+    post (Class c, Priority priority, std::function<void ()> work);
+
+    /** Drop all queued work and refuse more, without waiting.
+
+        May be called from any thread, including one running work.
+    */
+    void
+    stop ();
+
+    /** Wait for the threads to finish the work they are running.
+
+        Must follow stop, and must not be called from a pool thread. It
+        may block, so do not call it from an I/O thread either.
+    */
+    void
+    join ();
+
+    Stats
+    getStats (Class c) const;
+
+    LatencyHistogram const&
+    waitTimes (Class c) const;
+
+    LatencyHistogram const&
+    runTimes (Class c) const;
+
+    /** Percentiles of the time messages of each class waited and ran. */
+    Json::Value
+    getLatencyJson () const;
+
+    void
+    onWrite (beast::PropertyStream::Map& stream) override;
+
+private:
+    struct Item
+    {
+        clock_type::time_point queued;
+        std::uint64_t order;
+        std::function<void ()> work;
+    };
+
+    struct Pool
+    {
+        Setup setup;
+        std::mutex mutable mutex;
+        std::condition_variable cond;
+        bool stopping = false;
+        std::uint64_t posted = 0;
+        std::deque<Item> urgent;
+        std::deque<Item> required;
+        std::deque<Item> normal;
+        std::vector<std::thread> threads;
+        std::atomic<std::uint64_t> executed {0};
+        std::atomic<std::uint64_t> dropped {0};
+        LatencyHistogram wait;
+        LatencyHistogram run;
+    };
+
+    void
+    run (Pool& pool);
+
+    std::array<std::unique_ptr<Pool>, classes> pools_;
+};
+
+}
+
+#endif
@@ -14,6 +14,7 @@
 #include <ripple/overlay/predicates.h>
 #include <ripple/overlay/impl/ConnectAttempt.h>
 #include <ripple/overlay/impl/PeerImp.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/peerfinder/make_Manager.h>
 #include <ripple/rpc/json_body.h>
 #include <ripple/rpc/handlers/GetCounts.h>
@@ -135,16 +136,32 @@ OverlayImpl::OverlayImpl (
     , m_resourceManager (resourceManager)
     , m_peerFinder (PeerFinder::make_Manager (*this, io_service,
         stopwatch(), app_.journal("PeerFinder"), config))
+    , dispatch_ ({{
+        {setup.consensusThreads ? setup.consensusThreads
+            : Tuning::consensusThreads, Tuning::consensusQueue,
+                MessageDispatch::DropPolicy::oldest},
+        {setup.transactionThreads ? setup.transactionThreads
+            : Tuning::transactionThreads, Tuning::transactionQueue,
+                MessageDispatch::DropPolicy::newest},
+        {setup.ledgerDataThreads ? setup.ledgerDataThreads
+            : Tuning::ledgerDataThreads, Tuning::ledgerDataQueue,
+                MessageDispatch::DropPolicy::oldest},
+        {setup.discoveryThreads ? setup.discoveryThreads
+            : Tuning::discoveryThreads, Tuning::discoveryQueue,
+                MessageDispatch::DropPolicy::newest}}})
     , m_resolver (resolver)
     , next_id_(1)
     , timer_count_(0)
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
+    beast::PropertyStream::Source::add (dispatch_);
 }
 
 OverlayImpl::~OverlayImpl ()
 {
     stop();
+    dispatch_.stop();
+    dispatch_.join();
 
     std::unique_lock <decltype(mutex_)> lock (mutex_);
     cond_.wait (lock, [this] { return list_.empty(); });
@@ -366,7 +383,8 @@ OverlayImpl::connect (beast::IP::Endpoint const& remote_endpoint)
     }
 
     auto const p = std::make_shared<ConnectAttempt>(app_,
-        io_service_, beast::IPAddressConversion::to_asio_endpoint(remote_endpoint),
+        app_.getIOShard(),
+        beast::IPAddressConversion::to_asio_endpoint(remote_endpoint),
             usage, setup_.context, next_id_++, slot,
                 app_.journal("Peer"), *this);
 
@@ -522,6 +540,11 @@ OverlayImpl::onStop ()
 void
 OverlayImpl::onChildrenStopped ()
 {
+    // stop() runs on the strand and only tells the pools to stop. Wait for
+    // them here, off the I/O threads.
+    dispatch_.stop();
+    dispatch_.join();
+
     std::lock_guard <decltype(mutex_)> lock (mutex_);
     checkStopped ();
 }
@@ -1101,6 +1124,7 @@ OverlayImpl::stop()
         if (child != nullptr)
             child->stop();
     }
+    dispatch_.stop();
 }
 
 void
@@ -1166,6 +1190,21 @@ setup_Overlay (BasicConfig const& config)
             if (ec || beast::IP::is_private(setup.public_ip))
                 Throw<std::runtime_error>("Configured public IP is invalid");
         }
+
+        auto threads = [&section](std::string const& name)
+        {
+            int n = 0;
+            set(n, name, section);
+            if (n < 0 ||
+                static_cast<std::size_t>(n) > Tuning::maxDispatchThreads)
+                Throw<std::runtime_error>(
+                    "Configured " + name + " is invalid");
+            return static_cast<std::size_t>(n);
+        };
+        setup.consensusThreads = threads("consensus_threads");
+        setup.transactionThreads = threads("transaction_threads");
+        setup.ledgerDataThreads = threads("ledger_data_threads");
+        setup.discoveryThreads = threads("discovery_threads");
     }
     {
         auto const& section = config.section("crawl");
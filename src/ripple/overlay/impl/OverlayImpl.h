@@ -6,6 +6,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/core/Job.h>
 #include <ripple/overlay/Overlay.h>
+#include <ripple/overlay/impl/MessageDispatch.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <ripple/server/Handoff.h>
 #include <ripple/rpc/ServerHandler.h>
@@ -94,6 +95,7 @@ private:
     Resource::Manager& m_resourceManager;
     std::unique_ptr <PeerFinder::Manager> m_peerFinder;
     TrafficCount m_traffic;
+    MessageDispatch dispatch_;
     hash_map <PeerFinder::Slot::ptr,
         std::weak_ptr <PeerImp>> m_peers;
     hash_map<Peer::id_t, std::weak_ptr<PeerImp>> ids_;
@@ -145,6 +147,12 @@ public:
         return setup_;
     }
 
+    MessageDispatch&
+    dispatch()
+    {
+        return dispatch_;
+    }
+
     Handoff
     onHandoff (std::unique_ptr <beast::asio::ssl_bundle>&& bundle,
         http_request_type&& request,
@@ -330,6 +338,12 @@ public:
     Json::Value
     crawlShards(bool pubKey, std::uint32_t hops) override;
 
+    Json::Value
+    messageLatencyJson() const override
+    {
+        return dispatch_.getLatencyJson();
+    }
+
 
     
     void
@@ -21,6 +21,8 @@
 #include <ripple/overlay/Cluster.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/digest.h>
+#include <ripple/shamap/Family.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
 
 #include <boost/algorithm/clamp.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -868,8 +870,9 @@ PeerImp::onMessageBegin (std::uint16_t type,
     load_event_ = app_.getJobQueue ().makeLoadEvent (
         jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
-    overlay_.reportTraffic (TrafficCount::categorize (*m, type, true),
-        true, static_cast<int>(size));
+    auto const category = TrafficCount::categorize (*m, type, true);
+    msgClass_ = MessageDispatch::classify (category);
+    overlay_.reportTraffic (category, true, static_cast<int>(size));
     return error_code{};
 }
 
@@ -891,9 +894,9 @@ void
 PeerImp::onMessage (std::shared_ptr<protocol::TMManifests> const& m)
 {
     auto that = shared_from_this();
-    app_.getJobQueue().addJob (
-        jtVALIDATION_ut, "receiveManifests",
-        [this, that, m] (Job&) { overlay_.onManifests(m, that); });
+    dispatch (jtVALIDATION_ut, "receiveManifests",
+        MessageDispatch::Priority::required,
+        [this, that, m] () { overlay_.onManifests(m, that); });
 }
 
 void
@@ -1382,26 +1385,22 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
             }
         }
 
-        constexpr int max_transactions = 250;
-        if (app_.getJobQueue().getJobCount(jtTRANSACTION) > max_transactions)
-        {
-            overlay_.incJqTransOverflow();
-            JLOG(p_journal_.info()) << "Transaction queue is full";
-        }
-        else if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
+        if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
         {
             JLOG(p_journal_.trace()) << "No new transactions until synchronized";
         }
-        else
+        else if (! dispatch (jtTRANSACTION,
+            "recvTransaction->checkTransaction",
+            MessageDispatch::Priority::normal,
+            [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+            flags, checkSignature, stx] () {
+                if (auto peer = weak.lock())
+                    peer->checkTransaction(flags,
+                        checkSignature, stx);
+            }))
         {
-            app_.getJobQueue ().addJob (
-                jtTRANSACTION, "recvTransaction->checkTransaction",
-                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                flags, checkSignature, stx] (Job&) {
-                    if (auto peer = weak.lock())
-                        peer->checkTransaction(flags,
-                            checkSignature, stx);
-                });
+            overlay_.incJqTransOverflow();
+            JLOG(p_journal_.info()) << "Transaction queue is full";
         }
     }
     catch (std::exception const&)
@@ -1416,9 +1415,9 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetLedger> const& m)
 {
     fee_ = Resource::feeMediumBurdenPeer;
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob (
-        jtLEDGER_REQ, "recvGetLedger",
-        [weak, m] (Job&) {
+    dispatch (jtLEDGER_REQ, "recvGetLedger",
+        MessageDispatch::Priority::required,
+        [weak, m] () {
             if (auto peer = weak.lock())
                 peer->getLedger(m);
         });
@@ -1465,9 +1464,9 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMLedgerData> const& m)
     {
         std::weak_ptr<PeerImp> weak = shared_from_this();
         auto& journal = p_journal_;
-        app_.getJobQueue().addJob(
-            jtTXN_DATA, "recvPeerData",
-            [weak, hash, journal, m] (Job&) {
+        dispatch (jtTXN_DATA, "recvPeerData",
+            MessageDispatch::Priority::normal,
+            [weak, hash, journal, m] () {
                 if (auto peer = weak.lock())
                     peer->peerTXData(hash, m, journal);
             });
@@ -1557,11 +1556,13 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMProposeSet> const& m)
             calcNodeID(app_.validatorManifests().getMasterKey(publicKey))});
 
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue ().addJob (
-        isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut, "recvPropose->checkPropose",
-        [weak, m, proposal] (Job& job) {
+    dispatch (isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut,
+        "recvPropose->checkPropose", isTrusted ?
+            MessageDispatch::Priority::urgent :
+            MessageDispatch::Priority::normal,
+        [weak, isTrusted, m, proposal] () {
             if (auto peer = weak.lock())
-                peer->checkPropose(job, m, proposal);
+                peer->checkPropose(isTrusted, m, proposal);
         });
 }
 
@@ -1895,10 +1896,11 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMValidation> const& m)
             ! app_.getFeeTrack ().isLoadedLocal ())
         {
             std::weak_ptr<PeerImp> weak = shared_from_this();
-            app_.getJobQueue ().addJob (
-                isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
-                "recvValidation->checkValidation",
-                [weak, val, m] (Job&)
+            dispatch (isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
+                "recvValidation->checkValidation", isTrusted ?
+                    MessageDispatch::Priority::urgent :
+                    MessageDispatch::Priority::normal,
+                [weak, val, m] ()
                 {
                     if (auto peer = weak.lock())
                         peer->checkValidation(val, m);
@@ -1939,54 +1941,31 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
 
         fee_ = Resource::feeMediumBurdenPeer;
 
-        protocol::TMGetObjectByHash reply;
-
-        reply.set_query (false);
-
-        if (packet.has_seq())
-            reply.set_seq(packet.seq());
-
-        reply.set_type (packet.type ());
-
-        if (packet.has_ledgerhash ())
-            reply.set_ledgerhash (packet.ledgerhash ());
-
-        for (int i = 0; i < packet.objects_size (); ++i)
-        {
-            auto const& obj = packet.objects (i);
-            if (obj.has_hash() && stringIsUint256Sized (obj.hash()))
-            {
-                uint256 const hash {obj.hash()};
-                std::uint32_t seq {obj.has_ledgerseq() ? obj.ledgerseq() : 0};
-                auto hObj {app_.getNodeStore().fetch (hash, seq)};
-                if (!hObj)
-                {
-                    if (auto shardStore = app_.getShardStore())
-                    {
-                        if (seq >= shardStore->earliestSeq())
-                            hObj = shardStore->fetch(hash, seq);
-                    }
-                }
-                if (hObj)
+        std::weak_ptr<PeerImp> weak = shared_from_this();
+        dispatch (jtLEDGER_REQ, "recvGetObjectByHash",
+            MessageDispatch::Priority::normal,
+            [weak, m] () {
+                if (auto peer = weak.lock())
+                    peer->getObjects (m);
+            });
+    }
+    else if (packet.type () == protocol::TMGetObjectByHash::otFETCH_PACK &&
+        packet.has_ledgercount ())
+    {
+        // One message of a fetch pack stream: verify and store off the
+        // I/O thread so the rest of the stream keeps flowing
+        std::weak_ptr<PeerImp> weak = shared_from_this();
+        auto const pap = &app_;
+        auto const id = id_;
+        dispatch (jtLEDGER_DATA, "gotFetchPackStream",
+            MessageDispatch::Priority::normal,
+            [weak, pap, id, m] () {
+                if (! pap->getLedgerMaster().gotFetchPackStream (m, id))
                 {
-                    protocol::TMIndexedObject& newObj = *reply.add_objects ();
-                    newObj.set_hash (hash.begin (), hash.size ());
-                    newObj.set_data (&hObj->getData ().front (),
-                        hObj->getData ().size ());
-
-                    if (obj.has_nodeid ())
-                        newObj.set_index (obj.nodeid ());
-                    if (obj.has_ledgerseq())
-                        newObj.set_ledgerseq(obj.ledgerseq());
-
+                    if (auto peer = weak.lock())
+                        peer->charge (Resource::feeInvalidRequest);
                 }
-            }
-        }
-
-        JLOG(p_journal_.trace()) <<
-            "GetObj: " << reply.objects_size () <<
-                " of " << packet.objects_size ();
-        send (std::make_shared<Message> (reply, protocol::mtGET_OBJECTS));
+            });
     }
     else
     {
@@ -2041,7 +2020,16 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
                 "GetObj: Partial fetch pack for " << pLSeq;
         }
         if (packet.type () == protocol::TMGetObjectByHash::otFETCH_PACK)
+        {
+            // A peer that answers with a classic fetch pack won't stream
+            if (packet.has_ledgerhash () &&
+                stringIsUint256Sized (packet.ledgerhash ()))
+            {
+                app_.getLedgerMaster ().endFetchPackStream (
+                    id_, uint256 {packet.ledgerhash ()});
+            }
             app_.getLedgerMaster ().gotFetchPack (progress, pLSeq);
+        }
     }
 }
 
@@ -2063,6 +2051,22 @@ PeerImp::addLedger (uint256 const& hash,
     recentLedgers_.push_back (hash);
 }
 
+bool
+PeerImp::dispatch (JobType type, char const* name,
+    MessageDispatch::Priority priority, std::function<void ()> work)
+{
+    // Time the work from now until it has run, as a job of this type would
+    // be, so the job queue and the fee track still see the load
+    std::shared_ptr<LoadEvent> event =
+        app_.getJobQueue().makeLoadEvent (type, name);
+    return overlay_.dispatch().post (msgClass_, priority,
+        [event, work = std::move (work)] () mutable
+        {
+            work ();
+            event.reset ();
+        });
+}
+
 void
 PeerImp::doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet)
 {
@@ -2096,6 +2100,71 @@ PeerImp::doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet
         });
 }
 
+void
+PeerImp::getObjects (
+    std::shared_ptr<protocol::TMGetObjectByHash> const& packet)
+{
+    protocol::TMGetObjectByHash reply;
+
+    reply.set_query (false);
+
+    if (packet->has_seq())
+        reply.set_seq(packet->seq());
+
+    reply.set_type (packet->type ());
+
+    if (packet->has_ledgerhash ())
+        reply.set_ledgerhash (packet->ledgerhash ());
+
+    for (int i = 0; i < packet->objects_size (); ++i)
+    {
+        auto const& obj = packet->objects (i);
+        if (obj.has_hash() && stringIsUint256Sized (obj.hash()))
+        {
+            uint256 const hash {obj.hash()};
+            std::uint32_t seq {obj.has_ledgerseq() ? obj.ledgerseq() : 0};
+            auto hObj {app_.getNodeStore().fetch (hash, seq)};
+            if (!hObj)
+            {
+                if (auto shardStore = app_.getShardStore())
+                {
+                    if (seq >= shardStore->earliestSeq())
+                        hObj = shardStore->fetch(hash, seq);
+                }
+            }
+            if (!hObj)
+            {
+                // The nodes of a ledger still being written are only cached
+                if (auto node = app_.family().treecache().fetch (hash))
+                {
+                    Serializer s;
+                    node->addRaw (s, snfPREFIX);
+                    hObj = NodeObject::createObject (
+                        hotUNKNOWN, std::move (s.modData ()), hash);
+                }
+            }
+            if (hObj)
+            {
+                protocol::TMIndexedObject& newObj = *reply.add_objects ();
+                newObj.set_hash (hash.begin (), hash.size ());
+                newObj.set_data (&hObj->getData ().front (),
+                    hObj->getData ().size ());
+
+                if (obj.has_nodeid ())
+                    newObj.set_index (obj.nodeid ());
+                if (obj.has_ledgerseq())
+                    newObj.set_ledgerseq(obj.ledgerseq());
+
+            }
+        }
+    }
+
+    JLOG(p_journal_.trace()) <<
+        "GetObj: " << reply.objects_size () <<
+            " of " << packet->objects_size ();
+    send (std::make_shared<Message> (reply, protocol::mtGET_OBJECTS));
+}
+
 void
 PeerImp::checkTransaction (int flags,
     bool checkSignature, std::shared_ptr<STTx const> const& stx)
@@ -2164,12 +2233,10 @@ PeerImp::checkTransaction (int flags,
 }
 
 void
-PeerImp::checkPropose (Job& job,
+PeerImp::checkPropose (bool isTrusted,
     std::shared_ptr <protocol::TMProposeSet> const& packet,
         RCLCxPeerPos peerPos)
 {
-    bool isTrusted = (job.getType () == jtPROPOSAL_t);
-
     JLOG(p_journal_.trace()) <<
         "Checking " << (isTrusted ? "trusted" : "UNTRUSTED") << " proposal";
 
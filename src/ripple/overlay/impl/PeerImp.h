@@ -135,6 +135,7 @@ private:
     int large_sendq_ = 0;
     int no_ping_ = 0;
     std::unique_ptr <LoadEvent> load_event_;
+    MessageDispatch::Class msgClass_ = MessageDispatch::Class::discovery;
 
     std::mutex mutable shardInfoMutex_;
     hash_map<PublicKey, ShardInfo> shardInfo_;
@@ -402,15 +403,22 @@ private:
     addLedger (uint256 const& hash,
         std::lock_guard<std::mutex> const& lockedRecentLock);
 
+    bool
+    dispatch (JobType type, char const* name,
+        MessageDispatch::Priority priority, std::function<void ()> work);
+
     void
     doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet);
 
+    void
+    getObjects (std::shared_ptr<protocol::TMGetObjectByHash> const& packet);
+
     void
     checkTransaction (int flags, bool checkSignature,
         std::shared_ptr<STTx const> const& stx);
 
     void
-    checkPropose (Job& job,
+    checkPropose (bool isTrusted,
         std::shared_ptr<protocol::TMProposeSet> const& packet,
             RCLCxPeerPos peerPos);
 
@@ -4,6 +4,7 @@
 #define RIPPLE_OVERLAY_TUNING_H_INCLUDED
 
 #include <chrono>
+#include <cstddef>
 
 namespace ripple {
 
@@ -55,6 +56,19 @@ enum
 
 std::chrono::milliseconds constexpr peerHighLatency{300};
 
+// Default threads and most queued messages of each dispatch class
+std::size_t constexpr consensusThreads      =    2;
+std::size_t constexpr consensusQueue        = 1024;
+std::size_t constexpr transactionThreads    =    2;
+std::size_t constexpr transactionQueue      =  250;
+std::size_t constexpr ledgerDataThreads     =    2;
+std::size_t constexpr ledgerDataQueue       =  256;
+std::size_t constexpr discoveryThreads      =    1;
+std::size_t constexpr discoveryQueue        =   64;
+
+// Most threads that can be configured for a dispatch class
+std::size_t constexpr maxDispatchThreads    =   32;
+
 } 
 
 } 
@@ -51,7 +51,10 @@ JSS ( PaymentChannelClaim );
 JSS ( PaymentChannelCreate );       
 JSS ( PaymentChannelFund );         
 JSS ( RippleState );                
+JSS ( SLE_cache_size );             
 JSS ( SLE_hit_rate );               
+JSS ( SLE_reads_hit );              
+JSS ( SLE_reads_total );            
 JSS ( SetFee );                     
 JSS ( SettleDelay );                
 JSS ( SendMax );                    
@@ -91,6 +94,7 @@ JSS ( alternatives );
 JSS ( amendment_blocked );          
 JSS ( amendments );                 
 JSS ( amount );                     
+JSS ( args );
 JSS ( asks );                       
 JSS ( assets );                     
 JSS ( authorized );                 
@@ -111,6 +115,7 @@ JSS ( build_path );
 JSS ( build_version );              
 JSS ( cancel_after );               
 JSS ( can_delete );                 
+JSS ( cat );
 JSS ( channel_id );                 
 JSS ( channels );                   
 JSS ( check );                      
@@ -133,6 +138,8 @@ JSS ( complete_shards );
 JSS ( consensus );                  
 JSS ( converge_time );              
 JSS ( converge_time_s );            
+JSS ( copied_ledger );              
+JSS ( copy_rate );                  
 JSS ( count );                      
 JSS ( counters );                   
 JSS ( currency );                   
@@ -150,6 +157,7 @@ JSS ( delivered_amount );
 JSS ( deposit_authorized );         
 JSS ( deposit_preauth );            
 JSS ( deprecated );                 
+JSS ( depth );
 JSS ( descending );                 
 JSS ( destination_account );        
 JSS ( destination_amount );         
@@ -159,7 +167,9 @@ JSS ( dir_entry );
 JSS ( dir_index );                  
 JSS ( dir_root );                   
 JSS ( directory );                  
+JSS ( displayTimeUnit );
 JSS ( drops );                      
+JSS ( dur );
 JSS ( duration_us );                
 JSS ( enabled );                    
 JSS ( engine_result );              
@@ -210,10 +220,12 @@ JSS ( id );
 JSS ( ident );                      
 JSS ( inLedger );                   
 JSS ( inbound );                    
+JSS ( incremental );                
 JSS ( index );                      
 JSS ( info );                       
 JSS ( internal_command );           
 JSS ( io_latency_ms );              
+JSS ( io_shard_latency_ms );        
 JSS ( ip );                         
 JSS ( issuer );                     
 JSS ( job );
@@ -229,6 +241,7 @@ JSS ( last_close );
 JSS ( last_refresh_time );          
 JSS ( last_refresh_status );        
 JSS ( last_refresh_message );       
+JSS ( last_rotated );               
 JSS ( ledger );                     
 JSS ( ledger_current_index );       
 JSS ( ledger_data );                
@@ -239,7 +252,10 @@ JSS ( ledger_index_max );
 JSS ( ledger_index_min );           
 JSS ( ledger_max );                 
 JSS ( ledger_min );                 
+JSS ( ledger_profile );
+JSS ( ledger_rate );                
 JSS ( ledger_time );                
+JSS ( ledgers );                    
 JSS ( levels );                     
 JSS ( limit );                      
 JSS ( limit_peer );                 
@@ -292,18 +308,24 @@ JSS ( no_ripple );
 JSS ( no_ripple_peer );             
 JSS ( node );                       
 JSS ( node_binary );                
+JSS ( node_fetch );                 
 JSS ( node_hit_rate );              
 JSS ( node_read_bytes );            
 JSS ( node_reads_hit );             
 JSS ( node_reads_total );           
+JSS ( node_store );                 
 JSS ( node_writes );                
 JSS ( node_written_bytes );         
 JSS ( nodes );                      
+JSS ( nodes_copied );               
+JSS ( nodes_hashed );
+JSS ( nodes_written );
 JSS ( obligations );                
 JSS ( offer );                      
 JSS ( offers );                     
 JSS ( offline );                    
 JSS ( offset );                     
+JSS ( online_delete );              
 JSS ( open );                       
 JSS ( open_ledger_fee );            
 JSS ( open_ledger_level );          
@@ -318,15 +340,20 @@ JSS ( password );
 JSS ( paths );                      
 JSS ( paths_canonical );            
 JSS ( paths_computed );             
+JSS ( pause_ms );                   
 JSS ( payment_channel );            
 JSS ( peer );                       
 JSS ( peer_authorized );            
 JSS ( peer_id );                    
+JSS ( peer_messages );              
 JSS ( peers );                      
 JSS ( peer_disconnects );           
 JSS ( peer_disconnects_resources ); 
+JSS ( ph );
+JSS ( pid );
 JSS ( port );                       
 JSS ( previous_ledger );            
+JSS ( process_name );
 JSS ( proof );                      
 JSS ( propose_seq );                
 JSS ( proposers );                  
@@ -381,7 +408,10 @@ JSS ( server_state_duration_us );
 JSS ( server_status );              
 JSS ( settle_delay );               
 JSS ( severity );                   
+JSS ( shamap_fetch );               
+JSS ( shard_progress );             
 JSS ( shards );                     
+JSS ( shards_done );                
 JSS ( signature );                  
 JSS ( signature_verified );         
 JSS ( signing_key );                
@@ -389,6 +419,7 @@ JSS ( signing_keys );
 JSS ( signing_time );               
 JSS ( signer_list );                
 JSS ( signer_lists );               
+JSS ( sles_read );
 JSS ( snapshot );                   
 JSS ( source_account );             
 JSS ( source_amount );              
@@ -415,10 +446,13 @@ JSS ( taker_gets );
 JSS ( taker_gets_funded );          
 JSS ( taker_pays );                 
 JSS ( taker_pays_funded );          
+JSS ( task );                       
 JSS ( threshold );                  
 JSS ( ticket );                     
+JSS ( tid );
 JSS ( time );
 JSS ( timeouts );                   
+JSS ( traceEvents );
 JSS ( traffic );                    
 JSS ( total );                      
 JSS ( totalCoins );                 
@@ -432,6 +466,7 @@ JSS ( treenode_cache_size );
 JSS ( treenode_track_size );        
 JSS ( trusted );                    
 JSS ( trusted_validator_keys );     
+JSS ( ts );
 JSS ( tx );                         
 JSS ( tx_blob );                    
 JSS ( tx_hash );                    
@@ -8,6 +8,7 @@
 #include <ripple/resource/impl/Tuning.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/core/List.h>
+#include <atomic>
 #include <cassert>
 
 namespace ripple {
@@ -25,7 +26,7 @@ struct Entry
         : refcount (0)
         , local_balance (now)
         , remote_balance (0)
-        , lastWarningTime ()
+        , lastWarningTime (clock_type::time_point ())
         , whenExpires ()
     {
     }
@@ -41,26 +42,29 @@ struct Entry
         return key->kind == kindUnlimited;
     }
 
-    int balance (clock_type::time_point const now)
+    int balance (clock_type::time_point const now) const
     {
-        return local_balance.value (now) + remote_balance;
+        return local_balance.value (now) + remote_balance.load ();
     }
 
     int add (int charge, clock_type::time_point const now)
     {
-        return local_balance.add (charge, now) + remote_balance;
+        return local_balance.add (charge, now) + remote_balance.load ();
     }
 
     Key const* key;
 
-    int refcount;
+    // Changed under the lock of the shard holding the entry only when
+    // going to or from zero, since the entry is then moved between lists.
+    std::atomic<int> refcount;
 
-    DecayingSample <decayWindowSeconds, clock_type> local_balance;
+    AtomicDecayingSample <decayWindowSeconds, clock_type> local_balance;
 
-    int remote_balance;
+    std::atomic<int> remote_balance;
 
-    clock_type::time_point lastWarningTime;
+    std::atomic<clock_type::time_point> lastWarningTime;
 
+    // Guarded by the lock of the shard holding the entry
     clock_type::time_point whenExpires;
 };
 
@@ -14,6 +14,7 @@
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
 #include <ripple/beast/utility/PropertyStream.h>
+#include <array>
 #include <cassert>
 #include <mutex>
 
@@ -40,22 +41,35 @@ private:
         beast::insight::Meter drop;
     };
 
-    Stats m_stats;
-    Stopwatch& m_clock;
-    beast::Journal m_journal;
+    // Entries are spread over shards by the hash of their address. A
+    // shard is locked only to add, expire or list its entries, and when a
+    // reference count goes to or from zero; charging is lock free.
+    struct Shard
+    {
+        std::mutex lock;
+
+        Table table;
 
-    std::recursive_mutex lock_;
+        EntryIntrusiveList inbound;
 
-    Table table_;
+        EntryIntrusiveList outbound;
 
+        EntryIntrusiveList admin;
 
-    EntryIntrusiveList inbound_;
+        EntryIntrusiveList inactive;
+    };
+
+    static std::size_t constexpr shardCount = 16;
+
+    Stats m_stats;
+    Stopwatch& m_clock;
+    beast::Journal m_journal;
 
-    EntryIntrusiveList outbound_;
+    Key::hasher hasher_;
 
-    EntryIntrusiveList admin_;
+    std::array <Shard, shardCount> shards_;
 
-    EntryIntrusiveList inactive_;
+    std::mutex importLock_;
 
     Imports importTable_;
 
@@ -72,97 +86,39 @@ public:
     ~Logic ()
     {
         importTable_.clear();
-        table_.clear();
+        for (auto& shard : shards_)
+            shard.table.clear();
     }
 
     Consumer newInboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindInbound, address.at_port (0)), 
-                    std::make_tuple (m_clock.now()));                   
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                {
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                }
-                inbound_.push_back (*entry);
-            }
-        }
+        Entry& entry (newEntry (kindInbound, address.at_port (0)));
 
         JLOG(m_journal.debug()) <<
-            "New inbound endpoint " << *entry;
+            "New inbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Consumer newOutboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindOutbound, address),            
-                    std::make_tuple (m_clock.now()));                   
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                outbound_.push_back (*entry);
-            }
-        }
+        Entry& entry (newEntry (kindOutbound, address));
 
         JLOG(m_journal.debug()) <<
-            "New outbound endpoint " << *entry;
+            "New outbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     
     Consumer newUnlimitedEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindUnlimited, address.at_port(1)),
-                    std::make_tuple (m_clock.now()));                   
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                admin_.push_back (*entry);
-            }
-        }
+        Entry& entry (newEntry (kindUnlimited, address.at_port (1)));
 
         JLOG(m_journal.debug()) <<
-            "New unlimited endpoint " << *entry;
+            "New unlimited endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Json::Value getJson ()
@@ -176,43 +132,29 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Json::Value ret (Json::objectValue);
-        std::lock_guard<std::recursive_mutex> _(lock_);
 
-        for (auto& inboundEntry : inbound_)
+        auto const add = [&](EntryIntrusiveList& list, char const* type)
         {
-            int localBalance = inboundEntry.local_balance.value (now);
-            if ((localBalance + inboundEntry.remote_balance) >= threshold)
+            for (auto& listEntry : list)
             {
-                Json::Value& entry = (ret[inboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = inboundEntry.remote_balance;
-                entry[jss::type] = "inbound";
-            }
-
-        }
-        for (auto& outboundEntry : outbound_)
-        {
-            int localBalance = outboundEntry.local_balance.value (now);
-            if ((localBalance + outboundEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[outboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = outboundEntry.remote_balance;
-                entry[jss::type] = "outbound";
+                int localBalance = listEntry.local_balance.value (now);
+                int remoteBalance = listEntry.remote_balance;
+                if ((localBalance + remoteBalance) >= threshold)
+                {
+                    Json::Value& entry = (ret[listEntry.to_string()] = Json::objectValue);
+                    entry[jss::local] = localBalance;
+                    entry[jss::remote] = remoteBalance;
+                    entry[jss::type] = type;
+                }
             }
+        };
 
-        }
-        for (auto& adminEntry : admin_)
+        for (auto& shard : shards_)
         {
-            int localBalance = adminEntry.local_balance.value (now);
-            if ((localBalance + adminEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[adminEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = adminEntry.remote_balance;
-                entry[jss::type] = "admin";
-            }
-
+            std::lock_guard<std::mutex> _(shard.lock);
+            add (shard.inbound, "inbound");
+            add (shard.outbound, "outbound");
+            add (shard.admin, "admin");
         }
 
         return ret;
@@ -223,18 +165,19 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Gossip gossip;
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
-        gossip.items.reserve (inbound_.size());
 
-        for (auto& inboundEntry : inbound_)
+        for (auto& shard : shards_)
         {
-            Gossip::Item item;
-            item.balance = inboundEntry.local_balance.value (now);
-            if (item.balance >= minimumGossipBalance)
+            std::lock_guard<std::mutex> _(shard.lock);
+            for (auto& inboundEntry : shard.inbound)
             {
-                item.address = inboundEntry.key->address;
-                gossip.items.push_back (item);
+                Gossip::Item item;
+                item.balance = inboundEntry.local_balance.value (now);
+                if (item.balance >= minimumGossipBalance)
+                {
+                    item.address = inboundEntry.key->address;
+                    gossip.items.push_back (item);
+                }
             }
         }
 
@@ -246,7 +189,7 @@ public:
     {
         auto const elapsed = m_clock.now();
         {
-            std::lock_guard<std::recursive_mutex> _(lock_);
+            std::lock_guard<std::mutex> _(importLock_);
             auto result =
                 importTable_.emplace (std::piecewise_construct,
                     std::make_tuple(origin),                  
@@ -296,26 +239,30 @@ public:
 
     void periodicActivity ()
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
         auto const elapsed = m_clock.now();
 
-        for (auto iter (inactive_.begin()); iter != inactive_.end();)
+        for (auto& shard : shards_)
         {
-            if (iter->whenExpires <= elapsed)
-            {
-                JLOG(m_journal.debug()) << "Expired " << *iter;
-                auto table_iter =
-                    table_.find (*iter->key);
-                ++iter;
-                erase (table_iter);
-            }
-            else
+            std::lock_guard<std::mutex> _(shard.lock);
+
+            for (auto iter (shard.inactive.begin()); iter != shard.inactive.end();)
             {
-                break;
+                if (iter->whenExpires <= elapsed)
+                {
+                    JLOG(m_journal.debug()) << "Expired " << *iter;
+                    auto table_iter =
+                        shard.table.find (*iter->key);
+                    ++iter;
+                    erase (shard, table_iter);
+                }
+                else
+                {
+                    break;
+                }
             }
         }
 
+        std::lock_guard<std::mutex> _(importLock_);
         auto iter = importTable_.begin();
         while (iter != importTable_.end())
         {
@@ -347,56 +294,42 @@ public:
         return Disposition::ok;
     }
 
-    void erase (Table::iterator iter)
-    {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-        Entry& entry (iter->second);
-        assert (entry.refcount == 0);
-        inactive_.erase (
-            inactive_.iterator_to (entry));
-        table_.erase (iter);
-    }
-
     void acquire (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-        ++entry.refcount;
+        // The caller holds a reference, so the count can't be going
+        // to or from zero and the entry stays on its list.
+        auto const previous = entry.refcount.fetch_add (1);
+        (void)previous;
+        assert (previous > 0);
     }
 
     void release (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        // Only the last reference needs the lock, to make the entry
+        // inactive without racing a new endpoint for the same address.
+        auto count = entry.refcount.load ();
+        while (count > 1)
+        {
+            if (entry.refcount.compare_exchange_weak (count, count - 1))
+                return;
+        }
+
+        Shard& shard (shardFor (*entry.key));
+        std::lock_guard<std::mutex> _(shard.lock);
         if (--entry.refcount == 0)
         {
             JLOG(m_journal.debug()) <<
                 "Inactive " << entry;
 
-            switch (entry.key->kind)
-            {
-            case kindInbound:
-                inbound_.erase (
-                    inbound_.iterator_to (entry));
-                break;
-            case kindOutbound:
-                outbound_.erase (
-                    outbound_.iterator_to (entry));
-                break;
-            case kindUnlimited:
-                admin_.erase (
-                    admin_.iterator_to (entry));
-                break;
-            default:
-                assert(false);
-                break;
-            }
-            inactive_.push_back (entry);
+            auto& list = active (shard, entry.key->kind);
+            list.erase (list.iterator_to (entry));
+            shard.inactive.push_back (entry);
             entry.whenExpires = m_clock.now() + secondsUntilExpiration;
         }
     }
 
     Disposition charge (Entry& entry, Charge const& fee)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.add (fee.cost(), now));
         JLOG(m_journal.trace()) <<
@@ -409,15 +342,18 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
         bool notify (false);
         auto const elapsed = m_clock.now();
-        if (entry.balance (m_clock.now()) >= warningThreshold &&
-            elapsed != entry.lastWarningTime)
+        if (entry.balance (elapsed) >= warningThreshold)
         {
-            charge (entry, feeWarning);
-            notify = true;
-            entry.lastWarningTime = elapsed;
+            // Warn at most once per tick, even from several threads
+            auto last = entry.lastWarningTime.load ();
+            if (last != elapsed &&
+                entry.lastWarningTime.compare_exchange_strong (last, elapsed))
+            {
+                charge (entry, feeWarning);
+                notify = true;
+            }
         }
         if (notify)
         {
@@ -432,7 +368,6 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
         bool drop (false);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.balance (now));
@@ -452,7 +387,6 @@ public:
 
     int balance (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
         return entry.balance (m_clock.now());
     }
 
@@ -465,12 +399,14 @@ public:
         for (auto& entry : list)
         {
             beast::PropertyStream::Map item (items);
-            if (entry.refcount != 0)
-                item ["count"] = entry.refcount;
+            int const count = entry.refcount;
+            if (count != 0)
+                item ["count"] = count;
             item ["name"] = entry.to_string();
             item ["balance"] = entry.balance(now);
-            if (entry.remote_balance != 0)
-                item ["remote_balance"] = entry.remote_balance;
+            int const remote = entry.remote_balance;
+            if (remote != 0)
+                item ["remote_balance"] = remote;
         }
     }
 
@@ -478,27 +414,75 @@ public:
     {
         clock_type::time_point const now (m_clock.now());
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
+        auto const write = [&](char const* name,
+            EntryIntrusiveList Shard::* list)
         {
-            beast::PropertyStream::Set s ("inbound", map);
-            writeList (now, s, inbound_);
-        }
+            beast::PropertyStream::Set s (name, map);
+            for (auto& shard : shards_)
+            {
+                std::lock_guard<std::mutex> _(shard.lock);
+                writeList (now, s, shard.*list);
+            }
+        };
 
-        {
-            beast::PropertyStream::Set s ("outbound", map);
-            writeList (now, s, outbound_);
-        }
+        write ("inbound", &Shard::inbound);
+        write ("outbound", &Shard::outbound);
+        write ("admin", &Shard::admin);
+        write ("inactive", &Shard::inactive);
+    }
 
+private:
+    Shard& shardFor (Key const& key)
+    {
+        return shards_[hasher_ (key) % shardCount];
+    }
+
+    EntryIntrusiveList& active (Shard& shard, Kind kind)
+    {
+        switch (kind)
         {
-            beast::PropertyStream::Set s ("admin", map);
-            writeList (now, s, admin_);
+        case kindInbound:
+            return shard.inbound;
+        case kindOutbound:
+            return shard.outbound;
+        case kindUnlimited:
+            return shard.admin;
+        default:
+            assert(false);
+            return shard.inbound;
         }
+    }
 
+    Entry& newEntry (Kind kind, beast::IP::Endpoint const& address)
+    {
+        Key const key (kind, address);
+        Shard& shard (shardFor (key));
+
+        std::lock_guard<std::mutex> _(shard.lock);
+        auto result =
+            shard.table.emplace (std::piecewise_construct,
+                std::make_tuple (key),
+                std::make_tuple (m_clock.now()));
+
+        Entry& entry (result.first->second);
+        entry.key = &result.first->first;
+        if (++entry.refcount == 1)
         {
-            beast::PropertyStream::Set s ("inactive", map);
-            writeList (now, s, inactive_);
+            if (! result.second)
+                shard.inactive.erase (
+                    shard.inactive.iterator_to (entry));
+            active (shard, kind).push_back (entry);
         }
+        return entry;
+    }
+
+    void erase (Shard& shard, Table::iterator iter)
+    {
+        Entry& entry (iter->second);
+        assert (entry.refcount == 0);
+        shard.inactive.erase (
+            shard.inactive.iterator_to (entry));
+        shard.table.erase (iter);
     }
 };
 
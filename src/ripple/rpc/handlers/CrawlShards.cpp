@@ -41,6 +41,9 @@ doCrawlShards(RPC::Context& context)
             jvResult[jss::public_key] = toBase58(
                 TokenType::NodePublic, context.app.nodeIdentity().first);
         jvResult[jss::complete_shards] = shardStore->getCompleteShards();
+        auto progress = shardStore->getProgress();
+        if (!progress.isNull())
+            jvResult[jss::shard_progress] = std::move(progress);
     }
 
     if (hops == 0)
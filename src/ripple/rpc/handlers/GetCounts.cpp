@@ -7,14 +7,18 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/UptimeClock.h>
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/json/json_value.h>
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/overlay/Overlay.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/handlers/GetCounts.h>
+#include <ripple/shamap/Family.h>
 
 namespace ripple {
 
@@ -41,6 +45,34 @@ textTime(std::string& text, UptimeClock::time_point& seconds,
         text += "s";
 }
 
+Json::Value getLatencyJson(Application& app)
+{
+    Json::Value ret(Json::objectValue);
+
+    ret[jss::node_fetch] =
+        app.getNodeStore().getFetchLatency().snapshot().getJson();
+    ret[jss::node_store] =
+        app.getNodeStore().getStoreLatency().snapshot().getJson();
+    ret[jss::shamap_fetch] =
+        app.family().fetchLatency().snapshot().getJson();
+
+    if (auto shardStore = app.getShardStore())
+    {
+        Json::Value& jv = (ret[jss::shards] = Json::objectValue);
+        jv[jss::node_fetch] =
+            shardStore->getFetchLatency().snapshot().getJson();
+        jv[jss::node_store] =
+            shardStore->getStoreLatency().snapshot().getJson();
+        jv[jss::shamap_fetch] =
+            app.shardFamily()->fetchLatency().snapshot().getJson();
+    }
+
+    ret[jss::jobs] = app.getJobQueue().getLatencyJson();
+    ret[jss::peer_messages] = app.overlay().messageLatencyJson();
+
+    return ret;
+}
+
 Json::Value getCountsJson(Application& app, int minObjectCount)
 {
     auto objectCounts = CountedObjects::getInstance().getCounts(minObjectCount);
@@ -78,6 +110,10 @@ Json::Value getCountsJson(Application& app, int minObjectCount)
     ret[jss::historical_perminute] = static_cast<int>(
         app.getInboundLedgers().fetchRate());
     ret[jss::SLE_hit_rate] = app.cachedSLEs().rate();
+    ret[jss::SLE_cache_size] = std::to_string(app.cachedSLEs().size());
+    ret[jss::SLE_reads_hit] = std::to_string(app.cachedSLEs().hits());
+    ret[jss::SLE_reads_total] = std::to_string(
+        app.cachedSLEs().hits() + app.cachedSLEs().misses());
     ret[jss::node_hit_rate] = app.getNodeStore ().getCacheHitRate ();
     ret[jss::ledger_hit_rate] = app.getLedgerMaster ().getCacheHitRate ();
     ret[jss::AL_hit_rate] = app.getAcceptedLedgerCache ().getHitRate ();
@@ -120,6 +156,8 @@ Json::Value getCountsJson(Application& app, int minObjectCount)
         jv[jss::node_read_bytes] = shardStore->getFetchSize();
     }
 
+    ret[jss::latency] = getLatencyJson(app);
+
     return ret;
 }
 
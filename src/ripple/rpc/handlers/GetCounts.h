@@ -10,6 +10,11 @@ namespace ripple {
 
 Json::Value getCountsJson(Application& app, int minObjectCount);
 
+/** Percentiles of the time spent in node store reads and writes, SHAMap
+    node fetches, jobs and peer messages.
+*/
+Json::Value getLatencyJson(Application& app);
+
 }
 
 #endif
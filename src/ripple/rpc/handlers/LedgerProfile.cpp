@@ -0,0 +1,28 @@
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/CloseProfiler.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+#include <limits>
+
+namespace ripple {
+
+// {
+//   limit: <number of most recent closes>  // optional
+// }
+Json::Value doLedgerProfile (RPC::Context& context)
+{
+    auto limit = std::numeric_limits<std::size_t>::max ();
+    if (context.params.isMember (jss::limit))
+    {
+        auto const& v = context.params[jss::limit];
+        if (! (v.isUInt () || (v.isInt () && v.asInt () >= 0)))
+            return RPC::expected_field_error (jss::limit, "unsigned integer");
+        limit = v.asUInt ();
+    }
+
+    return context.app.getCloseProfiler ().getJson (limit);
+}
+
+}
@@ -47,6 +47,16 @@ isStatusRequest(
         request.method() == boost::beast::http::verb::get;
 }
 
+static
+bool
+isMetricsRequest(
+    http_request_type const& request)
+{
+    return
+        request.target() == "/metrics" &&
+        request.method() == boost::beast::http::verb::get;
+}
+
 static
 Handoff
 statusRequestResponse(
@@ -100,8 +110,13 @@ ServerHandlerImp::ServerHandlerImp (Application& app, Stoppable& parent,
     , m_journal (app_.journal("Server"))
     , m_networkOPs (networkOPs)
     , m_server (make_Server(
-        *this, io_service, app_.journal("Server")))
+        *this, io_service, app_.journal("Server"),
+        [&app]() -> boost::asio::io_service&
+        {
+            return app.getIOShard();
+        }))
     , m_jobQueue (jobQueue)
+    , m_collectorManager (cm)
 {
     auto const& group (cm.group ("rpc"));
     rpc_requests_ = group->make_counter ("requests");
@@ -200,6 +215,10 @@ ServerHandlerImp::onHandoff(
         return app_.overlay().onHandoff(std::move(bundle),
             std::move(request), remote_address);
 
+    if ((is_ws || p.count("http") > 0 || p.count("https") > 0) &&
+            isMetricsRequest(request))
+        return metricsResponse(session.port(), request, remote_address);
+
     if (is_ws && isStatusRequest(request))
         return statusResponse(request);
 
@@ -858,6 +877,41 @@ ServerHandlerImp::statusResponse(
     return handoff;
 }
 
+Handoff
+ServerHandlerImp::metricsResponse(Port const& port,
+    http_request_type const& request,
+    boost::asio::ip::tcp::endpoint const& remote_address) const
+{
+    using namespace boost::beast::http;
+    Handoff handoff;
+    response<string_body> msg;
+    boost::optional<std::string> text;
+    if (! ipAllowed(
+            beast::IPAddressConversion::from_asio(remote_address).address(),
+            port.admin_ip))
+    {
+        msg.result(status::forbidden);
+        msg.body() = "Forbidden";
+    }
+    else if (! (text = m_collectorManager.prometheus()))
+    {
+        msg.result(status::not_found);
+        msg.body() = "Metrics are only kept by the aggregated collector";
+    }
+    else
+    {
+        msg.result(status::ok);
+        msg.body() = std::move(*text);
+    }
+    msg.version(request.version());
+    msg.insert("Server", BuildInfo::getFullVersionString());
+    msg.insert("Content-Type", "text/plain; version=0.0.4");
+    msg.insert("Connection", "close");
+    msg.prepare_payload();
+    handoff.response = std::make_shared<SimpleWriter>(msg);
+    return handoff;
+}
+
 
 void
 ServerHandler::Setup::makeContexts()
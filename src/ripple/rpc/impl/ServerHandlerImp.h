@@ -72,6 +72,7 @@ private:
     std::unique_ptr<Server> m_server;
     Setup setup_;
     JobQueue& m_jobQueue;
+    CollectorManager& m_collectorManager;
     beast::insight::Counter rpc_requests_;
     beast::insight::Event rpc_size_;
     beast::insight::Event rpc_time_;
@@ -159,6 +160,10 @@ private:
 
     Handoff
     statusResponse(http_request_type const& request) const;
+
+    Handoff
+    metricsResponse(Port const& port, http_request_type const& request,
+        boost::asio::ip::tcp::endpoint const& remote_address) const;
 };
 
 }
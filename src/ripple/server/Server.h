@@ -15,10 +15,11 @@ namespace ripple {
 template<class Handler>
 std::unique_ptr<Server>
 make_Server(Handler& handler,
-    boost::asio::io_service& io_service, beast::Journal journal)
+    boost::asio::io_service& io_service, beast::Journal journal,
+        IOSelector select = {})
 {
     return std::make_unique<ServerImpl<Handler>>(
-        handler, io_service, journal);
+        handler, io_service, journal, std::move(select));
 }
 
 } 
@@ -76,12 +76,14 @@ private:
     boost::asio::io_context& ioc_;
     acceptor_type acceptor_;
     boost::asio::io_context::strand strand_;
+    std::function<boost::asio::io_context& ()> select_;
     bool ssl_;
     bool plain_;
 
 public:
     Door(Handler& handler, boost::asio::io_context& io_context,
-        Port const& port, beast::Journal j);
+        Port const& port, beast::Journal j,
+            std::function<boost::asio::io_context& ()> select = {});
 
     void run();
 
@@ -96,7 +98,8 @@ public:
 private:
     template <class ConstBufferSequence>
     void create (bool ssl, ConstBufferSequence const& buffers,
-        socket_type&& socket, endpoint_type remote_address);
+        boost::asio::io_context& ioc, socket_type&& socket,
+            endpoint_type remote_address);
 
     void do_accept (yield_context yield);
 };
@@ -231,13 +234,15 @@ do_detect(boost::asio::yield_context do_yield)
 template<class Handler>
 Door<Handler>::
 Door(Handler& handler, boost::asio::io_context& io_context,
-        Port const& port, beast::Journal j)
+        Port const& port, beast::Journal j,
+            std::function<boost::asio::io_context& ()> select)
     : j_(j)
     , port_(port)
     , handler_(handler)
     , ioc_(io_context)
     , acceptor_(io_context)
     , strand_(io_context)
+    , select_(std::move(select))
     , ssl_(
         port_.protocol.count("https") > 0 ||
         port_.protocol.count("wss") > 0 ||
@@ -316,18 +321,19 @@ template<class ConstBufferSequence>
 void
 Door<Handler>::
 create(bool ssl, ConstBufferSequence const& buffers,
-    socket_type&& socket, endpoint_type remote_address)
+    boost::asio::io_context& ioc, socket_type&& socket,
+        endpoint_type remote_address)
 {
     if (ssl)
     {
         if (auto sp = ios().template emplace<SSLHTTPPeer<Handler>>(
-             port_, handler_, ioc_, j_, remote_address,
+             port_, handler_, ioc, j_, remote_address,
                  buffers, std::move(socket)))
             sp->run();
         return;
     }
     if (auto sp = ios().template emplace<PlainHTTPPeer<Handler>>(
-         port_, handler_, ioc_, j_, remote_address,
+         port_, handler_, ioc, j_, remote_address,
              buffers, std::move(socket)))
         sp->run();
 }
@@ -341,7 +347,10 @@ do_accept(boost::asio::yield_context do_yield)
     {
         error_code ec;
         endpoint_type remote_address;
-        socket_type socket (ioc_);
+
+        // The connection, and every session it becomes, runs here
+        auto& ioc = select_ ? select_() : ioc_;
+        socket_type socket (ioc);
         acceptor_.async_accept (socket, remote_address, do_yield[ec]);
         if (ec && ec != boost::asio::error::operation_aborted)
         {
@@ -356,14 +365,14 @@ do_accept(boost::asio::yield_context do_yield)
         if (ssl_ && plain_)
         {
             if (auto sp = ios().template emplace<Detector>(
-                 port_, handler_, ioc_, std::move(socket),
+                 port_, handler_, ioc, std::move(socket),
                      remote_address, j_))
                 sp->run();
         }
         else if (ssl_ || plain_)
         {
             create(ssl_, boost::asio::null_buffers{},
-                std::move(socket), remote_address);
+                ioc, std::move(socket), remote_address);
         }
     }
 }
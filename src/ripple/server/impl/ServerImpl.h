@@ -12,12 +12,16 @@
 #include <boost/optional.hpp>
 #include <array>
 #include <chrono>
+#include <functional>
 #include <mutex>
 
 namespace ripple {
 
 using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;
 
+/** Chooses the io_service an accepted connection runs on. */
+using IOSelector = std::function<boost::asio::io_service& ()>;
+
 
 class Server
 {
@@ -58,6 +62,7 @@ private:
     boost::asio::io_service& io_service_;
     boost::asio::io_service::strand strand_;
     boost::optional <boost::asio::io_service::work> work_;
+    IOSelector select_;
 
     std::mutex m_;
     std::vector<Port> ports_;
@@ -69,7 +74,8 @@ private:
 
 public:
     ServerImpl(Handler& handler,
-        boost::asio::io_service& io_service, beast::Journal journal);
+        boost::asio::io_service& io_service, beast::Journal journal,
+            IOSelector select = {});
 
     ~ServerImpl();
 
@@ -109,12 +115,14 @@ private:
 template<class Handler>
 ServerImpl<Handler>::
 ServerImpl(Handler& handler,
-        boost::asio::io_service& io_service, beast::Journal journal)
+        boost::asio::io_service& io_service, beast::Journal journal,
+            IOSelector select)
     : handler_(handler)
     , j_(journal)
     , io_service_(io_service)
     , strand_(io_service_)
     , work_(io_service_)
+    , select_(std::move(select))
 {
 }
 
@@ -141,7 +149,7 @@ ports (std::vector<Port> const& ports)
     {
         ports_.push_back(port);
         if(auto sp = ios_.emplace<Door<Handler>>(handler_,
-            io_service_, ports_.back(), j_))
+            io_service_, ports_.back(), j_, select_))
         {
             list_.push_back(sp);
             eps.push_back(sp->get_endpoint());
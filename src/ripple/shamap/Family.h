@@ -3,6 +3,7 @@
 #ifndef RIPPLE_SHAMAP_FAMILY_H_INCLUDED
 #define RIPPLE_SHAMAP_FAMILY_H_INCLUDED
 
+#include <ripple/basics/LatencyHistogram.h>
 #include <ripple/basics/Log.h>
 #include <ripple/shamap/FullBelowCache.h>
 #include <ripple/shamap/TreeNodeCache.h>
@@ -49,6 +50,11 @@ public:
     bool
     isShardBacked() const = 0;
 
+    /** Time spent reading tree nodes missing from the cache. */
+    virtual
+    LatencyHistogram&
+    fetchLatency() = 0;
+
     virtual
     void
     missing_node (std::uint32_t refNum) = 0;
@@ -68,6 +68,13 @@ public:
                                 std::shared_ptr<SHAMapItem const>>;
     using Delta     = std::map<uint256, DeltaItem>;
 
+    /** Receives one differing leaf: its key, this map's item and the other
+        map's item (either may be null). Return false to stop the walk.
+    */
+    using DeltaVisitor = std::function<bool (uint256 const& key,
+        std::shared_ptr<SHAMapItem const> const& ours,
+        std::shared_ptr<SHAMapItem const> const& other)>;
+
     ~SHAMap ();
     SHAMap(SHAMap const&) = delete;
     SHAMap& operator=(SHAMap const&) = delete;
@@ -136,13 +143,21 @@ public:
         SHAMapAbstractNode&)> const& function) const;
 
     
+    /** Visit every node not present in have. With more than one thread
+        and immutable maps the subtrees below the root are walked
+        concurrently, so the function must be thread safe.
+    */
     void visitDifferences(SHAMap const* have,
-        std::function<bool (SHAMapAbstractNode&)>) const;
+        std::function<bool (SHAMapAbstractNode&)>, int threads = 1) const;
 
     
     void visitLeaves(std::function<void (
         std::shared_ptr<SHAMapItem const> const&)> const&) const;
 
+    /** Visit the inner nodes in the top levels of the tree, breadth first. */
+    void visitInnerNodes (int levels,
+        std::function<void (SHAMapAbstractNode&)> const& function) const;
+
 
     
     std::vector<std::pair<SHAMapNodeID, uint256>>
@@ -170,7 +185,35 @@ public:
     bool compare (SHAMap const& otherMap,
                   Delta& differences, int maxCount) const;
 
+    /** Visit every leaf that differs between this map and another.
+
+        Missing nodes are prefetched from the node store a tree level at a
+        time. When both maps are immutable and threads is greater than one,
+        differing subtrees are walked concurrently and the visitor may be
+        called from several threads at once.
+
+        @return false if the visitor stopped the walk.
+    */
+    bool visitDelta (SHAMap const& otherMap,
+        DeltaVisitor const& visitor, int threads = 1) const;
+
     int flushDirty (NodeObjectType t, std::uint32_t seq);
+
+    /** Hash, share and cache the dirty nodes like flushDirty, without
+        writing them.
+
+        The nodes flushDirty would have written are put in the tree node
+        cache and added to `dirty`, so they can be written later by
+        writeNodes. Until then they are not in the node store.
+    */
+    int unshare (std::vector<std::shared_ptr<SHAMapAbstractNode>>& dirty);
+
+    /** Store nodes left dirty by unshare in the node store.
+        May be called from any thread while the map is read.
+    */
+    void writeNodes (NodeObjectType t,
+        std::vector<std::shared_ptr<SHAMapAbstractNode>> const& nodes) const;
+
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
     bool deepCompare (SHAMap & other) const;  
 
@@ -232,6 +275,9 @@ private:
     std::shared_ptr<SHAMapAbstractNode>
         writeNode(NodeObjectType t, std::uint32_t seq,
                   std::shared_ptr<SHAMapAbstractNode> node) const;
+    std::shared_ptr<SHAMapAbstractNode>
+        cacheNode(std::shared_ptr<SHAMapAbstractNode> node,
+                  std::vector<std::shared_ptr<SHAMapAbstractNode>>& dirty) const;
 
     SHAMapTreeNode* firstBelow (std::shared_ptr<SHAMapAbstractNode>,
                                 SharedPtrNodeStack& stack, int branch = 0) const;
@@ -261,8 +307,18 @@ private:
     SHAMapTreeNode const* peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const;
     bool walkBranch (SHAMapAbstractNode* node,
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
-                     bool isFirstMap, Delta & differences, int & maxCount) const;
-    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+                     bool isFirstMap, DeltaVisitor const& visitor) const;
+
+    using DeltaBranch = std::tuple<SHAMapInnerNode*, SHAMapInnerNode*, int>;
+
+    bool deltaNodes (SHAMapAbstractNode* ourNode, SHAMap const& otherMap,
+        SHAMapAbstractNode* otherNode, DeltaVisitor const& visitor,
+        std::vector<DeltaBranch>& branches) const;
+    std::vector<std::pair<SHAMapAbstractNode*, SHAMapAbstractNode*>>
+        resolveBranches (SHAMap const& otherMap,
+            std::vector<DeltaBranch> const& branches) const;
+    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        std::vector<std::shared_ptr<SHAMapAbstractNode>>* dirty = nullptr);
     bool isInconsistentNode(std::shared_ptr<SHAMapAbstractNode> const& node) const;
 
     struct MissingNodes
@@ -0,0 +1,59 @@
+#ifndef RIPPLE_SHAMAP_TREENODESNAPSHOT_H_INCLUDED
+#define RIPPLE_SHAMAP_TREENODESNAPSHOT_H_INCLUDED
+
+#include <ripple/shamap/Family.h>
+#include <ripple/beast/utility/Journal.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cstddef>
+
+namespace ripple {
+
+class Section;
+class SHAMap;
+
+/** Warm-start snapshot of the tree node cache.
+
+    The snapshot holds the serialized inner nodes at the top of the last
+    validated state map plus the most recently used inner nodes in the
+    TreeNodeCache. The file is a flat sequence of fixed-size headers and
+    node blobs so it can be mapped and walked without parsing.
+
+    Only the tree node cache is warmed. Whether a subtree is complete in
+    the node store is never restored, since the store may have changed
+    since the snapshot was written.
+*/
+struct TreeNodeSnapshotSetup
+{
+    // Empty disables snapshots
+    boost::filesystem::path path;
+
+    // Most nodes written to the snapshot
+    std::size_t maxNodes = 262144;
+
+    // Levels of the validated state map always included
+    int levels = 3;
+
+    // Seconds between periodic snapshots, zero for shutdown only
+    std::chrono::seconds interval {0};
+};
+
+TreeNodeSnapshotSetup
+setup_TreeNodeSnapshot (Section const& section,
+    boost::filesystem::path const& dataDir);
+
+/** Write a snapshot. Returns the number of nodes written. */
+std::size_t
+saveTreeNodeSnapshot (TreeNodeSnapshotSetup const& setup,
+    Family& family, SHAMap const* stateMap, beast::Journal j);
+
+/** Load a snapshot into the tree node cache. Returns the number of
+    nodes loaded.
+*/
+std::size_t
+loadTreeNodeSnapshot (TreeNodeSnapshotSetup const& setup,
+    Family& family, beast::Journal j);
+
+}
+
+#endif
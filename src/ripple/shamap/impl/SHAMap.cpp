@@ -1,5 +1,6 @@
 
 
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/contract.h>
 #include <ripple/shamap/SHAMap.h>
 
@@ -301,7 +302,9 @@ std::shared_ptr<SHAMapAbstractNode> SHAMap::fetchNodeNT(
 
     if (backed_)
     {
+        auto const start = std::chrono::steady_clock::now ();
         node = fetchNodeFromDB (hash);
+        f_.fetchLatency ().insert (std::chrono::steady_clock::now () - start);
         if (node)
         {
             canonicalize (hash, node);
@@ -320,7 +323,11 @@ std::shared_ptr<SHAMapAbstractNode> SHAMap::fetchNodeNT (SHAMapHash const& hash)
     auto node = getCache (hash);
 
     if (!node && backed_)
+    {
+        auto const start = std::chrono::steady_clock::now ();
         node = fetchNodeFromDB (hash);
+        f_.fetchLatency ().insert (std::chrono::steady_clock::now () - start);
+    }
 
     return node;
 }
@@ -1058,6 +1065,19 @@ SHAMap::writeNode (
     return node;
 }
 
+std::shared_ptr<SHAMapAbstractNode>
+SHAMap::cacheNode (std::shared_ptr<SHAMapAbstractNode> node,
+    std::vector<std::shared_ptr<SHAMapAbstractNode>>& dirty) const
+{
+    assert (node->getSeq() == seq_);
+    assert (backed_);
+    node->setSeq (0);
+
+    canonicalize (node->getNodeHash(), node);
+    dirty.push_back (node);
+    return node;
+}
+
 template <class Node>
 std::shared_ptr<Node>
 SHAMap::preFlushNode (std::shared_ptr<Node> node) const
@@ -1079,11 +1099,37 @@ int SHAMap::unshare ()
 
 int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
 {
-    return walkSubTree (true, t, seq);
+    auto const flushed = walkSubTree (true, t, seq);
+    if (backed_)
+        perf::workCounters().nodesWritten += flushed;
+    return flushed;
+}
+
+int
+SHAMap::unshare (std::vector<std::shared_ptr<SHAMapAbstractNode>>& dirty)
+{
+    return walkSubTree (false, hotUNKNOWN, 0, backed_ ? &dirty : nullptr);
+}
+
+void
+SHAMap::writeNodes (NodeObjectType t,
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> const& nodes) const
+{
+    for (auto const& node : nodes)
+    {
+        assert (node->getSeq() == 0);
+
+        Serializer s;
+        node->addRaw (s, snfPREFIX);
+        f_.db().store (t, std::move (s.modData ()),
+            node->getNodeHash ().as_uint256(), ledgerSeq_);
+    }
+    perf::workCounters().nodesWritten += nodes.size();
 }
 
 int
-SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
+SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    std::vector<std::shared_ptr<SHAMapAbstractNode>>* dirty)
 {
     int flushed = 0;
     Serializer s;
@@ -1097,6 +1143,8 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         root_->updateHash();
         if (doWrite && backed_)
             root_ = writeNode(t, seq, std::move(root_));
+        else if (dirty)
+            root_ = cacheNode(std::move(root_), *dirty);
         else
             root_->setSeq (0);
         return 1;
@@ -1155,6 +1203,8 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 
                         if (doWrite && backed_)
                             child = writeNode(t, seq, std::move(child));
+                        else if (dirty)
+                            child = cacheNode(std::move(child), *dirty);
                         else
                             child->setSeq (0);
 
@@ -1169,6 +1219,9 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         if (doWrite && backed_)
             node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
                                                                        std::move(node)));
+        else if (dirty)
+            node = std::static_pointer_cast<SHAMapInnerNode>(cacheNode(
+                std::move(node), *dirty));
         else
             node->setSeq (0);
 
@@ -1,15 +1,29 @@
 
 
 #include <ripple/basics/contract.h>
+#include <ripple/basics/ParallelFor.h>
 #include <ripple/shamap/SHAMap.h>
+#include <algorithm>
+#include <atomic>
 
 namespace ripple {
 
 
 bool SHAMap::walkBranch (SHAMapAbstractNode* node,
                          std::shared_ptr<SHAMapItem const> const& otherMapItem,
-                         bool isFirstMap,Delta& differences, int& maxCount) const
+                         bool isFirstMap, DeltaVisitor const& visitor) const
 {
+    static std::shared_ptr<SHAMapItem const> const none;
+
+    auto emit = [&](std::shared_ptr<SHAMapItem const> const& ours,
+        std::shared_ptr<SHAMapItem const> const& other)
+    {
+        auto const& key = ours ? ours->key() : other->key();
+        if (isFirstMap)
+            return visitor (key, ours, other);
+        return visitor (key, other, ours);
+    };
+
     std::stack <SHAMapAbstractNode*, std::vector<SHAMapAbstractNode*>> nodeStack;
     nodeStack.push (node);
 
@@ -29,30 +43,16 @@ bool SHAMap::walkBranch (SHAMapAbstractNode* node,
         }
         else
         {
-            auto item = static_cast<SHAMapTreeNode*>(node)->peekItem();
+            auto const& item = static_cast<SHAMapTreeNode*>(node)->peekItem();
 
             if (emptyBranch || (item->key() != otherMapItem->key()))
             {
-                if (isFirstMap)
-                    differences.insert (std::make_pair (item->key(),
-                        DeltaRef (item, std::shared_ptr<SHAMapItem const> ())));
-                else
-                    differences.insert (std::make_pair (item->key(),
-                        DeltaRef (std::shared_ptr<SHAMapItem const> (), item)));
-
-                if (--maxCount <= 0)
+                if (!emit (item, none))
                     return false;
             }
             else if (item->peekData () != otherMapItem->peekData ())
             {
-                if (isFirstMap)
-                    differences.insert (std::make_pair (item->key(),
-                                                DeltaRef (item, otherMapItem)));
-                else
-                    differences.insert (std::make_pair (item->key(),
-                                                DeltaRef (otherMapItem, item)));
-
-                if (--maxCount <= 0)
+                if (!emit (item, otherMapItem))
                     return false;
 
                 emptyBranch = true;
@@ -65,18 +65,7 @@ bool SHAMap::walkBranch (SHAMapAbstractNode* node,
     }
 
     if (!emptyBranch)
-    {
-        if (isFirstMap) 
-            differences.insert(std::make_pair(otherMapItem->key(),
-                                              DeltaRef(std::shared_ptr<SHAMapItem const>(),
-                                                       otherMapItem)));
-        else
-            differences.insert(std::make_pair(otherMapItem->key(),
-                DeltaRef(otherMapItem, std::shared_ptr<SHAMapItem const>())));
-
-        if (--maxCount <= 0)
-            return false;
-    }
+        return emit (none, otherMapItem);
 
     return true;
 }
@@ -85,107 +74,178 @@ bool
 SHAMap::compare (SHAMap const& otherMap,
                  Delta& differences, int maxCount) const
 {
+    return visitDelta (otherMap,
+        [&differences, &maxCount](uint256 const& key,
+            std::shared_ptr<SHAMapItem const> const& ours,
+            std::shared_ptr<SHAMapItem const> const& other)
+        {
+            differences.insert (std::make_pair (key, DeltaRef (ours, other)));
+            return --maxCount > 0;
+        });
+}
 
-    assert (isValid () && otherMap.isValid ());
-
-    if (getHash () == otherMap.getHash ())
-        return true;
-
-    using StackEntry = std::pair <SHAMapAbstractNode*, SHAMapAbstractNode*>;
-    std::stack <StackEntry, std::vector<StackEntry>> nodeStack; 
+bool
+SHAMap::deltaNodes (SHAMapAbstractNode* ourNode, SHAMap const& otherMap,
+    SHAMapAbstractNode* otherNode, DeltaVisitor const& visitor,
+    std::vector<DeltaBranch>& branches) const
+{
+    static std::shared_ptr<SHAMapItem const> const none;
 
-    nodeStack.push ({root_.get(), otherMap.root_.get()});
-    while (!nodeStack.empty ())
+    if (!ourNode || !otherNode)
     {
-        SHAMapAbstractNode* ourNode = nodeStack.top().first;
-        SHAMapAbstractNode* otherNode = nodeStack.top().second;
-        nodeStack.pop ();
+        assert (false);
+        Throw<SHAMapMissingNode> (type_, uint256 ());
+    }
 
-        if (!ourNode || !otherNode)
+    if (ourNode->isLeaf () && otherNode->isLeaf ())
+    {
+        auto const& ours = static_cast<SHAMapTreeNode*>(ourNode)->peekItem();
+        auto const& other = static_cast<SHAMapTreeNode*>(otherNode)->peekItem();
+        if (ours->key() == other->key())
         {
-            assert (false);
-            Throw<SHAMapMissingNode> (type_, uint256 ());
+            if (ours->peekData () != other->peekData ())
+                return visitor (ours->key(), ours, other);
+            return true;
         }
+        return visitor (ours->key(), ours, none) &&
+            visitor (other->key(), none, other);
+    }
 
-        if (ourNode->isLeaf () && otherNode->isLeaf ())
-        {
-            auto ours = static_cast<SHAMapTreeNode*>(ourNode);
-            auto other = static_cast<SHAMapTreeNode*>(otherNode);
-            if (ours->peekItem()->key() == other->peekItem()->key())
-            {
-                if (ours->peekItem()->peekData () != other->peekItem()->peekData ())
-                {
-                    differences.insert (std::make_pair (ours->peekItem()->key(),
-                                                 DeltaRef (ours->peekItem (),
-                                                 other->peekItem ())));
-                    if (--maxCount <= 0)
-                        return false;
-                }
-            }
-            else
-            {
-                differences.insert (std::make_pair(ours->peekItem()->key(),
-                                                   DeltaRef(ours->peekItem(),
-                                                   std::shared_ptr<SHAMapItem const>())));
-                if (--maxCount <= 0)
-                    return false;
+    if (ourNode->isInner () && otherNode->isLeaf ())
+    {
+        return walkBranch (ourNode,
+            static_cast<SHAMapTreeNode*>(otherNode)->peekItem (),
+            true, visitor);
+    }
 
-                differences.insert(std::make_pair(other->peekItem()->key(),
-                    DeltaRef(std::shared_ptr<SHAMapItem const>(), other->peekItem ())));
-                if (--maxCount <= 0)
-                    return false;
-            }
-        }
-        else if (ourNode->isInner () && otherNode->isLeaf ())
+    if (ourNode->isLeaf () && otherNode->isInner ())
+    {
+        return otherMap.walkBranch (otherNode,
+            static_cast<SHAMapTreeNode*>(ourNode)->peekItem (),
+            false, visitor);
+    }
+
+    auto ours = static_cast<SHAMapInnerNode*>(ourNode);
+    auto other = static_cast<SHAMapInnerNode*>(otherNode);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (ours->getChildHash (i) == other->getChildHash (i))
+            continue;
+
+        if (other->isEmptyBranch (i))
         {
-            auto ours = static_cast<SHAMapInnerNode*>(ourNode);
-            auto other = static_cast<SHAMapTreeNode*>(otherNode);
-            if (!walkBranch (ours, other->peekItem (),
-                    true, differences, maxCount))
+            if (!walkBranch (descendThrow (ours, i), none, true, visitor))
                 return false;
         }
-        else if (ourNode->isLeaf () && otherNode->isInner ())
+        else if (ours->isEmptyBranch (i))
         {
-            auto ours = static_cast<SHAMapTreeNode*>(ourNode);
-            auto other = static_cast<SHAMapInnerNode*>(otherNode);
-            if (!otherMap.walkBranch (other, ours->peekItem (),
-                                       false, differences, maxCount))
+            if (!otherMap.walkBranch (otherMap.descendThrow (other, i),
+                    none, false, visitor))
                 return false;
         }
-        else if (ourNode->isInner () && otherNode->isInner ())
+        else
+            branches.push_back (std::make_tuple (ours, other, i));
+    }
+    return true;
+}
+
+std::vector<std::pair<SHAMapAbstractNode*, SHAMapAbstractNode*>>
+SHAMap::resolveBranches (SHAMap const& otherMap,
+    std::vector<DeltaBranch> const& branches) const
+{
+    // Issue reads for every child we do not already hold so that the node
+    // store can service them as one batch, then descend for real.
+    bool pending = false;
+    for (auto const& b : branches)
+    {
+        bool p;
+        descendAsync (std::get<0>(b), std::get<2>(b), nullptr, p);
+        pending = pending || p;
+        otherMap.descendAsync (std::get<1>(b), std::get<2>(b), nullptr, p);
+        pending = pending || p;
+    }
+
+    if (pending)
+        f_.db().waitReads ();
+
+    std::vector<std::pair<SHAMapAbstractNode*, SHAMapAbstractNode*>> nodes;
+    nodes.reserve (branches.size ());
+    for (auto const& b : branches)
+        nodes.emplace_back (descendThrow (std::get<0>(b), std::get<2>(b)),
+            otherMap.descendThrow (std::get<1>(b), std::get<2>(b)));
+    return nodes;
+}
+
+bool
+SHAMap::visitDelta (SHAMap const& otherMap,
+    DeltaVisitor const& visitor, int threads) const
+{
+    assert (isValid () && otherMap.isValid ());
+
+    if (getHash () == otherMap.getHash ())
+        return true;
+
+    // Concurrent descent is only safe when neither tree can change
+    if (state_ != SHAMapState::Immutable ||
+        otherMap.state_ != SHAMapState::Immutable)
+    {
+        threads = 1;
+    }
+    threads = std::max (threads, 1);
+
+    std::atomic<bool> stopped {false};
+    DeltaVisitor const emit = [&stopped, &visitor](uint256 const& key,
+        std::shared_ptr<SHAMapItem const> const& ours,
+        std::shared_ptr<SHAMapItem const> const& other)
+    {
+        if (stopped.load (std::memory_order_relaxed) ||
+            !visitor (key, ours, other))
         {
-            auto ours = static_cast<SHAMapInnerNode*>(ourNode);
-            auto other = static_cast<SHAMapInnerNode*>(otherNode);
-            for (int i = 0; i < 16; ++i)
-                if (ours->getChildHash (i) != other->getChildHash (i))
-                {
-                    if (other->isEmptyBranch (i))
-                    {
-                        SHAMapAbstractNode* iNode = descendThrow (ours, i);
-                        if (!walkBranch (iNode,
-                                         std::shared_ptr<SHAMapItem const> (), true,
-                                         differences, maxCount))
-                            return false;
-                    }
-                    else if (ours->isEmptyBranch (i))
-                    {
-                        SHAMapAbstractNode* iNode =
-                            otherMap.descendThrow(other, i);
-                        if (!otherMap.walkBranch (iNode,
-                                                   std::shared_ptr<SHAMapItem const>(),
-                                                   false, differences, maxCount))
-                            return false;
-                    }
-                    else 
-                        nodeStack.push ({descendThrow (ours, i),
-                                        otherMap.descendThrow (other, i)});
-                }
+            stopped = true;
+            return false;
         }
-        else
-            assert (false);
+        return true;
+    };
+
+    // Walk the differing subtrees one level at a time so the node fetches
+    // for a whole level can be prefetched together.
+    auto walk = [this, &otherMap, &emit](std::vector<DeltaBranch> branches)
+    {
+        while (!branches.empty ())
+        {
+            auto const nodes = resolveBranches (otherMap, branches);
+            branches.clear ();
+            for (auto const& n : nodes)
+                if (!deltaNodes (n.first, otherMap, n.second, emit, branches))
+                    return false;
+        }
+        return true;
+    };
+
+    std::vector<DeltaBranch> branches;
+    if (!deltaNodes (root_.get(), otherMap, otherMap.root_.get(),
+            emit, branches))
+        return false;
+
+    if (threads == 1)
+        return walk (std::move (branches));
+
+    // Expand one more level so there is enough work to spread around
+    {
+        auto const nodes = resolveBranches (otherMap, branches);
+        branches.clear ();
+        for (auto const& n : nodes)
+            if (!deltaNodes (n.first, otherMap, n.second, emit, branches))
+                return false;
     }
 
-    return true;
+    parallelFor (branches.size (), threads,
+        [&](std::size_t i)
+        {
+            return walk ({branches[i]});
+        });
+
+    return !stopped;
 }
 
 void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const
@@ -1,8 +1,10 @@
 
 
+#include <ripple/basics/ParallelFor.h>
 #include <ripple/basics/random.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/nodestore/Database.h>
+#include <atomic>
 
 namespace ripple {
 
@@ -80,9 +82,44 @@ SHAMap::visitNodes(std::function<bool (
     }
 }
 
+void
+SHAMap::visitInnerNodes (int levels,
+    std::function<void (SHAMapAbstractNode&)> const& function) const
+{
+    if (! root_ || ! root_->isInner ())
+        return;
+
+    using NodeList = std::vector<std::shared_ptr<SHAMapInnerNode>>;
+    NodeList level {std::static_pointer_cast<SHAMapInnerNode>(root_)};
+
+    while (! level.empty () && levels-- > 0)
+    {
+        NodeList next;
+        for (auto const& node : level)
+        {
+            function (*node);
+
+            if (levels == 0)
+                continue;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                if (node->isEmptyBranch (i))
+                    continue;
+
+                auto child = descendNoStore (node, i);
+                if (child && child->isInner ())
+                    next.push_back (
+                        std::static_pointer_cast<SHAMapInnerNode>(child));
+            }
+        }
+        level = std::move (next);
+    }
+}
+
 void
 SHAMap::visitDifferences(SHAMap const* have,
-    std::function<bool (SHAMapAbstractNode&)> function) const
+    std::function<bool (SHAMapAbstractNode&)> function, int threads) const
 {
     assert (root_->isValid ());
 
@@ -103,43 +140,107 @@ SHAMap::visitDifferences(SHAMap const* have,
         return;
     }
     using StackEntry = std::pair <SHAMapInnerNode*, SHAMapNodeID>;
-    std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    stack.push ({static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{}});
-
-    while (! stack.empty())
+    // Visit the subtrees below the given inner nodes, returning false if
+    // the function asked to stop
+    auto walk = [this, have](std::vector<StackEntry> entries,
+        std::function<bool (SHAMapAbstractNode&)> const& func)
     {
-        SHAMapInnerNode* node;
-        SHAMapNodeID nodeID;
-        std::tie (node, nodeID) = stack.top ();
-        stack.pop ();
+        std::stack <StackEntry, std::vector<StackEntry>> stack (
+            std::move (entries));
 
-        if (! function (*node))
-            return;
-
-        for (int i = 0; i < 16; ++i)
+        while (! stack.empty())
         {
-            if (! node->isEmptyBranch (i))
-            {
-                auto const& childHash = node->getChildHash (i);
-                SHAMapNodeID childID = nodeID.getChildNodeID (i);
-                auto next = descendThrow(node, i);
+            SHAMapInnerNode* node;
+            SHAMapNodeID nodeID;
+            std::tie (node, nodeID) = stack.top ();
+            stack.pop ();
 
-                if (next->isInner ())
-                {
-                    if (! have || ! have->hasInnerNode(childID, childHash))
-                        stack.push ({static_cast<SHAMapInnerNode*>(next), childID});
-                }
-                else if (! have || ! have->hasLeafNode(
-                         static_cast<SHAMapTreeNode*>(next)->peekItem()->key(),
-                         childHash))
+            if (! func (*node))
+                return false;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                if (! node->isEmptyBranch (i))
                 {
-                    if (! function (*next))
-                        return;
+                    auto const& childHash = node->getChildHash (i);
+                    SHAMapNodeID childID = nodeID.getChildNodeID (i);
+                    auto next = descendThrow(node, i);
+
+                    if (next->isInner ())
+                    {
+                        if (! have || ! have->hasInnerNode(childID, childHash))
+                            stack.push ({static_cast<SHAMapInnerNode*>(next), childID});
+                    }
+                    else if (! have || ! have->hasLeafNode(
+                             static_cast<SHAMapTreeNode*>(next)->peekItem()->key(),
+                             childHash))
+                    {
+                        if (! func (*next))
+                            return false;
+                    }
                 }
             }
         }
+        return true;
+    };
+
+    auto const root = static_cast<SHAMapInnerNode*>(root_.get());
+
+    // Concurrent descent is only safe when neither tree can change
+    if (threads <= 1 || state_ != SHAMapState::Immutable ||
+        (have && have->state_ != SHAMapState::Immutable))
+    {
+        walk ({{root, SHAMapNodeID{}}}, function);
+        return;
+    }
+
+    // Visit the root and its leaves here, then spread the inner subtrees
+    // below it across the threads. The function must be thread safe.
+    std::vector<StackEntry> subtrees;
+    bool done = ! function (*root);
+    for (int i = 0; ! done && i < 16; ++i)
+    {
+        if (root->isEmptyBranch (i))
+            continue;
+
+        auto const& childHash = root->getChildHash (i);
+        SHAMapNodeID childID = SHAMapNodeID{}.getChildNodeID (i);
+        auto next = descendThrow (root, i);
+        if (next->isInner ())
+        {
+            if (! have || ! have->hasInnerNode (childID, childHash))
+                subtrees.emplace_back (static_cast<SHAMapInnerNode*>(next), childID);
+        }
+        else if (! have || ! have->hasLeafNode (
+                 static_cast<SHAMapTreeNode*>(next)->peekItem()->key(),
+                 childHash))
+        {
+            done = ! function (*next);
+        }
     }
+    if (done || subtrees.empty ())
+        return;
+
+    std::atomic<bool> stopped {false};
+
+    std::function<bool (SHAMapAbstractNode&)> const guarded =
+        [&stopped, &function](SHAMapAbstractNode& node)
+        {
+            if (stopped.load (std::memory_order_relaxed) || ! function (node))
+            {
+                stopped = true;
+                return false;
+            }
+            return true;
+        };
+
+    parallelFor (subtrees.size (), threads,
+        [&](std::size_t i)
+        {
+            walk ({subtrees[i]}, guarded);
+            return ! stopped;
+        });
 }
 
 void SHAMap::gmn_ProcessNodes (MissingNodes& mn, MissingNodes::StackEntry& se)
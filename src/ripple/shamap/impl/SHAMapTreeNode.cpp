@@ -1,6 +1,7 @@
 
 
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/basics/CloseProfiler.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/protocol/digest.h>
@@ -336,6 +337,7 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
 bool
 SHAMapInnerNode::updateHash()
 {
+    ++perf::workCounters().nodesHashed;
     uint256 nh;
     if (mIsBranch != 0)
     {
@@ -367,6 +369,7 @@ SHAMapInnerNode::updateHashDeep()
 bool
 SHAMapTreeNode::updateHash()
 {
+    ++perf::workCounters().nodesHashed;
     uint256 nh;
     if (mType == tnTRANSACTION_NM)
     {
@@ -475,6 +478,7 @@ SHAMapInnerNodeV2::addRaw(Serializer& s, SHANodeFormat format) const
 bool
 SHAMapInnerNodeV2::updateHash()
 {
+    ++perf::workCounters().nodesHashed;
     uint256 nh;
 
     if (mIsBranch != 0)
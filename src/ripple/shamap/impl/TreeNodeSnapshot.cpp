@@ -0,0 +1,212 @@
+#include <ripple/shamap/TreeNodeSnapshot.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/hardened_hash.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstring>
+#include <fstream>
+
+namespace ripple {
+
+namespace {
+
+char const snapshotMagic[8] = {'T', 'N', 'S', 'N', 'A', 'P', '\0', '\0'};
+std::uint32_t constexpr snapshotVersion = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t count;
+};
+
+struct NodeHeader
+{
+    std::uint8_t hash[32];
+    std::uint32_t size;
+};
+
+static_assert (sizeof (FileHeader) == 16, "");
+static_assert (sizeof (NodeHeader) == 36, "");
+
+}
+
+TreeNodeSnapshotSetup
+setup_TreeNodeSnapshot (Section const& section,
+    boost::filesystem::path const& dataDir)
+{
+    TreeNodeSnapshotSetup setup;
+
+    std::string path;
+    set (path, "path", section);
+    if (! path.empty ())
+    {
+        setup.path = path;
+        if (setup.path.is_relative ())
+            setup.path = boost::filesystem::absolute (setup.path, dataDir);
+    }
+
+    set (setup.maxNodes, "max_nodes", section);
+    set (setup.levels, "levels", section);
+
+    std::uint64_t interval;
+    if (get_if_exists (section, "interval", interval))
+        setup.interval = std::chrono::seconds (interval);
+
+    return setup;
+}
+
+std::size_t
+saveTreeNodeSnapshot (TreeNodeSnapshotSetup const& setup,
+    Family& family, SHAMap const* stateMap, beast::Journal j)
+{
+    if (setup.path.empty () || setup.maxNodes == 0)
+        return 0;
+
+    auto const tmp = setup.path.string () + ".tmp";
+    std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+    if (! out)
+    {
+        JLOG (j.warn()) << "Unable to write node snapshot " << tmp;
+        return 0;
+    }
+
+    FileHeader fh;
+    std::memcpy (fh.magic, snapshotMagic, sizeof (fh.magic));
+    fh.version = snapshotVersion;
+    fh.count = 0;
+    out.write (reinterpret_cast<char const*>(&fh), sizeof (fh));
+
+    hardened_hash_set<uint256> written;
+    Serializer s;
+
+    auto write = [&](SHAMapAbstractNode const& node)
+    {
+        if (fh.count >= setup.maxNodes || ! node.isInner ())
+            return;
+
+        auto const& hash = node.getNodeHash ().as_uint256 ();
+        if (! written.insert (hash).second)
+            return;
+
+        s.erase ();
+        node.addRaw (s, snfPREFIX);
+
+        NodeHeader nh;
+        std::memcpy (nh.hash, hash.data (), sizeof (nh.hash));
+        nh.size = s.getLength ();
+
+        out.write (reinterpret_cast<char const*>(&nh), sizeof (nh));
+        out.write (static_cast<char const*>(s.getDataPtr ()), nh.size);
+        ++fh.count;
+    };
+
+    try
+    {
+        if (stateMap)
+            stateMap->visitInnerNodes (setup.levels, write);
+
+        for (auto const& node : family.treecache ().getRecent (setup.maxNodes))
+            write (*node);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j.warn()) << "Node snapshot incomplete: " << e.what ();
+    }
+
+    out.seekp (0);
+    out.write (reinterpret_cast<char const*>(&fh), sizeof (fh));
+    out.close ();
+
+    boost::system::error_code ec;
+    if (! out)
+        ec = boost::system::errc::make_error_code (
+            boost::system::errc::io_error);
+    else
+        boost::filesystem::rename (tmp, setup.path, ec);
+
+    if (ec)
+    {
+        JLOG (j.warn()) << "Unable to write node snapshot " << setup.path
+            << ": " << ec.message ();
+        boost::filesystem::remove (tmp, ec);
+        return 0;
+    }
+
+    JLOG (j.info()) << "Wrote " << fh.count << " nodes to node snapshot";
+    return fh.count;
+}
+
+std::size_t
+loadTreeNodeSnapshot (TreeNodeSnapshotSetup const& setup,
+    Family& family, beast::Journal j)
+{
+    namespace bip = boost::interprocess;
+
+    boost::system::error_code ec;
+    if (setup.path.empty () || ! boost::filesystem::exists (setup.path, ec))
+        return 0;
+
+    std::size_t loaded = 0;
+    try
+    {
+        bip::file_mapping file (setup.path.string ().c_str (), bip::read_only);
+        bip::mapped_region region (file, bip::read_only);
+
+        auto p = static_cast<std::uint8_t const*>(region.get_address ());
+        auto const end = p + region.get_size ();
+
+        FileHeader fh;
+        if (region.get_size () < sizeof (fh))
+            Throw<std::runtime_error> ("truncated header");
+        std::memcpy (&fh, p, sizeof (fh));
+        p += sizeof (fh);
+
+        if (std::memcmp (fh.magic, snapshotMagic, sizeof (fh.magic)) != 0 ||
+            fh.version != snapshotVersion)
+        {
+            Throw<std::runtime_error> ("unknown format");
+        }
+
+        for (std::uint32_t i = 0; i < fh.count; ++i)
+        {
+            NodeHeader nh;
+            if (end - p < static_cast<std::ptrdiff_t>(sizeof (nh)))
+                Throw<std::runtime_error> ("truncated node header");
+            std::memcpy (&nh, p, sizeof (nh));
+            p += sizeof (nh);
+
+            if (end - p < static_cast<std::ptrdiff_t>(nh.size))
+                Throw<std::runtime_error> ("truncated node");
+
+            uint256 hash;
+            std::memcpy (hash.data (), nh.hash, sizeof (nh.hash));
+
+            // Recompute the hash rather than trusting the file
+            auto node = SHAMapAbstractNode::make (Slice (p, nh.size),
+                0, snfPREFIX, SHAMapHash {hash}, false, j);
+            p += nh.size;
+
+            if (! node || ! node->isInner () ||
+                node->getNodeHash ().as_uint256 () != hash)
+            {
+                Throw<std::runtime_error> ("bad node");
+            }
+
+            family.treecache ().canonicalize (hash, node);
+            ++loaded;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j.warn()) << "Node snapshot " << setup.path
+            << " unusable after " << loaded << " nodes: " << e.what ();
+    }
+
+    JLOG (j.info()) << "Loaded " << loaded << " nodes from node snapshot";
+    return loaded;
+}
+
+}
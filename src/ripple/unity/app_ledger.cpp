@@ -9,6 +9,7 @@
 #include <ripple/app/ledger/Ledger.cpp>
 #include <ripple/app/ledger/LedgerHistory.cpp>
 #include <ripple/app/ledger/OrderBookDB.cpp>
+#include <ripple/app/ledger/OrderBookIndex.cpp>
 #include <ripple/app/ledger/TransactionStateSF.cpp>
 
 
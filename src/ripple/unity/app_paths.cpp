@@ -8,9 +8,11 @@
 #include <ripple/app/paths/Node.cpp>
 #include <ripple/app/paths/PathRequest.cpp>
 #include <ripple/app/paths/PathRequests.cpp>
+#include <ripple/app/paths/PathSearchPool.cpp>
 #include <ripple/app/paths/PathState.cpp>
 #include <ripple/app/paths/RippleCalc.cpp>
 #include <ripple/app/paths/RippleLineCache.cpp>
+#include <ripple/app/paths/TrustLineGraph.cpp>
 #include <ripple/app/paths/Flow.cpp>
 #include <ripple/app/paths/impl/PaySteps.cpp>
 #include <ripple/app/paths/impl/DirectStep.cpp>
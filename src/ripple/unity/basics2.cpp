@@ -1,6 +1,8 @@
 
 
 #include <ripple/basics/impl/BasicConfig.cpp>
+#include <ripple/basics/impl/CloseProfiler.cpp>
+#include <ripple/basics/impl/LatencyHistogram.cpp>
 #include <ripple/basics/impl/make_SSLContext.cpp>
 #include <ripple/basics/impl/mulDiv.cpp>
 #include <ripple/basics/impl/PerfLogImp.cpp>
@@ -4,6 +4,7 @@
 #include <ripple/overlay/impl/Cluster.cpp>
 #include <ripple/overlay/impl/ConnectAttempt.cpp>
 #include <ripple/overlay/impl/Message.cpp>
+#include <ripple/overlay/impl/MessageDispatch.cpp>
 #include <ripple/overlay/impl/OverlayImpl.cpp>
 
 
@@ -37,6 +37,7 @@
 #include <ripple/rpc/handlers/LedgerData.cpp>
 #include <ripple/rpc/handlers/LedgerEntry.cpp>
 #include <ripple/rpc/handlers/LedgerHeader.cpp>
+#include <ripple/rpc/handlers/LedgerProfile.cpp>
 #include <ripple/rpc/handlers/LedgerRequest.cpp>
 #include <ripple/rpc/handlers/LogLevel.cpp>
 #include <ripple/rpc/handlers/LogRotate.cpp>
@@ -7,6 +7,7 @@
 #include <ripple/shamap/impl/SHAMapNodeID.cpp>
 #include <ripple/shamap/impl/SHAMapSync.cpp>
 #include <ripple/shamap/impl/SHAMapTreeNode.cpp>
+#include <ripple/shamap/impl/TreeNodeSnapshot.cpp>
 
 
 
@@ -0,0 +1,308 @@
+#include <test/jtx.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/basics/UptimeClock.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/protocol/messages.h>
+
+namespace ripple {
+namespace test {
+
+class FetchPackStream_test : public beast::unit_test::suite
+{
+    using Packet = protocol::TMGetObjectByHash;
+
+    // Keeps the fetch pack messages a server sends it
+    class TestPeer : public Peer
+    {
+    public:
+        std::vector<std::shared_ptr<Packet>> replies;
+
+        void
+        send (Message::pointer const& m) override
+        {
+            auto const& buffer = m->getBuffer ();
+            auto packet = std::make_shared<Packet> ();
+            if (packet->ParseFromArray (
+                    buffer.data () + Message::kHeaderBytes,
+                    buffer.size () - Message::kHeaderBytes))
+                replies.push_back (std::move (packet));
+        }
+
+        beast::IP::Endpoint
+        getRemoteAddress () const override
+        {
+            return {};
+        }
+
+        void
+        charge (Resource::Charge const&) override
+        {
+        }
+
+        id_t
+        id () const override
+        {
+            return 7;
+        }
+
+        bool
+        cluster () const override
+        {
+            return false;
+        }
+
+        bool
+        isHighLatency () const override
+        {
+            return false;
+        }
+
+        int
+        getScore (bool) const override
+        {
+            return 0;
+        }
+
+        PublicKey const&
+        getNodePublic () const override
+        {
+            return key_;
+        }
+
+        Json::Value
+        json () override
+        {
+            return {};
+        }
+
+        uint256 const&
+        getClosedLedgerHash () const override
+        {
+            return closed_;
+        }
+
+        bool
+        hasLedger (uint256 const&, std::uint32_t) const override
+        {
+            return false;
+        }
+
+        void
+        ledgerRange (std::uint32_t& minSeq,
+            std::uint32_t& maxSeq) const override
+        {
+            minSeq = maxSeq = 0;
+        }
+
+        bool
+        hasShard (std::uint32_t) const override
+        {
+            return false;
+        }
+
+        bool
+        hasTxSet (uint256 const&) const override
+        {
+            return false;
+        }
+
+        void
+        cycleStatus () override
+        {
+        }
+
+        bool
+        supportsVersion (int) override
+        {
+            return true;
+        }
+
+        bool
+        hasRange (std::uint32_t, std::uint32_t) override
+        {
+            return false;
+        }
+
+    private:
+        PublicKey key_;
+        uint256 closed_;
+    };
+
+    // Closes a few ledgers with payments and asks the server to stream
+    // fetch packs for the ledgers before the last one.
+    std::vector<std::shared_ptr<Packet>>
+    stream (jtx::Env& env, std::uint32_t count)
+    {
+        using namespace jtx;
+
+        auto const alice = Account ("alice");
+        env.fund (XRP (100000), alice);
+        env.close ();
+        for (int i = 0; i < 8; ++i)
+        {
+            env (pay (env.master, alice, XRP (100 + i)));
+            env.close ();
+        }
+
+        auto& ledgerMaster = env.app ().getLedgerMaster ();
+        auto const have = ledgerMaster.getClosedLedger ();
+
+        auto request = std::make_shared<Packet> ();
+        request->set_query (true);
+        request->set_type (Packet::otFETCH_PACK);
+        request->set_ledgerhash (have->info ().hash.begin (), 32);
+        request->set_ledgercount (count);
+
+        auto peer = std::make_shared<TestPeer> ();
+        ledgerMaster.makeFetchPack (peer, request, have->info ().hash,
+            UptimeClock::now ());
+        return std::move (peer->replies);
+    }
+
+    void
+    testReply ()
+    {
+        testcase ("Reply");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const replies = stream (env, 5);
+        auto const last = env.app ().getLedgerMaster ().getClosedLedger ();
+
+        if (! BEAST_EXPECT(replies.size () == 5))
+            return;
+
+        for (std::uint32_t i = 0; i < replies.size (); ++i)
+        {
+            auto const& reply = *replies[i];
+            BEAST_EXPECT(! reply.query ());
+            BEAST_EXPECT(reply.ledgercount () == 4 - i);
+            BEAST_EXPECT(reply.streamend () == (i == 4));
+            if (! BEAST_EXPECT(reply.objects_size () > 0))
+                continue;
+
+            // The header comes first and every node is of that ledger
+            auto const seq = last->info ().seq - i - 1;
+            BEAST_EXPECT(reply.objects (0).nodetype () == hotLEDGER);
+            for (auto const& obj : reply.objects ())
+            {
+                BEAST_EXPECT(obj.ledgerseq () == seq);
+                BEAST_EXPECT(uint256 {obj.hash ()} ==
+                    sha512Half (makeSlice (obj.data ())));
+            }
+        }
+
+        // A stream running out of ledgers still ends
+        auto const all = stream (env, 200);
+        BEAST_EXPECT(! all.empty () && all.back ()->streamend ());
+    }
+
+    void
+    testReceive ()
+    {
+        testcase ("Receive");
+
+        using namespace jtx;
+        Env server (*this);
+        auto const replies = stream (server, 5);
+        if (! BEAST_EXPECT(replies.size () == 5))
+            return;
+
+        LedgerIndex const highest = replies.front ()->objects (0).ledgerseq ();
+        LedgerIndex const lowest = replies.back ()->objects (0).ledgerseq ();
+        uint256 const have {replies.front ()->ledgerhash ()};
+        uint256 const other = ~have;
+
+        Env client (*this);
+        auto& ledgerMaster = client.app ().getLedgerMaster ();
+        auto& db = client.app ().getNodeStore ();
+
+        auto stored = [&](Packet const& packet)
+        {
+            for (auto const& obj : packet.objects ())
+            {
+                if (! db.fetch (uint256 {obj.hash ()}, obj.ledgerseq ()))
+                    return false;
+            }
+            return true;
+        };
+        auto header = [&](Packet const& packet)
+        {
+            return db.fetch (uint256 {packet.objects (0).hash ()},
+                packet.objects (0).ledgerseq ()) != nullptr;
+        };
+
+        // Nobody asked for it
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+        BEAST_EXPECT(! header (*replies[0]));
+
+        // Somebody else was asked, or from another ledger, or for other
+        // ledgers
+        ledgerMaster.expectFetchPackStream (8, have, lowest, highest);
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+        ledgerMaster.expectFetchPackStream (7, other, lowest, highest);
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+        ledgerMaster.expectFetchPackStream (7, have, lowest, highest - 1);
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+        BEAST_EXPECT(! header (*replies[0]));
+
+        // A message without the ledger it started from is refused
+        ledgerMaster.expectFetchPackStream (7, have, lowest, highest);
+        {
+            auto bad = std::make_shared<Packet> (*replies[0]);
+            bad->clear_ledgerhash ();
+            BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (bad, 7));
+            BEAST_EXPECT(! header (*bad));
+        }
+
+        // A node not matching its hash spoils the whole message
+        {
+            auto bad = std::make_shared<Packet> (*replies[0]);
+            auto& obj = *bad->mutable_objects (bad->objects_size () - 1);
+            auto data = obj.data ();
+            data[0] ^= 1;
+            obj.set_data (data);
+            BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (bad, 7));
+            BEAST_EXPECT(! header (*bad));
+        }
+
+        for (auto const& reply : replies)
+        {
+            BEAST_EXPECT(ledgerMaster.gotFetchPackStream (reply, 7));
+            BEAST_EXPECT(stored (*reply));
+        }
+
+        // The stream ended with the last message, but the other streams
+        // asked for are still outstanding
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+        for (Peer::id_t const id : {7, 8})
+        {
+            auto const packet = std::make_shared<Packet> (*replies[0]);
+            packet->set_ledgerhash (
+                (id == 7 ? other : have).begin (), 32);
+            BEAST_EXPECT(ledgerMaster.gotFetchPackStream (packet, id));
+        }
+
+        // A classic reply ends only the stream it answers
+        ledgerMaster.expectFetchPackStream (7, have, lowest, highest);
+        ledgerMaster.endFetchPackStream (8, have);
+        ledgerMaster.endFetchPackStream (7, other);
+        BEAST_EXPECT(ledgerMaster.gotFetchPackStream (replies[0], 7));
+        ledgerMaster.endFetchPackStream (7, have);
+        BEAST_EXPECT(! ledgerMaster.gotFetchPackStream (replies[0], 7));
+    }
+
+public:
+    void
+    run () override
+    {
+        testReply ();
+        testReceive ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FetchPackStream,app,ripple);
+
+}
+}
@@ -3,6 +3,11 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -219,6 +224,79 @@ public:
 
 BEAST_DEFINE_TESTSUITE(HashRouter, app, ripple);
 
+class HashRouterBench_test : public beast::unit_test::suite
+{
+    std::size_t static constexpr peers = 100;
+    std::size_t static constexpr messagesPerSecond = 10000;
+    std::size_t static constexpr seconds = 20;
+
+    // Every message is relayed to us by every peer, and relayed on once
+    void
+    measure(std::size_t threads)
+    {
+        using namespace std::chrono;
+
+        TestStopwatch stopwatch;
+        HashRouter router(stopwatch, 5s, HashRouter::getDefaultRecoverLimit());
+
+        beast::xor_shift_engine rng;
+        std::vector<uint256> keys(messagesPerSecond);
+        std::atomic<std::size_t> relayed{0};
+
+        auto const start = steady_clock::now();
+        for (std::size_t second = 0; second < seconds; ++second)
+        {
+            for (auto& key : keys)
+            {
+                for (auto it = key.begin(); it != key.end(); ++it)
+                    *it = static_cast<std::uint8_t>(rng());
+            }
+
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    for (auto const& key : keys)
+                    {
+                        for (std::size_t p = t; p < peers; p += threads)
+                        {
+                            int flags;
+                            router.addSuppressionPeer(key,
+                                static_cast<HashRouter::PeerShortID>(p + 1),
+                                    flags);
+                        }
+                        if (t == 0 && router.shouldRelay(key))
+                            ++relayed;
+                    }
+                });
+            }
+            for (auto& w : workers)
+                w.join();
+            ++stopwatch;
+        }
+        auto const elapsed = steady_clock::now() - start;
+
+        BEAST_EXPECT(relayed == seconds * messagesPerSecond);
+
+        auto const us = std::max<std::int64_t>(
+            duration_cast<microseconds>(elapsed).count(), 1);
+        log << peers << " peers, " << threads << " threads: " <<
+            (seconds * messagesPerSecond * peers * 1000000 / us) <<
+            " lookups/s, " << (us / seconds) << "us per simulated second" <<
+            std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+            measure(threads);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(HashRouterBench, app, ripple);
+
 }
 }
 
@@ -0,0 +1,124 @@
+#include <test/jtx.h>
+#include <ripple/app/ledger/OrderBookIndex.h>
+
+namespace ripple {
+
+namespace test {
+
+class OrderBookIndex_test : public beast::unit_test::suite
+{
+    // The indexed offers match a walk of the book's directories
+    bool
+    matches (OrderBookIndex::Offers const& offers,
+        ReadView const& view, Book const& book)
+    {
+        auto const expected = OrderBookIndex::build (view, book);
+        if (offers.size () != expected.size ())
+            return false;
+
+        for (std::size_t i = 0; i < offers.size (); ++i)
+        {
+            auto const& a = offers[i];
+            auto const& b = expected[i];
+            if (a.sle->key () != b.sle->key () ||
+                a.quality != b.quality ||
+                a.sle->getFieldAmount (sfTakerPays) !=
+                    b.sle->getFieldAmount (sfTakerPays) ||
+                a.sle->getFieldAmount (sfTakerGets) !=
+                    b.sle->getFieldAmount (sfTakerGets))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    void
+    testIncremental ()
+    {
+        testcase ("Incremental update");
+
+        using namespace jtx;
+        Env env (*this);
+
+        auto const gw = Account {"gateway"};
+        auto const alice = Account {"alice"};
+        auto const bob = Account {"bob"};
+        auto const USD = gw["USD"];
+        Book const book {xrpIssue (), USD.issue ()};
+
+        env.fund (XRP (100000), gw, alice, bob);
+        env.trust (USD (10000), alice, bob);
+        env (pay (gw, alice, USD (1000)));
+        env.close ();
+
+        auto const cancelSeq = env.seq (alice);
+        for (int i = 1; i <= 5; ++i)
+            env (offer (alice, XRP (100 + i), USD (10)));
+        env (offer (alice, XRP (103), USD (10)));
+        env.close ();
+
+        OrderBookIndex index (env.journal);
+        index.onValidatedLedger (env.closed ());
+
+        auto offers = index.getOffers (*env.closed (), book);
+        if (! BEAST_EXPECT (offers))
+            return;
+        BEAST_EXPECT (offers->size () == 6);
+        BEAST_EXPECT (matches (*offers, *env.closed (), book));
+        BEAST_EXPECT (offers->front ().quality <= offers->back ().quality);
+
+        // Readers of the same ledger share the result
+        BEAST_EXPECT (index.getOffers (*env.closed (), book) == offers);
+
+        // Open ledgers are not indexed
+        BEAST_EXPECT (! index.getOffers (*env.current (), book));
+
+        // Partially take the best offer and cancel another
+        env (offer (bob, USD (5), XRP (60)));
+        env (offer_cancel (alice, cancelSeq + 2));
+        env.close ();
+
+        index.onValidatedLedger (env.closed ());
+        auto const updated = index.getOffers (*env.closed (), book);
+        if (! BEAST_EXPECT (updated))
+            return;
+        BEAST_EXPECT (updated->size () == 5);
+        BEAST_EXPECT (matches (*updated, *env.closed (), book));
+
+        // The earlier snapshot is unaffected
+        BEAST_EXPECT (offers->size () == 6);
+
+        // A new offer makes the book read again
+        env (offer (alice, XRP (102), USD (10)));
+        env.close ();
+
+        index.onValidatedLedger (env.closed ());
+        auto const rebuilt = index.getOffers (*env.closed (), book);
+        if (! BEAST_EXPECT (rebuilt))
+            return;
+        BEAST_EXPECT (rebuilt != updated);
+        BEAST_EXPECT (rebuilt->size () == 6);
+        BEAST_EXPECT (matches (*rebuilt, *env.closed (), book));
+
+        // A skipped ledger leaves the old ledger unindexed
+        auto const old = env.closed ();
+        env.close ();
+        env.close ();
+        index.onValidatedLedger (env.closed ());
+        BEAST_EXPECT (! index.getOffers (*old, book));
+        BEAST_EXPECT (index.getOffers (*env.closed (), book));
+    }
+
+    void
+    run () override
+    {
+        testIncremental ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE (OrderBookIndex, app, ripple);
+
+}
+}
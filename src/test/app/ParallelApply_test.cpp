@@ -0,0 +1,179 @@
+#include <test/jtx.h>
+#include <ripple/app/ledger/BuildLedger.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/xor_shift_engine.h>
+
+namespace ripple {
+namespace test {
+
+class ParallelApply_test : public beast::unit_test::suite
+{
+    struct Result
+    {
+        uint256 hash;
+        std::size_t txs;
+        std::set<TxID> failed;
+        std::size_t retried;
+        ParallelApplyStats stats;
+    };
+
+    Result
+    build (jtx::Env& env, std::shared_ptr<Ledger const> const& parent,
+        std::vector<std::shared_ptr<STTx const>> const& txs,
+        std::size_t threads)
+    {
+        env.app().config().LEDGER_APPLY_THREADS = threads;
+
+        CanonicalTXSet set (parent->info().hash);
+        for (auto const& tx : txs)
+            set.insert (tx);
+
+        Result r;
+        auto const built = buildLedger (parent,
+            parent->info().closeTime + parent->info().closeTimeResolution,
+            true, parent->info().closeTimeResolution, env.app(), set,
+            r.failed, env.journal, nullptr, &r.stats);
+
+        r.hash = built->info().hash;
+        r.txs = std::distance (built->txs.begin (), built->txs.end ());
+        r.retried = set.size ();
+        return r;
+    }
+
+    // Payments and offers among a few accounts, so that many transactions
+    // conflict and payments larger than a balance need another pass.
+    void
+    testDeterminism (std::uint64_t seed)
+    {
+        testcase ("Determinism, seed " + std::to_string (seed));
+
+        using namespace jtx;
+        Env env (*this);
+
+        auto const gw = Account {"gateway"};
+        auto const USD = gw["USD"];
+        std::vector<Account> accounts;
+        for (int i = 0; i < 12; ++i)
+            accounts.emplace_back ("a" + std::to_string (i));
+
+        env.fund (XRP (100000), gw);
+        for (auto const& a : accounts)
+            env.fund (XRP (100000), a);
+        env.close ();
+        for (auto const& a : accounts)
+            env.trust (USD (100000), a);
+        env.close ();
+        for (auto const& a : accounts)
+            env (pay (gw, a, USD (1000)));
+        env.close ();
+
+        beast::xor_shift_engine engine (seed);
+        std::map<AccountID, std::uint32_t> seqs;
+        for (auto const& a : accounts)
+            seqs[a.id()] = env.seq (a);
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (int i = 0; i < 300; ++i)
+        {
+            auto const& src = accounts[rand_int (engine, 0, 11)];
+            auto const& dst = accounts[rand_int (engine, 0, 11)];
+            auto const amount = rand_int (engine, 1, 2000);
+
+            // A skipped sequence number leaves the rest to be retried
+            auto& next = seqs[src.id()];
+            if (rand_int (engine, 0, 99) == 0)
+                ++next;
+
+            Json::Value jv;
+            switch (rand_int (engine, 0, 3))
+            {
+            case 0:
+                jv = pay (src, dst == src ? gw : dst, XRP (amount));
+                break;
+            case 1:
+                jv = pay (src, dst == src ? gw : dst, USD (amount));
+                break;
+            case 2:
+                jv = offer (src, XRP (amount), USD (amount / 10 + 1));
+                break;
+            default:
+                jv = offer (src, USD (amount / 10 + 1), XRP (amount - 1));
+                break;
+            }
+            txs.push_back (env.jt (jv, seq (next++), fee (10)).stx);
+        }
+
+        env.close ();
+        auto const parent = env.app().getLedgerMaster().getClosedLedger();
+
+        auto const serial = build (env, parent, txs, 0);
+        BEAST_EXPECT (serial.txs > 100);
+        BEAST_EXPECT (serial.stats.kept == 0);
+        BEAST_EXPECT (serial.stats.reapplied == 0);
+
+        // Every speculation runs against the state at the start of its
+        // pass, so what is kept does not depend on the number of threads
+        auto const single = build (env, parent, txs, 1);
+        BEAST_EXPECT (single.stats.kept > 0);
+        BEAST_EXPECT (single.stats.reapplied > 0);
+
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            auto const parallel = build (env, parent, txs, threads);
+            BEAST_EXPECT (parallel.hash == serial.hash);
+            BEAST_EXPECT (parallel.txs == serial.txs);
+            BEAST_EXPECT (parallel.failed == serial.failed);
+            BEAST_EXPECT (parallel.retried == serial.retried);
+            BEAST_EXPECT (parallel.stats.kept == single.stats.kept);
+            BEAST_EXPECT (
+                parallel.stats.reapplied == single.stats.reapplied);
+        }
+    }
+
+    // Transactions that touch nothing in common are all kept
+    void
+    testDisjoint ()
+    {
+        testcase ("Disjoint");
+
+        using namespace jtx;
+        Env env (*this);
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 40; ++i)
+            accounts.emplace_back ("d" + std::to_string (i));
+        for (auto const& a : accounts)
+            env.fund (XRP (10000), a);
+        env.close ();
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (std::size_t i = 0; i < accounts.size (); i += 2)
+            txs.push_back (env.jt (
+                pay (accounts[i], accounts[i + 1], XRP (10))).stx);
+        env.close ();
+
+        auto const parent = env.app().getLedgerMaster().getClosedLedger();
+        auto const serial = build (env, parent, txs, 0);
+        auto const parallel = build (env, parent, txs, 4);
+        BEAST_EXPECT (serial.txs == txs.size ());
+        BEAST_EXPECT (parallel.hash == serial.hash);
+        BEAST_EXPECT (parallel.stats.kept == txs.size ());
+        BEAST_EXPECT (parallel.stats.reapplied == 0);
+    }
+
+    void
+    run () override
+    {
+        testDisjoint ();
+        for (std::uint64_t seed : {1, 2, 3})
+            testDeterminism (seed);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE (ParallelApply, app, ripple);
+
+}
+}
@@ -14,10 +14,13 @@
 #include <ripple/rpc/RPCHandler.h>
 #include <test/jtx.h>
 #include <ripple/beast/unit_test.h>
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -1335,6 +1338,139 @@ public:
 
 BEAST_DEFINE_TESTSUITE(Path,app,ripple);
 
+// Measures ripple_path_find latency over a market of several gateways,
+// currencies and market makers, for different search pool sizes.
+class PathFindBench_test : public Path_test
+{
+    struct Result
+    {
+        std::chrono::microseconds median;
+        std::chrono::microseconds mean;
+        std::chrono::microseconds max;
+        std::size_t alternatives;
+    };
+
+    Result
+    measure (std::size_t threads, std::chrono::milliseconds budget,
+        int requests)
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        Env env(*this, envconfig([&](std::unique_ptr<Config> cfg)
+            {
+                cfg->PATH_SEARCH_THREADS = threads;
+                cfg->PATH_SEARCH_TIME = budget;
+                return cfg;
+            }));
+
+        char const* const codes[] = {"USD", "EUR", "CNY", "JPY"};
+        std::vector<Account> gateways;
+        std::vector<Account> makers;
+        for (int i = 0; i < 4; ++i)
+            gateways.emplace_back("G" + std::to_string(i));
+        for (int i = 0; i < 3; ++i)
+            makers.emplace_back("M" + std::to_string(i));
+        Account const src {"src"};
+        Account const dst {"dst"};
+
+        env.fund(XRP(1000000), src, dst);
+        for (auto const& a : gateways)
+            env.fund(XRP(1000000), a);
+        for (auto const& a : makers)
+            env.fund(XRP(1000000), a);
+        env.close();
+
+        std::vector<IOU> ious;
+        for (auto const& g : gateways)
+            for (auto const c : codes)
+                ious.push_back(g[c]);
+
+        for (auto const& iou : ious)
+        {
+            env.trust(iou(1000000), src);
+            for (auto const& m : makers)
+                env.trust(iou(1000000), m);
+        }
+        env.trust(ious.front()(1000000), dst);
+        env.close();
+
+        for (auto const& iou : ious)
+        {
+            env(pay(iou.account, src, iou(10000)));
+            for (auto const& m : makers)
+                env(pay(iou.account, m, iou(100000)));
+        }
+        env.close();
+
+        for (std::size_t k = 0; k < makers.size(); ++k)
+        {
+            for (auto const& a : ious)
+            {
+                env(offer(makers[k], XRP(1000 + k), a(100)));
+                env(offer(makers[k], a(100 + k), XRP(1000)));
+                for (auto const& b : ious)
+                    if (a.account.id() != b.account.id() ||
+                        a.currency != b.currency)
+                        env(offer(makers[k], a(100 + k), b(100)));
+            }
+            env.close();
+        }
+
+        auto const amount = ious.front()(50);
+        find_paths_request(env, src, dst, amount);
+
+        std::vector<microseconds> times;
+        std::size_t alternatives = 0;
+        for (int i = 0; i < requests; ++i)
+        {
+            auto const start = steady_clock::now();
+            auto const result = find_paths_request(env, src, dst, amount);
+            times.push_back(duration_cast<microseconds>(
+                steady_clock::now() - start));
+            alternatives += result[jss::alternatives].size();
+        }
+
+        std::sort(times.begin(), times.end());
+        microseconds total {0};
+        for (auto const& t : times)
+            total += t;
+
+        return {times[times.size() / 2], total / times.size(),
+            times.back(), alternatives / times.size()};
+    }
+
+    void
+    report (std::string const& name, Result const& r)
+    {
+        log << name <<
+            ": median " << r.median.count() << "us" <<
+            ", mean " << r.mean.count() << "us" <<
+            ", max " << r.max.count() << "us" <<
+            ", " << r.alternatives << " alternatives" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono;
+        int const requests = 20;
+
+        for (std::size_t threads : {0, 1, 2, 4, 8})
+            report("threads " + std::to_string(threads),
+                measure(threads, milliseconds {0}, requests));
+
+        for (auto const budget : {milliseconds {1}, milliseconds {10}})
+            report("threads 4, budget " + std::to_string(budget.count()) +
+                "ms", measure(4, budget, requests));
+
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(PathFindBench,app,ripple);
+
 } 
 } 
 
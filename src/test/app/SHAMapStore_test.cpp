@@ -36,6 +36,16 @@ class SHAMapStore_test : public beast::unit_test::suite
         return cfg;
     }
 
+    static
+    auto
+    incrementalRotation(std::unique_ptr<Config> cfg)
+    {
+        cfg = onlineDelete(std::move(cfg));
+        cfg->section(ConfigSection::nodeDatabase())
+            .set("incremental_rotation", "1");
+        return cfg;
+    }
+
     bool goodLedger(jtx::Env& env, Json::Value const& json,
         std::string ledgerID, bool checkDB = false)
     {
@@ -575,11 +585,67 @@ public:
         lastRotated = ledgerSeq - 1;
     }
 
+    void testIncremental()
+    {
+        testcase("incremental rotation");
+        using namespace jtx;
+
+        Env env(*this, envconfig(incrementalRotation));
+        auto& store = env.app().getSHAMapStore();
+
+        auto ledgerSeq = waitForReady(env);
+        auto lastRotated = ledgerSeq - 1;
+
+        for (; ledgerSeq < lastRotated + deleteInterval; ++ledgerSeq)
+        {
+            env.fund(XRP(10000), noripple("test" + to_string(ledgerSeq)));
+            env.close();
+
+            auto ledger = env.rpc("ledger", "validated");
+            BEAST_EXPECT(goodLedger(env, ledger, to_string(ledgerSeq), true));
+        }
+
+        store.rendezvous();
+        BEAST_EXPECT(store.getLastRotated() == lastRotated);
+
+        auto info = store.getJson();
+        BEAST_EXPECT(info[jss::incremental].asBool());
+        BEAST_EXPECT(info[jss::state] == "idle");
+        BEAST_EXPECT(info[jss::last_rotated] == lastRotated);
+        BEAST_EXPECT(info[jss::copied_ledger] == ledgerSeq - 1);
+
+        {
+            env.close();
+
+            auto ledger = env.rpc("ledger", "validated");
+            BEAST_EXPECT(goodLedger(env, ledger, to_string(ledgerSeq++), true));
+        }
+
+        store.rendezvous();
+
+        ledgerCheck(env, ledgerSeq - lastRotated, lastRotated);
+        BEAST_EXPECT(store.getLastRotated() == ledgerSeq - 1);
+        lastRotated = ledgerSeq - 1;
+
+        // Everything funded before the rotation must have survived it
+        for (auto i = lastRotated - deleteInterval + 1; i < lastRotated; ++i)
+            BEAST_EXPECT(env.balance(Account("test" + to_string(i))) ==
+                XRP(10000));
+
+        info = env.rpc("server_info")[jss::result][jss::info];
+        BEAST_EXPECT(info.isMember(jss::online_delete));
+        BEAST_EXPECT(info[jss::online_delete][jss::last_rotated] ==
+            lastRotated);
+        BEAST_EXPECT(! info[jss::online_delete].isMember(
+            jss::copied_ledger));
+    }
+
     void run() override
     {
         testClear();
         testAutomatic();
         testCanDelete();
+        testIncremental();
     }
 };
 
@@ -0,0 +1,138 @@
+#include <test/jtx.h>
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/TrustLineGraph.h>
+
+namespace ripple {
+
+namespace test {
+
+class TrustLineGraph_test : public beast::unit_test::suite
+{
+    // The graph's lines for an account match a fresh read of the ledger
+    bool
+    matches (TrustLineGraph::Snapshot const& snapshot,
+        AccountID const& account, ReadView const& view)
+    {
+        auto const lines = snapshot.find (account);
+        if (! lines)
+            return false;
+
+        auto const expected = getRippleStateItems (account, view);
+        if (lines->size () != expected.size ())
+            return false;
+
+        for (std::size_t i = 0; i < expected.size (); ++i)
+        {
+            auto const& a = *(*lines)[i];
+            auto const& b = *expected[i];
+            if (a.key () != b.key () ||
+                a.getBalance () != b.getBalance () ||
+                a.getLimit () != b.getLimit () ||
+                a.getLimitPeer () != b.getLimitPeer () ||
+                a.getAccountIDPeer () != b.getAccountIDPeer ())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    void
+    testIncremental ()
+    {
+        testcase ("Incremental update");
+
+        using namespace jtx;
+        Env env (*this);
+
+        auto const gw = Account {"gateway"};
+        auto const alice = Account {"alice"};
+        auto const bob = Account {"bob"};
+        auto const carol = Account {"carol"};
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+
+        env.fund (XRP (10000), gw, alice, bob, carol);
+        env.trust (USD (1000), alice, bob, carol);
+        env.trust (EUR (1000), alice);
+        env.close ();
+
+        auto graph = std::make_shared<TrustLineGraph> (env.journal);
+        graph->onValidatedLedger (env.closed ());
+        BEAST_EXPECT (graph->current ()->seq () == env.closed ()->seq ());
+        BEAST_EXPECT (graph->current ()->size () == 0);
+
+        // Lines read through a cache on the validated ledger are shared
+        // in one batch when published
+        {
+            auto cache = std::make_shared<RippleLineCache> (
+                env.closed (), graph);
+            for (auto const& acct : {gw, alice, bob, carol})
+                cache->getRippleLines (acct);
+            auto const before = graph->current ();
+            BEAST_EXPECT (before->size () == 0);
+            cache->publish ();
+            BEAST_EXPECT (graph->current ()->size () == 4);
+            BEAST_EXPECT (before->size () == 0);
+            cache->publish ();
+            BEAST_EXPECT (graph->current ()->size () == 4);
+        }
+        BEAST_EXPECT (graph->current ()->size () == 4);
+
+        // A cache on the open ledger doesn't use the graph
+        {
+            auto cache = std::make_shared<RippleLineCache> (
+                env.current (), graph);
+            cache->getRippleLines (env.master);
+        }
+        BEAST_EXPECT (graph->current ()->size () == 4);
+
+        // Modify alice's lines, delete bob's and give carol a new one
+        env (pay (gw, alice, USD (10)));
+        env (pay (gw, alice, EUR (20)));
+        env (trust (bob, USD (0)));
+        env (trust (carol, EUR (500)));
+        env.close ();
+
+        graph->onValidatedLedger (env.closed ());
+        auto snapshot = graph->current ();
+        BEAST_EXPECT (snapshot->seq () == env.closed ()->seq ());
+        BEAST_EXPECT (matches (*snapshot, alice, *env.closed ()));
+        BEAST_EXPECT (matches (*snapshot, bob, *env.closed ()));
+        BEAST_EXPECT (snapshot->find (bob)->empty ());
+
+        // Accounts that gained a line are re-read on demand
+        BEAST_EXPECT (! snapshot->find (gw));
+        BEAST_EXPECT (! snapshot->find (carol));
+        {
+            auto cache = std::make_shared<RippleLineCache> (
+                env.closed (), graph);
+            BEAST_EXPECT (cache->getRippleLines (carol).size () == 2);
+        }
+        BEAST_EXPECT (matches (*graph->current (), carol, *env.closed ()));
+
+        // A skipped ledger starts the graph over
+        env (pay (gw, alice, USD (1)));
+        env.close ();
+        env.close ();
+        graph->onValidatedLedger (env.closed ());
+        BEAST_EXPECT (graph->current ()->seq () == env.closed ()->seq ());
+        BEAST_EXPECT (graph->current ()->size () == 0);
+
+        // Snapshots already handed out are unaffected
+        BEAST_EXPECT (matches (*snapshot, alice, *env.closed ()) == false);
+        BEAST_EXPECT (snapshot->find (alice)->size () == 2);
+    }
+
+    void
+    run () override
+    {
+        testIncremental ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE (TrustLineGraph, app, ripple);
+
+}
+}
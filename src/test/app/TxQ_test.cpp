@@ -1,6 +1,7 @@
 
 
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/tx/apply.h>
@@ -2607,6 +2608,93 @@ public:
 
 BEAST_DEFINE_TESTSUITE_PRIO(TxQ,app,ripple,1);
 
+// Queue 100k transactions from 10k accounts, then time the ledger closes
+// that drain the queue.
+class TxQBench_test : public beast::unit_test::suite
+{
+public:
+    void run() override
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        std::size_t const accounts = 10000;
+        std::size_t const perAccount = 10;
+        std::size_t const perLedger = 1000;
+
+        auto cfg = envconfig();
+        auto& section = cfg->section("transaction_queue");
+        section.set("minimum_txn_in_ledger_standalone",
+            std::to_string(perLedger));
+        section.set("target_txn_in_ledger", std::to_string(perLedger));
+        section.set("normal_consensus_increase_percent", "0");
+        section.set("minimum_queue_size",
+            std::to_string(accounts * perAccount));
+        section.set("maximum_txn_per_account", std::to_string(perAccount));
+        Env env(*this, std::move(cfg));
+
+        std::vector<Account> senders;
+        senders.reserve(accounts);
+        for (std::size_t i = 0; i < accounts; ++i)
+        {
+            senders.emplace_back("s" + std::to_string(i));
+            env.fund(XRP(1000), noripple(senders.back()));
+            if (i % (perLedger / 2) == 0)
+                env.close();
+        }
+        env.close();
+
+        // Sign up front so only the queue is timed
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve(accounts * perAccount);
+        for (std::size_t n = 0; n < perAccount; ++n)
+        {
+            for (auto const& a : senders)
+            {
+                auto const jt = env.jt(noop(a), seq(env.seq(a) + n));
+                forceValidity(env.app().getHashRouter(),
+                    jt.stx->getTransactionID(), Validity::Valid);
+                txs.push_back(jt.stx);
+            }
+        }
+
+        auto& txQ = env.app().getTxQ();
+        std::size_t queued = 0;
+        auto const start = steady_clock::now();
+        env.app().openLedger().modify(
+            [&](OpenView& view, beast::Journal j)
+            {
+                for (auto const& tx : txs)
+                    if (txQ.apply(env.app(), view, tx, tapNONE, j).first ==
+                            terQUEUED)
+                        ++queued;
+                return true;
+            });
+        auto const elapsed = duration_cast<microseconds>(
+            steady_clock::now() - start);
+
+        BEAST_EXPECT(txQ.getMetrics(*env.current()).txCount == queued);
+        log << queued << " of " << txs.size() << " queued in " <<
+            elapsed.count() / 1000 << "ms (" <<
+            txs.size() * 1000000 / std::max<std::int64_t>(
+                elapsed.count(), 1) << " tx/s)" << std::endl;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            auto const closeStart = steady_clock::now();
+            env.close();
+            auto const close = duration_cast<milliseconds>(
+                steady_clock::now() - closeStart);
+            auto const metrics = txQ.getMetrics(*env.current());
+            log << "close " << i << ": " << close.count() << "ms, " <<
+                metrics.txInLedger << " applied from queue, " <<
+                metrics.txCount << " still queued" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(TxQBench,app,ripple);
+
 }
 }
 
@@ -0,0 +1,139 @@
+#include <ripple/basics/CloseProfiler.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/beast/unit_test.h>
+#include <test/jtx.h>
+#include <string>
+
+namespace ripple {
+namespace perf {
+
+class CloseProfiler_test : public beast::unit_test::suite
+{
+    void
+    testScopes()
+    {
+        testcase("Scopes");
+
+        CloseProfiler profiler(4);
+        {
+            CloseProfiler::Scope outer(profiler, 10, "outer");
+            workCounters().slesRead += 3;
+            {
+                CloseProfiler::Scope inner(profiler, 10, "inner");
+                workCounters().nodesHashed += 5;
+                workCounters().nodesWritten += 2;
+            }
+        }
+
+        auto const events = profiler.getEvents(10);
+        if (! BEAST_EXPECT(events.size() == 2))
+            return;
+
+        // Inner scopes finish first
+        auto const& inner = events[0];
+        auto const& outer = events[1];
+        BEAST_EXPECT(std::string(inner.name) == "inner");
+        BEAST_EXPECT(std::string(outer.name) == "outer");
+        BEAST_EXPECT(inner.depth == outer.depth + 1);
+        BEAST_EXPECT(inner.thread == outer.thread);
+        BEAST_EXPECT(inner.start >= outer.start);
+        BEAST_EXPECT(inner.duration <= outer.duration);
+
+        BEAST_EXPECT(inner.work.nodesHashed == 5);
+        BEAST_EXPECT(inner.work.nodesWritten == 2);
+        BEAST_EXPECT(inner.work.slesRead == 0);
+        BEAST_EXPECT(outer.work.nodesHashed == 5);
+        BEAST_EXPECT(outer.work.nodesWritten == 2);
+        BEAST_EXPECT(outer.work.slesRead == 3);
+    }
+
+    void
+    testRing()
+    {
+        testcase("Ring");
+
+        CloseProfiler profiler(3);
+        for (std::uint32_t seq : {5, 7, 6, 8})
+            CloseProfiler::Scope scope(profiler, seq, "close");
+
+        // The oldest ledger made room for the newest
+        BEAST_EXPECT(profiler.getEvents(5).empty());
+        for (std::uint32_t seq : {6, 7, 8})
+            BEAST_EXPECT(profiler.getEvents(seq).size() == 1);
+
+        // A ledger older than all of those kept is dropped
+        {
+            CloseProfiler::Scope scope(profiler, 4, "late");
+        }
+        BEAST_EXPECT(profiler.getEvents(4).empty());
+
+        // A ledger still kept gains more phases
+        {
+            CloseProfiler::Scope scope(profiler, 6, "publish");
+        }
+        BEAST_EXPECT(profiler.getEvents(6).size() == 2);
+
+        auto const json = profiler.getJson(2);
+        auto const& events = json[jss::traceEvents];
+        if (! BEAST_EXPECT(events.isArray() && events.size() == 4))
+            return;
+
+        // Each ledger is named, then has its phases
+        BEAST_EXPECT(events[0u][jss::ph] == "M");
+        BEAST_EXPECT(events[0u][jss::pid] == 7);
+        BEAST_EXPECT(events[1u][jss::ph] == "X");
+        BEAST_EXPECT(events[1u][jss::name] == "close");
+        BEAST_EXPECT(events[1u][jss::pid] == 7);
+        BEAST_EXPECT(events[1u][jss::args].isMember(jss::nodes_hashed));
+        BEAST_EXPECT(events[3u][jss::pid] == 8);
+    }
+
+    void
+    testLedgerClose()
+    {
+        testcase("Ledger close");
+
+        using namespace test::jtx;
+        Env env(*this);
+        env.fund(XRP(10000), Account("alice"));
+        env.close();
+
+        auto const seq = env.closed()->info().seq;
+        auto const events = env.app().getCloseProfiler().getEvents(seq);
+        auto const find = [&events](std::string const& name)
+        {
+            for (auto const& e : events)
+            {
+                if (name == e.name)
+                    return &e;
+            }
+            return static_cast<CloseProfiler::Event const*>(nullptr);
+        };
+
+        auto const build = find("buildLedger");
+        auto const flush = find("flushDirty");
+        if (! BEAST_EXPECT(build && flush && find("applyTransactions")))
+            return;
+        BEAST_EXPECT(flush->depth == build->depth + 1);
+        BEAST_EXPECT(flush->work.nodesHashed > 0);
+        BEAST_EXPECT(build->work.nodesHashed >= flush->work.nodesHashed);
+        BEAST_EXPECT(build->work.slesRead > 0);
+
+        auto const result = env.rpc("ledger_profile");
+        BEAST_EXPECT(result[jss::result][jss::traceEvents].size() > 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testScopes();
+        testRing();
+        testLedgerClose();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CloseProfiler,basics,ripple);
+
+}
+}
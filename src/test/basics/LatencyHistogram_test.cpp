@@ -0,0 +1,121 @@
+#include <ripple/basics/LatencyHistogram.h>
+#include <ripple/beast/unit_test.h>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class LatencyHistogram_test : public beast::unit_test::suite
+{
+    void
+    testBuckets()
+    {
+        testcase("Buckets");
+
+        // Small durations are counted exactly
+        for (std::uint64_t us = 0; us < 64; ++us)
+        {
+            BEAST_EXPECT(LatencyHistogram::bucket(us) == us);
+            BEAST_EXPECT(LatencyHistogram::highest(us) == us);
+        }
+
+        // Larger ones are within 1/32 of the largest in their bucket
+        std::size_t prior = 0;
+        for (std::uint64_t us = 64; us < (std::uint64_t(1) << 32);
+            us += us / 7)
+        {
+            auto const b = LatencyHistogram::bucket(us);
+            auto const high = LatencyHistogram::highest(b);
+            BEAST_EXPECT(b >= prior);
+            BEAST_EXPECT(b < LatencyHistogram::bucketCount);
+            BEAST_EXPECT(high >= us);
+            BEAST_EXPECT(high - us <= us / 32);
+            BEAST_EXPECT(b == 0 || LatencyHistogram::highest(b - 1) < us);
+            prior = b;
+        }
+
+        // Beyond the range, durations share the last bucket
+        BEAST_EXPECT(LatencyHistogram::bucket(std::uint64_t(1) << 40) ==
+            LatencyHistogram::bucketCount - 1);
+    }
+
+    void
+    testPercentiles()
+    {
+        testcase("Percentiles");
+
+        using namespace std::chrono;
+        LatencyHistogram h;
+        BEAST_EXPECT(h.snapshot().count() == 0);
+        BEAST_EXPECT(h.snapshot().percentile(0.5) == 0);
+
+        for (int i = 0; i < 900; ++i)
+            h.insert(microseconds(3));
+        for (int i = 0; i < 90; ++i)
+            h.insert(microseconds(1000));
+        for (int i = 0; i < 10; ++i)
+            h.insert(seconds(2));
+
+        auto const snap = h.snapshot();
+        BEAST_EXPECT(snap.count() == 1000);
+        BEAST_EXPECT(snap.sum() == 900 * 3 + 90 * 1000 + 10 * 2000000);
+        BEAST_EXPECT(snap.max() == 2000000);
+        BEAST_EXPECT(snap.percentile(0.5) == 3);
+        BEAST_EXPECT(snap.percentile(0.9) == 3);
+        BEAST_EXPECT(snap.percentile(0.95) >= 1000);
+        BEAST_EXPECT(snap.percentile(0.95) <= 1000 + 1000 / 32);
+        BEAST_EXPECT(snap.percentile(0.999) == 2000000);
+
+        auto const jv = snap.getJson();
+        BEAST_EXPECT(jv["count"].asString() == "1000");
+        BEAST_EXPECT(jv["p50_us"].asString() == "3");
+        BEAST_EXPECT(jv["max_us"].asString() == "2000000");
+    }
+
+    void
+    testMerge()
+    {
+        testcase("Merge");
+
+        using namespace std::chrono;
+        LatencyHistogram fast;
+        LatencyHistogram slow;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]
+                {
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        fast.insert(microseconds(10));
+                        slow.insert(milliseconds(5));
+                    }
+                });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        auto snap = fast.snapshot();
+        BEAST_EXPECT(snap.count() == 4000);
+        BEAST_EXPECT(snap.percentile(0.99) == 10);
+
+        snap.merge(slow.snapshot());
+        BEAST_EXPECT(snap.count() == 8000);
+        BEAST_EXPECT(snap.sum() == 4000 * 10 + 4000 * 5000);
+        BEAST_EXPECT(snap.percentile(0.25) == 10);
+        BEAST_EXPECT(snap.percentile(0.75) == 5000);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBuckets();
+        testPercentiles();
+        testMerge();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LatencyHistogram,basics,ripple);
+
+}
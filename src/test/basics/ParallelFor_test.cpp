@@ -0,0 +1,101 @@
+#include <ripple/basics/contract.h>
+#include <ripple/basics/ParallelFor.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace ripple {
+
+class ParallelFor_test : public beast::unit_test::suite
+{
+    void
+    testAll()
+    {
+        testcase("All");
+
+        for (int threads : {0, 1, 4})
+        {
+            for (std::size_t n : {0, 1, 2, 1000})
+            {
+                std::vector<std::atomic<int>> calls(n);
+                for (auto& c : calls)
+                    c = 0;
+
+                BEAST_EXPECT(parallelFor(n, threads,
+                    [&](std::size_t i)
+                    {
+                        ++calls[i];
+                        return true;
+                    }));
+
+                bool once = true;
+                for (auto const& c : calls)
+                    once = once && c == 1;
+                BEAST_EXPECT(once);
+            }
+        }
+    }
+
+    void
+    testStop()
+    {
+        testcase("Stop");
+
+        for (int threads : {1, 4})
+        {
+            std::atomic<std::size_t> calls {0};
+            BEAST_EXPECT(! parallelFor(1000, threads,
+                [&](std::size_t i)
+                {
+                    ++calls;
+                    return i != 10;
+                }));
+
+            // Other workers may still be running, but the loop stops early
+            BEAST_EXPECT(calls > 10);
+            BEAST_EXPECT(calls < 1000);
+        }
+    }
+
+    void
+    testThrow()
+    {
+        testcase("Throw");
+
+        for (int threads : {1, 4})
+        {
+            std::atomic<std::size_t> calls {0};
+            try
+            {
+                parallelFor(1000, threads,
+                    [&](std::size_t i)
+                    {
+                        ++calls;
+                        if (i == 10)
+                            Throw<std::runtime_error>("stop");
+                        return true;
+                    });
+                fail();
+            }
+            catch (std::runtime_error const& e)
+            {
+                BEAST_EXPECT(std::string(e.what()) == "stop");
+            }
+            BEAST_EXPECT(calls < 1000);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testAll();
+        testStop();
+        testThrow();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelFor,basics,ripple);
+
+}
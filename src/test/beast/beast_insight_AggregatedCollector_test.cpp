@@ -0,0 +1,162 @@
+#include <ripple/beast/insight/Insight.h>
+#include <ripple/beast/unit_test.h>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace insight {
+
+class AggregatedCollector_test : public unit_test::suite
+{
+    static
+    std::shared_ptr <AggregatedCollector>
+    make (boost::optional <IP::Endpoint> const& address = boost::none)
+    {
+        using namespace std::chrono_literals;
+        return AggregatedCollector::New (
+            "node", 1h, address, Journal {Journal::getNullSink ()});
+    }
+
+    bool
+    contains (std::string const& text, std::string const& line)
+    {
+        return text.find (line + "\n") != std::string::npos;
+    }
+
+    void
+    testCounters ()
+    {
+        testcase ("Counters");
+
+        auto const collector = make ();
+        auto const counter = collector->make_counter ("rpc", "requests");
+        auto const meter = collector->make_meter ("bytes");
+        auto const other = collector->make_counter ("rpc.requests");
+
+        BEAST_EXPECT(collector->prometheus ().empty ());
+
+        std::vector <std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back ([&]
+                {
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        counter.increment (1);
+                        meter.increment (3);
+                    }
+                });
+        }
+        for (auto& t : threads)
+            t.join ();
+        other.increment (5);
+
+        // Totals are cumulative across snapshots
+        collector->flush ();
+        collector->flush ();
+        auto const text = collector->prometheus ();
+        BEAST_EXPECT(contains (text, "# TYPE node_rpc_requests counter"));
+        BEAST_EXPECT(contains (text, "node_rpc_requests 4005"));
+        BEAST_EXPECT(contains (text, "node_bytes 12000"));
+    }
+
+    void
+    testGauges ()
+    {
+        testcase ("Gauges");
+
+        auto const collector = make ();
+        auto const gauge = collector->make_gauge ("peers");
+        int calls = 0;
+        auto const hook = collector->make_hook ([&]
+            {
+                ++calls;
+                gauge.set (10);
+            });
+
+        collector->flush ();
+        BEAST_EXPECT(calls == 1);
+        BEAST_EXPECT(contains (collector->prometheus (), "node_peers 10"));
+
+        gauge.increment (-20);
+        BEAST_EXPECT(gauge.impl ());
+        collector->flush ();
+        BEAST_EXPECT(calls == 2);
+        BEAST_EXPECT(contains (collector->prometheus (), "node_peers 10"));
+    }
+
+    void
+    testEvents ()
+    {
+        testcase ("Events");
+
+        using namespace std::chrono;
+        auto const collector = make ();
+        auto const event = collector->make_event ("rpc", "time");
+
+        event.notify (milliseconds (0));
+        event.notify (milliseconds (2));
+        event.notify (milliseconds (3));
+        event.notify (milliseconds (4));
+        event.notify (hours (1));
+        collector->flush ();
+
+        auto const text = collector->prometheus ();
+        BEAST_EXPECT(contains (text, "# TYPE node_rpc_time histogram"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_bucket{le=\"1\"} 1"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_bucket{le=\"2\"} 2"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_bucket{le=\"4\"} 4"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_bucket{le=\"524288\"} 4"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_bucket{le=\"+Inf\"} 5"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_sum 3600009"));
+        BEAST_EXPECT(contains (text, "node_rpc_time_count 5"));
+    }
+
+    void
+    testExport ()
+    {
+        testcase ("Export");
+
+        using namespace boost::asio;
+        io_service ios;
+        ip::udp::socket socket (ios, ip::udp::endpoint (
+            ip::address_v4::loopback (), 0));
+        auto const local = socket.local_endpoint ();
+
+        auto const collector = make (IP::Endpoint (
+            local.address (), local.port ()));
+        auto const counter = collector->make_counter ("c");
+        auto const gauge = collector->make_gauge ("g");
+        counter.increment (-2);
+        gauge.set (300);
+        collector->flush ();
+
+        std::array <unsigned char, 1500> buffer;
+        auto const n = socket.receive (boost::asio::buffer (buffer));
+
+        std::vector <unsigned char> const expected {
+            1, 1, 4, 'n', 'o', 'd', 'e',
+            0, 1, 'c', 3,
+            1, 1, 'g', 0xac, 0x02};
+        BEAST_EXPECT(std::vector <unsigned char> (
+            buffer.begin (), buffer.begin () + n) == expected);
+    }
+
+public:
+    void
+    run () override
+    {
+        testCounters ();
+        testGauges ();
+        testEvents ();
+        testExport ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AggregatedCollector,insight,beast);
+
+}
+}
@@ -806,6 +806,78 @@ public:
         BEAST_EXPECT(sim.synchronized());
     }
 
+    void
+    testPipelinedAccept()
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        // Writing each ledger takes longer as more transactions arrive.
+        // With a pipeline the next round opens while it is written, so
+        // more ledgers close in the same time. Each ledger is only saved
+        // once its write, and the writes before it, finish.
+        struct Result
+        {
+            int completed;
+            int saved;
+            SimDuration maxSaveDelay;
+        };
+
+        auto const run = [this](bool pipelined)
+        {
+            ConsensusParms const parms{};
+            Sim sim;
+            PeerGroup network = sim.createGroup(5);
+            network.trustAndConnect(
+                network, date::round<milliseconds>(0.2 * parms.ledgerGRANULARITY));
+
+            for (Peer* p : network)
+            {
+                p->delays.ledgerWritePerTx = 5ms;
+                p->delays.pipelined = pipelined;
+            }
+
+            sim.run(1);
+
+            SimDuration const simDuration = 60s;
+            Rate const rate{100, 1s};
+            auto peerSelector = makeSelector(
+                network.begin(),
+                network.end(),
+                std::vector<double>(network.size(), 1.),
+                sim.rng);
+            auto txSubmitter = makeSubmitter(
+                ConstantDistribution{rate.inv()},
+                sim.scheduler.now(),
+                sim.scheduler.now() + simDuration,
+                peerSelector,
+                sim.scheduler,
+                sim.rng);
+
+            sim.run(simDuration);
+
+            BEAST_EXPECT(sim.synchronized());
+            BEAST_EXPECT(sim.branches() == 1);
+            Peer const& peer = *network[0];
+            return Result{peer.completedLedgers, peer.savedLedgers,
+                peer.maxSaveDelay};
+        };
+
+        auto const serial = run(false);
+        BEAST_EXPECT(serial.saved == serial.completed);
+        BEAST_EXPECT(serial.maxSaveDelay == SimDuration{0});
+
+        // The writes keep up, but saving waits for them
+        auto const pipelined = run(true);
+        BEAST_EXPECT(pipelined.saved <= pipelined.completed);
+        BEAST_EXPECT(pipelined.saved + 1 >= pipelined.completed);
+        BEAST_EXPECT(pipelined.maxSaveDelay > SimDuration{0});
+
+        log << "Ledgers closed in 60s: " << serial.completed << " serial, "
+            << pipelined.completed << " pipelined" << std::endl;
+        BEAST_EXPECT(pipelined.completed > serial.completed);
+    }
+
     void
     run() override
     {
@@ -822,6 +894,7 @@ public:
         testHubNetwork();
         testPreferredByBranch();
         testPauseForLaggards();
+        testPipelinedAccept();
     }
 };
 
@@ -1,6 +1,8 @@
 
 #include <ripple/beast/unit_test.h>
 #include <ripple/consensus/LedgerTrie.h>
+#include <chrono>
+#include <memory>
 #include <random>
 #include <test/csf/ledgers.h>
 #include <unordered_map>
@@ -8,6 +10,323 @@
 namespace ripple {
 namespace test {
 
+// The trie with a node allocation per span, which the flat trie replaced.
+// Kept to check that the two agree.
+namespace reference {
+
+template <class Ledger>
+struct Node
+{
+    Node() = default;
+
+    explicit Node(Ledger const& l) : span{l}, tipSupport{1}, branchSupport{1}
+    {
+    }
+
+    explicit Node(ledger_trie_detail::Span<Ledger> s) : span{std::move(s)}
+    {
+    }
+
+    ledger_trie_detail::Span<Ledger> span;
+    std::uint32_t tipSupport = 0;
+    std::uint32_t branchSupport = 0;
+
+    std::vector<std::unique_ptr<Node>> children;
+    Node* parent = nullptr;
+
+    
+    void
+    erase(Node const* child)
+    {
+        auto it = std::find_if(
+            children.begin(),
+            children.end(),
+            [child](std::unique_ptr<Node> const& curr) {
+                return curr.get() == child;
+            });
+        assert(it != children.end());
+        std::swap(*it, children.back());
+        children.pop_back();
+    }
+};
+
+template <class Ledger>
+class LedgerTrie
+{
+    using Seq = typename Ledger::Seq;
+    using ID = typename Ledger::ID;
+
+    using Node = reference::Node<Ledger>;
+    using Span = ledger_trie_detail::Span<Ledger>;
+
+    std::unique_ptr<Node> root;
+
+    std::map<Seq, std::uint32_t> seqSupport;
+
+    
+    std::pair<Node*, Seq>
+    find(Ledger const& ledger) const
+    {
+        Node* curr = root.get();
+
+        assert(curr);
+        Seq pos = curr->span.diff(ledger);
+
+        bool done = false;
+
+        while (!done && pos == curr->span.end())
+        {
+            done = true;
+            for (std::unique_ptr<Node> const& child : curr->children)
+            {
+                auto const childPos = child->span.diff(ledger);
+                if (childPos > pos)
+                {
+                    done = false;
+                    pos = childPos;
+                    curr = child.get();
+                    break;
+                }
+            }
+        }
+        return std::make_pair(curr, pos);
+    }
+
+    
+    Node*
+    findByLedgerID(Ledger const& ledger, Node* parent = nullptr) const
+    {
+        if (!parent)
+            parent = root.get();
+        if (ledger.id() == parent->span.tip().id)
+            return parent;
+        for (auto const& child : parent->children)
+        {
+            auto cl = findByLedgerID(ledger, child.get());
+            if (cl)
+                return cl;
+        }
+        return nullptr;
+    }
+
+public:
+    LedgerTrie() : root{std::make_unique<Node>()}
+    {
+    }
+
+    
+    void
+    insert(Ledger const& ledger, std::uint32_t count = 1)
+    {
+        Node* loc;
+        Seq diffSeq;
+        std::tie(loc, diffSeq) = find(ledger);
+
+        assert(loc);
+
+        Node* incNode = loc;
+
+
+        boost::optional<Span> prefix = loc->span.before(diffSeq);
+        boost::optional<Span> oldSuffix = loc->span.from(diffSeq);
+        boost::optional<Span> newSuffix = Span{ledger}.from(diffSeq);
+
+        if (oldSuffix)
+        {
+
+            auto newNode = std::make_unique<Node>(*oldSuffix);
+            newNode->tipSupport = loc->tipSupport;
+            newNode->branchSupport = loc->branchSupport;
+            newNode->children = std::move(loc->children);
+            assert(loc->children.empty());
+            for (std::unique_ptr<Node>& child : newNode->children)
+                child->parent = newNode.get();
+
+            assert(prefix);
+            loc->span = *prefix;
+            newNode->parent = loc;
+            loc->children.emplace_back(std::move(newNode));
+            loc->tipSupport = 0;
+        }
+        if (newSuffix)
+        {
+
+            auto newNode = std::make_unique<Node>(*newSuffix);
+            newNode->parent = loc;
+            incNode = newNode.get();
+            loc->children.push_back(std::move(newNode));
+        }
+
+        incNode->tipSupport += count;
+        while (incNode)
+        {
+            incNode->branchSupport += count;
+            incNode = incNode->parent;
+        }
+
+        seqSupport[ledger.seq()] += count;
+    }
+
+    
+    bool
+    remove(Ledger const& ledger, std::uint32_t count = 1)
+    {
+        Node* loc = findByLedgerID(ledger);
+        if (!loc || loc->tipSupport == 0)
+            return false;
+
+        count = std::min(count, loc->tipSupport);
+        loc->tipSupport -= count;
+
+        auto const it = seqSupport.find(ledger.seq());
+        assert(it != seqSupport.end() && it->second >= count);
+        it->second -= count;
+        if (it->second == 0)
+            seqSupport.erase(it->first);
+
+        Node* decNode = loc;
+        while (decNode)
+        {
+            decNode->branchSupport -= count;
+            decNode = decNode->parent;
+        }
+
+        while (loc->tipSupport == 0 && loc != root.get())
+        {
+            Node* parent = loc->parent;
+            if (loc->children.empty())
+            {
+                parent->erase(loc);
+            }
+            else if (loc->children.size() == 1)
+            {
+                std::unique_ptr<Node> child =
+                    std::move(loc->children.front());
+                child->span = merge(loc->span, child->span);
+                child->parent = parent;
+                parent->children.emplace_back(std::move(child));
+                parent->erase(loc);
+            }
+            else
+                break;
+            loc = parent;
+        }
+        return true;
+    }
+
+    
+    std::uint32_t
+    tipSupport(Ledger const& ledger) const
+    {
+        if (auto const* loc = findByLedgerID(ledger))
+            return loc->tipSupport;
+        return 0;
+    }
+
+    
+    std::uint32_t
+    branchSupport(Ledger const& ledger) const
+    {
+        Node const* loc = findByLedgerID(ledger);
+        if (!loc)
+        {
+            Seq diffSeq;
+            std::tie(loc, diffSeq) = find(ledger);
+            if (! (diffSeq > ledger.seq() && ledger.seq() < loc->span.end()))
+                loc = nullptr;
+        }
+        return loc ? loc->branchSupport : 0;
+    }
+
+    
+    boost::optional<SpanTip<Ledger>>
+    getPreferred(Seq const largestIssued) const
+    {
+        if (empty())
+            return boost::none;
+
+        Node* curr = root.get();
+
+        bool done = false;
+
+        std::uint32_t uncommitted = 0;
+        auto uncommittedIt = seqSupport.begin();
+
+        while (curr && !done)
+        {
+            {
+                Seq nextSeq = curr->span.start() + Seq{1};
+                while (uncommittedIt != seqSupport.end() &&
+                       uncommittedIt->first < std::max(nextSeq, largestIssued))
+                {
+                    uncommitted += uncommittedIt->second;
+                    uncommittedIt++;
+                }
+
+                while (nextSeq < curr->span.end() &&
+                       curr->branchSupport > uncommitted)
+                {
+                    if (uncommittedIt != seqSupport.end() &&
+                        uncommittedIt->first < curr->span.end())
+                    {
+                        nextSeq = uncommittedIt->first + Seq{1};
+                        uncommitted += uncommittedIt->second;
+                        uncommittedIt++;
+                    }
+                    else  
+                        nextSeq = curr->span.end();
+                }
+                if (nextSeq < curr->span.end())
+                    return curr->span.before(nextSeq)->tip();
+            }
+
+            Node* best = nullptr;
+            std::uint32_t margin = 0;
+            if (curr->children.size() == 1)
+            {
+                best = curr->children[0].get();
+                margin = best->branchSupport;
+            }
+            else if (!curr->children.empty())
+            {
+                std::partial_sort(
+                    curr->children.begin(),
+                    curr->children.begin() + 2,
+                    curr->children.end(),
+                    [](std::unique_ptr<Node> const& a,
+                       std::unique_ptr<Node> const& b) {
+                        return std::make_tuple(
+                                   a->branchSupport, a->span.startID()) >
+                            std::make_tuple(
+                                   b->branchSupport, b->span.startID());
+                    });
+
+                best = curr->children[0].get();
+                margin = curr->children[0]->branchSupport -
+                    curr->children[1]->branchSupport;
+
+                if (best->span.startID() > curr->children[1]->span.startID())
+                    margin++;
+            }
+
+            if (best && ((margin > uncommitted) || (uncommitted == 0)))
+                curr = best;
+            else  
+                done = true;
+        }
+        return curr->span.tip();
+    }
+
+    
+    bool
+    empty() const
+    {
+        return !root || root->branchSupport == 0;
+    }
+};
+
+}
+
 class LedgerTrie_test : public beast::unit_test::suite
 {
     void
@@ -557,6 +876,80 @@ class LedgerTrie_test : public beast::unit_test::suite
         }
     }
 
+    // Random inserts and removes of ledgers on random forks, applied to the
+    // flat trie and the reference one with every query compared after each
+    void
+    testEquivalence(std::uint32_t seed)
+    {
+        testcase("Equivalence, seed " + std::to_string(seed));
+
+        using namespace csf;
+        using Seq = Ledger::Seq;
+
+        LedgerOracle oracle;
+        std::mt19937 gen{seed};
+
+        std::vector<Ledger> ledgers{Ledger{Ledger::MakeGenesis{}}};
+        for (std::uint32_t i = 1; i < 200; ++i)
+        {
+            // Mostly extend recent ledgers, sometimes fork old ones
+            std::uniform_int_distribution<std::size_t> parentDist(
+                ledgers.size() > 10 && i % 4 ? ledgers.size() - 10 : 0,
+                ledgers.size() - 1);
+            ledgers.push_back(oracle.accept(ledgers[parentDist(gen)], Tx{i}));
+        }
+
+        Seq maxSeq{0};
+        for (auto const& l : ledgers)
+            maxSeq = std::max(maxSeq, l.seq());
+
+        LedgerTrie<Ledger> t;
+        reference::LedgerTrie<Ledger> ref;
+
+        auto const agree = [&]() {
+            for (auto const& l : ledgers)
+            {
+                if (t.tipSupport(l) != ref.tipSupport(l) ||
+                    t.branchSupport(l) != ref.branchSupport(l))
+                    return false;
+            }
+            for (Seq s{0}; s <= maxSeq + Seq{1}; s = s + Seq{3})
+            {
+                // The second query is answered from the cache
+                for (int i = 0; i < 2; ++i)
+                {
+                    auto const a = t.getPreferred(s);
+                    auto const b = ref.getPreferred(s);
+                    if (bool(a) != bool(b) ||
+                        (a && (a->seq != b->seq || a->id != b->id)))
+                        return false;
+                }
+            }
+            return t.empty() == ref.empty() && t.checkInvariants();
+        };
+
+        std::uniform_int_distribution<std::size_t> ledgerDist(
+            0, ledgers.size() - 1);
+        std::uniform_int_distribution<std::uint32_t> countDist(1, 3);
+        std::uniform_int_distribution<> flip(0, 2);
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto const& l = ledgers[ledgerDist(gen)];
+            auto const count = countDist(gen);
+            if (flip(gen) != 0)
+            {
+                t.insert(l, count);
+                ref.insert(l, count);
+            }
+            else
+            {
+                BEAST_EXPECT(t.remove(l, count) == ref.remove(l, count));
+            }
+            if (!BEAST_EXPECT(agree()))
+                return;
+        }
+    }
+
     void
     run() override
     {
@@ -567,10 +960,97 @@ class LedgerTrie_test : public beast::unit_test::suite
         testGetPreferred();
         testRootRelated();
         testStress();
+        for (std::uint32_t seed : {1, 2, 3})
+            testEquivalence(seed);
     }
 };
 
 BEAST_DEFINE_TESTSUITE(LedgerTrie, consensus, ripple);
+
+// 1000 validators moving to the next ledger every round, a tenth of them to
+// a fork which loses, with the preferred ledger asked for as validations
+// arrive and repeatedly between rounds
+class LedgerTrieBench_test : public beast::unit_test::suite
+{
+    using Ledger = csf::Ledger;
+
+    std::size_t static constexpr validators = 1000;
+    std::size_t static constexpr rounds = 200;
+    std::size_t static constexpr queries = 1000;
+
+    csf::LedgerOracle oracle_;
+    std::vector<Ledger> main_;
+    std::vector<Ledger> forks_;
+    std::vector<bool> onFork_;
+
+    template <class Trie>
+    Ledger::ID
+    measure(std::string const& name)
+    {
+        using namespace std::chrono;
+
+        Trie trie;
+        std::vector<Ledger const*> last(validators, nullptr);
+        Ledger::ID preferred{0};
+        auto const prefer = [&](Ledger::Seq seq) {
+            if (auto const tip = trie.getPreferred(seq))
+                preferred = tip->id;
+        };
+
+        auto const start = steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            for (std::size_t v = 0; v < validators; ++v)
+            {
+                auto const& next =
+                    onFork_[r * validators + v] ? forks_[r] : main_[r];
+                if (last[v])
+                    trie.remove(*last[v]);
+                trie.insert(next);
+                last[v] = &next;
+
+                if (v % 100 == 99)
+                    prefer(main_[r].seq());
+            }
+
+            for (std::size_t q = 0; q < queries; ++q)
+                prefer(main_[r].seq());
+        }
+        auto const elapsed = duration_cast<microseconds>(
+            steady_clock::now() - start).count();
+
+        auto const ops = rounds * (validators * 2 + validators / 100 + queries);
+        log << name << ": " << elapsed / 1000 << "ms, " <<
+            ops * 1000000 / std::max<std::int64_t>(elapsed, 1) <<
+            " operations/s" << std::endl;
+        return preferred;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<> tenth(0, 9);
+
+        Ledger parent{Ledger::MakeGenesis{}};
+        for (std::uint32_t r = 0; r < rounds; ++r)
+        {
+            main_.push_back(oracle_.accept(parent, csf::Tx{2 * r}));
+            forks_.push_back(oracle_.accept(parent, csf::Tx{2 * r + 1}));
+            parent = main_.back();
+        }
+        for (std::size_t i = 0; i < rounds * validators; ++i)
+            onFork_.push_back(tenth(gen) == 0);
+
+        auto const flat = measure<LedgerTrie<Ledger>>("flat");
+        auto const ref = measure<reference::LedgerTrie<Ledger>>("reference");
+        BEAST_EXPECT(flat == ref);
+        BEAST_EXPECT(flat == main_.back().id());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LedgerTrieBench, consensus, ripple);
 }  
 }  
 
@@ -0,0 +1,275 @@
+#include <ripple/beast/unit_test.h>
+#include <test/csf.h>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Consensus performance of a large simulated network.
+
+    A few validators, trusted by every peer, run consensus with many
+    tracking peers over a random network whose link delays are log-normally
+    distributed. Transactions arrive as a Poisson process. Each round
+    records how long the network took to close and to fully validate the
+    ledger, and the wall time peers spent in Consensus and Validations.
+
+    Args are "peers validators degree latencyMs txPerSec seconds writeUsPerTx
+    pipelined". The last two model the time to write each accepted ledger
+    and whether the next round opens while it is written. One row per round
+    is appended to PerformanceSim_rounds.csv, so runs before and after a
+    change to the consensus code can be compared.
+*/
+class PerformanceSim_test : public beast::unit_test::suite
+{
+    struct Config
+    {
+        std::size_t peers = 500;
+        std::size_t validators = 35;
+        std::size_t degree = 6;
+        std::size_t latencyMs = 50;
+        std::size_t txPerSec = 20;
+        std::size_t seconds = 120;
+        std::size_t writeUsPerTx = 0;
+        bool pipelined = false;
+    };
+
+    // Latencies and costs of each round, by ledger sequence
+    class RoundCollector
+    {
+        struct Round
+        {
+            std::size_t accepted = 0;
+            csf::SimTime firstAccept;
+            csf::SimTime lastAccept;
+            std::size_t validated = 0;
+            csf::SimTime firstValid;
+            csf::SimTime lastValid;
+            std::chrono::nanoseconds consensus{0};
+            std::chrono::nanoseconds validations{0};
+        };
+
+        struct Spent
+        {
+            std::chrono::nanoseconds consensus{0};
+            std::chrono::nanoseconds validations{0};
+        };
+
+        // Indexed by peer ID
+        std::vector<csf::Peer const*> peers_;
+        std::vector<Spent> spent_;
+        std::map<csf::Ledger::Seq, Round> rounds_;
+
+    public:
+        explicit RoundCollector(csf::PeerGroup const& peers)
+            : peers_(peers.size()), spent_(peers.size())
+        {
+            for (csf::Peer const* peer : peers)
+                peers_.at(static_cast<std::uint32_t>(peer->id)) = peer;
+        }
+
+        template <class E>
+        void
+        on(csf::PeerID, csf::SimTime, E const&)
+        {
+        }
+
+        // A round is charged with what its peer spent since its last accept
+        void
+        on(csf::PeerID who, csf::SimTime when, csf::AcceptLedger const& e)
+        {
+            auto& round = rounds_[e.ledger.seq()];
+            if (round.accepted++ == 0)
+                round.firstAccept = when;
+            round.lastAccept = when;
+
+            auto const i = static_cast<std::uint32_t>(who);
+            auto const& cpu = peers_[i]->cpu;
+            round.consensus += cpu.consensus.total - spent_[i].consensus;
+            round.validations +=
+                cpu.validations.total - spent_[i].validations;
+            spent_[i] = {cpu.consensus.total, cpu.validations.total};
+        }
+
+        void
+        on(csf::PeerID, csf::SimTime when, csf::FullyValidateLedger const& e)
+        {
+            auto& round = rounds_[e.ledger.seq()];
+            if (round.validated++ == 0)
+                round.firstValid = when;
+            round.lastValid = when;
+        }
+
+        std::size_t
+        size() const
+        {
+            return rounds_.size();
+        }
+
+        template <class T, class Tag>
+        void
+        csv(T& log, Tag const& tag, bool printHeaders = false) const
+        {
+            using namespace std::chrono;
+            auto const ms = [](csf::SimDuration d) {
+                return duration_cast<duration<double, std::milli>>(d).count();
+            };
+            auto const us = [](nanoseconds d, std::size_t n) {
+                return n ? duration<double, std::micro>(d).count() / n : 0.0;
+            };
+
+            if (printHeaders)
+            {
+                log << "tag" << ","
+                    << "seq" << ","
+                    << "accepted" << ","
+                    << "closeIntervalMs" << ","
+                    << "acceptSpreadMs" << ","
+                    << "validated" << ","
+                    << "firstValidMs" << ","
+                    << "lastValidMs" << ","
+                    << "consensusUsPerPeer" << ","
+                    << "validationsUsPerPeer"
+                    << std::endl;
+            }
+
+            boost::optional<csf::SimTime> prior;
+            for (auto const& it : rounds_)
+            {
+                Round const& r = it.second;
+                log << tag << ","
+                    << it.first << ","
+                    << r.accepted << ","
+                    << (prior ? ms(r.firstAccept - *prior) : 0.0) << ","
+                    << ms(r.lastAccept - r.firstAccept) << ","
+                    << r.validated << ","
+                    << (r.validated ? ms(r.firstValid - r.firstAccept) : 0.0)
+                    << ","
+                    << (r.validated ? ms(r.lastValid - r.firstAccept) : 0.0)
+                    << ","
+                    << us(r.consensus, r.accepted) << ","
+                    << us(r.validations, r.accepted)
+                    << std::endl;
+                prior = r.firstAccept;
+            }
+        }
+    };
+
+    void
+    simulate(Config const& config, bool printHeaders)
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        std::string const tag = std::to_string(config.peers) + "_" +
+            std::to_string(config.validators) + "_" +
+            std::to_string(config.degree) + "_" +
+            std::to_string(config.latencyMs) + "_" +
+            std::to_string(config.txPerSec) + "_" +
+            std::to_string(config.writeUsPerTx) +
+            (config.pipelined ? "_pipelined" : "");
+        std::fstream roundLog(
+            "PerformanceSim_rounds.csv", std::ofstream::app);
+
+        log << "PerformanceSim(" << tag << ")" << std::endl;
+
+        if (!BEAST_EXPECT(
+                config.validators >= 1 &&
+                config.validators <= config.peers && config.degree >= 1))
+            return;
+
+        Sim sim;
+        PeerGroup validators = sim.createGroup(config.validators);
+        PeerGroup trackers = sim.createGroup(config.peers - config.validators);
+        PeerGroup network = validators + trackers;
+
+        for (Peer* peer : trackers)
+            peer->runAsValidator = false;
+        for (Peer* peer : network)
+        {
+            peer->delays.ledgerWritePerTx =
+                microseconds(config.writeUsPerTx);
+            peer->delays.pipelined = config.pipelined;
+        }
+        network.trust(validators);
+
+        // Most links are fast, with a long tail of slow ones
+        std::lognormal_distribution<double> latency{
+            std::log(static_cast<double>(config.latencyMs)), 0.5};
+        validators.connect(validators, latency, sim.rng);
+        randomConnect(network, config.degree, latency, sim.rng);
+
+        TxCollector txCollector;
+        LedgerCollector ledgerCollector;
+        RoundCollector roundCollector{network};
+        auto colls = makeCollectors(txCollector, ledgerCollector, roundCollector);
+        sim.collectors.add(colls);
+
+        SimDuration const simDuration = seconds(config.seconds);
+        SimDuration const quiet = 10s;
+
+        auto peerSelector = makeSelector(
+            network.begin(),
+            network.end(),
+            std::vector<double>(network.size(), 1.),
+            sim.rng);
+        auto txSubmitter = makeSubmitter(
+            std::exponential_distribution<double>{
+                config.txPerSec / double(SimDuration{1s}.count())},
+            sim.scheduler.now() + quiet,
+            sim.scheduler.now() + simDuration - quiet,
+            peerSelector,
+            sim.scheduler,
+            sim.rng);
+
+        auto const start = steady_clock::now();
+        sim.run(simDuration);
+        auto const wall = steady_clock::now() - start;
+
+        BEAST_EXPECT(sim.branches() == 1);
+        BEAST_EXPECT(sim.synchronized());
+
+        log << std::right;
+        log << "| Peers: " << std::setw(5) << network.size();
+        log << " | Rounds: " << std::setw(4) << roundCollector.size();
+        log << " | Branches: " << std::setw(1) << sim.branches();
+        log << " | Synchronized: " << std::setw(1)
+            << (sim.synchronized() ? "Y" : "N");
+        log << " | Wall: " << std::setw(6)
+            << duration_cast<milliseconds>(wall).count() << " ms";
+        log << " |" << std::endl;
+
+        txCollector.report(simDuration, log, true);
+        ledgerCollector.report(simDuration, log, false);
+
+        roundCollector.csv(roundLog, tag, printHeaders);
+
+        log << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        Config config;
+        std::stringstream argStream(arg());
+        argStream >> config.peers >> config.validators >> config.degree >>
+            config.latencyMs >> config.txPerSec >> config.seconds >>
+            config.writeUsPerTx >> config.pipelined;
+
+        simulate(config, true);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL_PRIO(PerformanceSim, consensus, ripple, 2);
+
+}
+}
@@ -6,7 +6,10 @@
 #include <ripple/consensus/Validations.h>
 #include <test/csf/Validation.h>
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -1012,6 +1015,119 @@ class Validations_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testPendingDrain()
+    {
+        using namespace std::chrono_literals;
+        testcase("Pending validations");
+
+        // Enough nodes to use every shard, each adding validations the
+        // trie only picks up when next read
+        LedgerHistoryHelper h;
+        TestHarness harness(h.oracle);
+        std::vector<Node> nodes;
+        for (int i = 0; i < 40; ++i)
+            nodes.push_back(harness.makeNode());
+
+        Ledger ledgerA = h["a"];
+        Ledger ledgerAB = h["ab"];
+        Ledger ledgerABC = h["abc"];
+        Ledger ledgerABCD = h["abcd"];
+        Ledger ledgerABE = h["abe"];
+        Ledger ledgerABEF = h["abef"];
+
+        auto& vals = harness.vals();
+        for (auto const& node : nodes)
+            BEAST_EXPECT(
+                ValStatus::current == harness.add(node.validate(ledgerAB)));
+        BEAST_EXPECT(vals.getNodesAfter(ledgerA, ledgerA.id()) == 40);
+        BEAST_EXPECT(
+            vals.getPreferred(genesisLedger) ==
+            std::make_pair(ledgerAB.seq(), ledgerAB.id()));
+
+        // A node validating twice between reads moves straight to the
+        // later ledger
+        harness.clock().advance(5s);
+        for (std::size_t i = 0; i < nodes.size(); i += 2)
+            BEAST_EXPECT(ValStatus::current ==
+                harness.add(nodes[i].validate(ledgerABC)));
+        harness.clock().advance(1s);
+        for (std::size_t i = 0; i < nodes.size(); i += 2)
+            BEAST_EXPECT(ValStatus::current ==
+                harness.add(nodes[i].validate(ledgerABCD)));
+        for (std::size_t i = 3; i < nodes.size(); i += 2)
+            BEAST_EXPECT(ValStatus::current ==
+                harness.add(nodes[i].validate(ledgerABE)));
+
+        BEAST_EXPECT(vals.getNodesAfter(ledgerAB, ledgerAB.id()) == 39);
+        BEAST_EXPECT(vals.getNodesAfter(ledgerABC, ledgerABC.id()) == 20);
+        BEAST_EXPECT(vals.getNodesAfter(ledgerABCD, ledgerABCD.id()) == 0);
+        BEAST_EXPECT(vals.getNodesAfter(ledgerABE, ledgerABE.id()) == 0);
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerABCD.id()) == 20);
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerABE.id()) == 19);
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerAB.id()) == 40);
+
+        // Flushing brings the trie up to date before the current
+        // validations are handed off
+        harness.clock().advance(5s);
+        for (std::size_t i = 3; i < nodes.size(); i += 2)
+            BEAST_EXPECT(ValStatus::current ==
+                harness.add(nodes[i].validate(ledgerABEF)));
+        vals.flush();
+
+        BEAST_EXPECT(harness.flushed().size() == 40);
+        BEAST_EXPECT(vals.currentTrusted().empty());
+        BEAST_EXPECT(vals.getNodesAfter(ledgerABE, ledgerABE.id()) == 19);
+        BEAST_EXPECT(vals.getNodesAfter(ledgerABC, ledgerABC.id()) == 20);
+    }
+
+    void
+    testTrustedCounts()
+    {
+        testcase("Trusted counts");
+
+        LedgerHistoryHelper h;
+        TestHarness harness(h.oracle);
+        std::vector<Node> nodes;
+        for (int i = 0; i < 40; ++i)
+            nodes.push_back(harness.makeNode());
+        for (std::size_t i = 30; i < nodes.size(); ++i)
+            nodes[i].untrust();
+
+        Ledger ledgerA = h["a"];
+        auto& vals = harness.vals();
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            // Partial validations are never counted
+            auto const v = i < 5 ? nodes[i].partial(ledgerA)
+                                 : nodes[i].validate(ledgerA);
+            BEAST_EXPECT(ValStatus::current == harness.add(v));
+        }
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerA.id()) == 25);
+
+        auto const ids = [&nodes](std::size_t first, std::size_t last) {
+            hash_set<PeerID> res;
+            for (std::size_t i = first; i < last; ++i)
+                res.insert(nodes[i].nodeID());
+            return res;
+        };
+
+        vals.trustChanged(ids(30, 35), ids(0, 10));
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerA.id()) == 25);
+        BEAST_EXPECT(vals.getTrustedForLedger(ledgerA.id()).size() == 25);
+
+        vals.trustChanged(ids(35, 40), ids(30, 35));
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerA.id()) == 25);
+
+        vals.trustChanged(ids(0, 10), {});
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerA.id()) == 30);
+        BEAST_EXPECT(vals.getTrustedForLedger(ledgerA.id()).size() == 30);
+
+        vals.trustChanged({}, ids(0, 40));
+        BEAST_EXPECT(vals.numTrustedForLedger(ledgerA.id()) == 0);
+        BEAST_EXPECT(vals.getTrustedForLedger(ledgerA.id()).empty());
+    }
+
     void
     run() override
     {
@@ -1029,10 +1145,143 @@ class Validations_test : public beast::unit_test::suite
         testNumTrustedForLedger();
         testSeqEnforcer();
         testTrustChanged();
+        testPendingDrain();
+        testTrustedCounts();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(Validations, consensus, ripple);
+
+// Validations of a 1000 validator network arriving on several threads, as
+// they do from peers, while a ledger waits to be fully validated.
+class ValidationsBench_test : public beast::unit_test::suite
+{
+    using clock_type = beast::manual_clock<std::chrono::steady_clock>;
+
+    std::size_t static constexpr validators = 1000;
+    std::size_t static constexpr rounds = 200;
+
+    class Adaptor
+    {
+        clock_type& c_;
+        LedgerOracle& oracle_;
+
+    public:
+        using Mutex = std::mutex;
+        using Validation = csf::Validation;
+        using Ledger = csf::Ledger;
+
+        Adaptor(clock_type& c, LedgerOracle& o) : c_{c}, oracle_{o}
+        {
+        }
+
+        NetClock::time_point
+        now() const
+        {
+            using namespace std::chrono;
+            return NetClock::time_point(duration_cast<NetClock::duration>(
+                c_.now().time_since_epoch() + 86400s));
+        }
+
+        void
+        onStale(Validation&&)
+        {
+        }
+
+        void
+        flush(hash_map<PeerID, Validation>&&)
+        {
+        }
+
+        boost::optional<Ledger>
+        acquire(Ledger::ID const& id)
+        {
+            return oracle_.lookup(id);
+        }
+    };
+
+    void
+    measure(std::size_t threads)
+    {
+        using namespace std::chrono;
+
+        LedgerOracle oracle;
+        std::vector<Ledger> ledgers{Ledger{Ledger::MakeGenesis{}}};
+        for (std::uint32_t i = 1; i <= rounds; ++i)
+            ledgers.push_back(oracle.accept(ledgers.back(), Tx{i}));
+
+        clock_type clock;
+        ValidationParms parms;
+        Validations<Adaptor> vals{parms, clock, clock, oracle};
+
+        // Every round is signed a second after the last
+        auto const signTime = [&](std::size_t r) {
+            return vals.adaptor().now() + std::chrono::seconds(r);
+        };
+
+        auto const start = steady_clock::now();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                for (std::size_t r = 1; r < ledgers.size(); ++r)
+                {
+                    auto const& ledger = ledgers[r];
+                    for (std::size_t i = t; i < validators; i += threads)
+                    {
+                        PeerID const id{static_cast<std::uint32_t>(i)};
+                        Validation v{ledger.id(), ledger.seq(), signTime(r),
+                            signTime(0), PeerKey{id, 0}, id, true};
+                        v.setTrusted();
+                        vals.add(id, v);
+                    }
+                }
+            });
+        }
+
+        // Wait for each ledger to be fully validated, as checking a ledger
+        // for acceptance does, then pick the preferred ledger
+        std::size_t queries = 0;
+        std::size_t preferred = 0;
+        for (std::size_t r = 1; r < ledgers.size(); ++r)
+        {
+            auto const& ledger = ledgers[r];
+            while (vals.numTrustedForLedger(ledger.id()) < validators)
+            {
+                ++queries;
+                std::this_thread::yield();
+            }
+
+            auto const best = vals.getPreferred(ledger);
+            if (best && best->first >= ledger.seq())
+                ++preferred;
+        }
+        for (auto& w : workers)
+            w.join();
+        auto const elapsed = steady_clock::now() - start;
+
+        BEAST_EXPECT(preferred == rounds);
+        BEAST_EXPECT(
+            vals.numTrustedForLedger(ledgers.back().id()) == validators);
+
+        auto const us = std::max<std::int64_t>(
+            duration_cast<microseconds>(elapsed).count(), 1);
+        log << validators << " validators, " << threads << " threads: " <<
+            (rounds * validators * 1000000 / us) << " validations/s, " <<
+            (us / rounds) << "us per round, " <<
+            queries << " count queries while waiting" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+            measure(threads);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ValidationsBench, consensus, ripple);
 }  
 }  
 }  
@@ -9,6 +9,7 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <algorithm>
+#include <chrono>
 #include <test/csf/CollectorRef.h>
 #include <test/csf/Scheduler.h>
 #include <test/csf/TrustGraph.h>
@@ -56,6 +57,13 @@ struct Peer
     {
         std::chrono::milliseconds ledgerAccept{0};
 
+        // Time to write an accepted ledger, for each transaction in it
+        std::chrono::microseconds ledgerWritePerTx{0};
+
+        // Write the accepted ledger while the next round runs. It is saved
+        // once written, and writes run one at a time.
+        bool pipelined = false;
+
         std::chrono::milliseconds recvValidation{0};
 
         template <class M>
@@ -167,12 +175,64 @@ struct Peer
 
     int completedLedgers = 0;
 
+    //! Accepted ledgers that are written and saved
+    int savedLedgers = 0;
+
+    //! Longest time from accepting a ledger to saving it
+    SimDuration maxSaveDelay{0};
+
+    //! When the ledger writes started so far finish
+    SimTime writesDone;
+
     int targetLedgers = std::numeric_limits<int>::max();
 
     std::chrono::seconds clockSkew{0};
 
     ProcessingDelays delays;
 
+    /** Wall time spent in calls to Consensus and Validations.
+
+        Time in Consensus includes the Validations queries and ledger
+        accepts it makes through this adaptor. Nested calls are counted
+        once.
+    */
+    struct CpuCost
+    {
+        struct Counter
+        {
+            std::chrono::nanoseconds total{0};
+            int depth = 0;
+        };
+
+        class Scope
+        {
+            Counter& counter_;
+            std::chrono::steady_clock::time_point start_;
+
+        public:
+            explicit Scope(Counter& counter) : counter_{counter}
+            {
+                if (counter_.depth++ == 0)
+                    start_ = std::chrono::steady_clock::now();
+            }
+
+            Scope(Scope const&) = delete;
+            Scope&
+            operator=(Scope const&) = delete;
+
+            ~Scope()
+            {
+                if (--counter_.depth == 0)
+                    counter_.total += std::chrono::steady_clock::now() - start_;
+            }
+        };
+
+        Counter consensus;
+        Counter validations;
+    };
+
+    CpuCost cpu;
+
     bool runAsValidator = true;
 
     std::size_t prevProposers = 0;
@@ -364,12 +424,14 @@ struct Peer
     std::size_t
     proposersValidated(Ledger::ID const& prevLedger)
     {
+        CpuCost::Scope timer{cpu.validations};
         return validations.numTrustedForLedger(prevLedger);
     }
 
     std::size_t
     proposersFinished(Ledger const & prevLedger, Ledger::ID const& prevLedgerID)
     {
+        CpuCost::Scope timer{cpu.validations};
         return validations.getNodesAfter(prevLedger, prevLedgerID);
     }
 
@@ -419,7 +481,13 @@ struct Peer
         ConsensusMode const& mode,
         Json::Value&& consensusJson)
     {
-        schedule(delays.ledgerAccept, [=]() {
+        SimDuration const write =
+            result.txns.txs().size() * delays.ledgerWritePerTx;
+        auto const acceptDelay = delays.pipelined
+            ? SimDuration{delays.ledgerAccept}
+            : delays.ledgerAccept + write;
+
+        schedule(acceptDelay, [=]() {
             const bool proposing = mode == ConsensusMode::proposing;
             const bool consensusFail = result.state == ConsensusState::MovedOn;
 
@@ -435,6 +503,7 @@ struct Peer
             prevProposers = result.proposers;
             prevRoundTime = result.roundTime.read();
             lastClosedLedger = newLedger;
+            saveLedger(write);
 
             auto const it = std::remove_if(
                 openTxs.begin(), openTxs.end(), [&](Tx const& tx) {
@@ -446,7 +515,7 @@ struct Peer
                 newLedger.isAncestor(fullyValidatedLedger);
 
             if (runAsValidator && isCompatible && !consensusFail &&
-                validations.canValidateSeq(newLedger.seq()))
+                canValidateSeq(newLedger.seq()))
             {
                 bool isFull = proposing;
 
@@ -471,6 +540,38 @@ struct Peer
         });
     }
 
+    void
+    saveLedger(SimDuration write)
+    {
+        if (!delays.pipelined)
+        {
+            ++savedLedgers;
+            return;
+        }
+
+        SimTime const accepted = scheduler.now();
+        writesDone = std::max(writesDone, accepted) + write;
+        schedule(writesDone - accepted, [this, accepted]() {
+            ++savedLedgers;
+            maxSaveDelay =
+                std::max<SimDuration>(maxSaveDelay, scheduler.now() - accepted);
+        });
+    }
+
+    bool
+    canValidateSeq(Ledger::Seq seq)
+    {
+        CpuCost::Scope timer{cpu.validations};
+        return validations.canValidateSeq(seq);
+    }
+
+    Ledger::ID
+    getPreferred(Ledger const& ledger)
+    {
+        CpuCost::Scope timer{cpu.validations};
+        return validations.getPreferred(ledger, earliestAllowedSeq());
+    }
+
     Ledger::Seq
     earliestAllowedSeq() const
     {
@@ -486,8 +587,7 @@ struct Peer
         if (ledger.seq() == Ledger::Seq{0})
             return ledgerID;
 
-        Ledger::ID const netLgr =
-            validations.getPreferred(ledger, earliestAllowedSeq());
+        Ledger::ID const netLgr = getPreferred(ledger);
 
         if (netLgr != ledgerID)
         {
@@ -536,7 +636,11 @@ struct Peer
     {
         v.setTrusted();
         v.setSeen(now());
-        ValStatus const res = validations.add(v.nodeID(), v);
+        ValStatus res;
+        {
+            CpuCost::Scope timer{cpu.validations};
+            res = validations.add(v.nodeID(), v);
+        }
 
         if(res == ValStatus::stale)
             return false;
@@ -553,7 +657,11 @@ struct Peer
         if (ledger.seq() <= fullyValidatedLedger.seq())
             return;
 
-        std::size_t const count = validations.numTrustedForLedger(ledger.id());
+        std::size_t count;
+        {
+            CpuCost::Scope timer{cpu.validations};
+            count = validations.numTrustedForLedger(ledger.id());
+        }
         std::size_t const numTrustedPeers = trustGraph.graph().outDegree(this);
         quorum = static_cast<std::size_t>(std::ceil(numTrustedPeers * 0.8));
         if (count >= quorum && ledger.isAncestor(fullyValidatedLedger))
@@ -628,6 +736,7 @@ struct Peer
 
         dest.push_back(p);
 
+        CpuCost::Scope timer{cpu.consensus};
         return consensus.peerProposal(now(), Position{p});
     }
 
@@ -636,7 +745,10 @@ struct Peer
     {
         auto const it = txSets.insert(std::make_pair(txs.id(), txs));
         if (it.second)
+        {
+            CpuCost::Scope timer{cpu.consensus};
             consensus.gotTxSet(now(), txs);
+        }
         return it.second;
     }
 
@@ -684,6 +796,7 @@ struct Peer
     std::size_t
     laggards(Ledger::Seq const seq, hash_set<NodeKey_t>& trustedKeys)
     {
+        CpuCost::Scope timer{cpu.validations};
         return validations.laggards(seq, trustedKeys);
     }
 
@@ -705,7 +818,10 @@ struct Peer
     void
     timerEntry()
     {
-        consensus.timerEntry(now());
+        {
+            CpuCost::Scope timer{cpu.consensus};
+            consensus.timerEntry(now());
+        }
         if (completedLedgers < targetLedgers)
             scheduler.in(parms().ledgerGRANULARITY, [this]() { timerEntry(); });
     }
@@ -713,14 +829,14 @@ struct Peer
     void
     startRound()
     {
-        Ledger::ID bestLCL =
-            validations.getPreferred(lastClosedLedger, earliestAllowedSeq());
+        Ledger::ID bestLCL = getPreferred(lastClosedLedger);
         if(bestLCL == Ledger::ID{0})
             bestLCL = lastClosedLedger.id();
 
         issue(StartRound{bestLCL, lastClosedLedger});
 
         hash_set<PeerID> nowUntrusted;
+        CpuCost::Scope timer{cpu.consensus};
         consensus.startRound(
             now(), bestLCL, lastClosedLedger, nowUntrusted, runAsValidator);
     }
@@ -728,7 +844,10 @@ struct Peer
     void
     start()
     {
-        validations.expire();
+        {
+            CpuCost::Scope timer{cpu.validations};
+            validations.expire();
+        }
         scheduler.in(parms().ledgerGRANULARITY, [&]() { timerEntry(); });
         startRound();
     }
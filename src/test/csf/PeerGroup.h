@@ -3,6 +3,8 @@
 #define RIPPLE_TEST_CSF_PEERGROUP_H_INCLUDED
 
 #include <algorithm>
+#include <chrono>
+#include <random>
 #include <test/csf/Peer.h>
 #include <test/csf/random.h>
 #include <vector>
@@ -11,6 +13,13 @@ namespace ripple {
 namespace test {
 namespace csf {
 
+/** A link delay drawn from a distribution, in milliseconds. */
+inline SimDuration
+linkDelay(double ms)
+{
+    return std::chrono::duration_cast<SimDuration>(
+        std::chrono::duration<double, std::milli>(std::max(ms, 0.0)));
+}
 
 class PeerGroup
 {
@@ -130,6 +139,24 @@ public:
     }
 
     
+    template <class RandomNumberDistribution, class Generator>
+    void
+    connect(
+        PeerGroup const& o,
+        RandomNumberDistribution delayDist,
+        Generator& g)
+    {
+        for(Peer * p : peers_)
+        {
+            for (Peer * target : o.peers_)
+            {
+                if(p != target)
+                    p->connect(*target, linkDelay(delayDist(g)));
+            }
+        }
+    }
+
+    
     void
     disconnect(PeerGroup const &o)
     {
@@ -279,6 +306,33 @@ randomRankedConnect(
     }
 }
 
+/** Connect each peer to `degree` others chosen uniformly at random.
+
+    The delay of each link, in milliseconds, is drawn from `delayDist`.
+    Links are bidirectional, so peers average about twice `degree` links.
+*/
+template <class RandomNumberDistribution, class Generator>
+void
+randomConnect(
+    PeerGroup & peers,
+    std::size_t degree,
+    RandomNumberDistribution delayDist,
+    Generator& g)
+{
+    std::vector<Peer*> const rawPeers(peers.begin(), peers.end());
+    std::uniform_int_distribution<std::size_t> u(0, rawPeers.size() - 1);
+    for(Peer * peer : rawPeers)
+    {
+        std::size_t links = 0;
+        for (std::size_t tries = 0; links < degree && tries < 4 * degree;
+             ++tries)
+        {
+            if (peer->connect(*rawPeers[u(g)], linkDelay(delayDist(g))))
+                ++links;
+        }
+    }
+}
+
 }  
 }  
 }  
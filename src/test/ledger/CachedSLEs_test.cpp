@@ -0,0 +1,115 @@
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/ledger/CachedSLEs.h>
+
+namespace ripple {
+namespace test {
+
+class CachedSLEs_test : public beast::unit_test::suite
+{
+    static
+    std::shared_ptr<SLE const>
+    makeSLE (std::uint8_t n)
+    {
+        return std::make_shared<SLE const> (
+            ltACCOUNT_ROOT, uint256 (n));
+    }
+
+public:
+    void
+    testFetch ()
+    {
+        testcase ("Fetch");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        CachedSLEs cache (1min, clock);
+
+        int reads = 0;
+        auto const read = [&](std::uint8_t n)
+        {
+            return [&reads, n]
+            {
+                ++reads;
+                return makeSLE (n);
+            };
+        };
+
+        // Digests spread over several partitions
+        std::vector<std::shared_ptr<SLE const>> held;
+        for (int i = 0; i < 64; ++i)
+        {
+            uint256 digest;
+            *digest.begin () = static_cast<std::uint8_t> (i);
+            held.push_back (cache.fetch (digest, read (i)));
+        }
+        BEAST_EXPECT (reads == 64);
+        BEAST_EXPECT (cache.size () == 64);
+        BEAST_EXPECT (cache.hits () == 0);
+        BEAST_EXPECT (cache.misses () == 64);
+
+        for (int i = 0; i < 64; ++i)
+        {
+            uint256 digest;
+            *digest.begin () = static_cast<std::uint8_t> (i);
+            BEAST_EXPECT (cache.fetch (digest, read (i)) == held[i]);
+        }
+        BEAST_EXPECT (reads == 64);
+        BEAST_EXPECT (cache.hits () == 64);
+        BEAST_EXPECT (cache.rate () == 0.5);
+
+        // Nothing read is not cached
+        BEAST_EXPECT (! cache.fetch (uint256 (1),
+            []{ return std::shared_ptr<SLE const> (); }));
+        BEAST_EXPECT (cache.size () == 64);
+        BEAST_EXPECT (cache.misses () == 64);
+    }
+
+    void
+    testExpire ()
+    {
+        testcase ("Expire");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        CachedSLEs cache (2s, clock);
+
+        std::vector<std::shared_ptr<SLE const>> held;
+        for (int i = 0; i < 32; ++i)
+        {
+            uint256 digest;
+            *digest.begin () = static_cast<std::uint8_t> (i);
+            auto sle = cache.fetch (digest,
+                [i]{ return makeSLE (i); });
+            if (i % 4 == 0)
+                held.push_back (sle);
+        }
+        BEAST_EXPECT (cache.size () == 32);
+
+        ++clock;
+        cache.expire ();
+        BEAST_EXPECT (cache.size () == 32);
+
+        // Entries still in use are kept
+        clock.advance (2s);
+        cache.expire ();
+        BEAST_EXPECT (cache.size () == held.size ());
+
+        held.clear ();
+        cache.expire ();
+        BEAST_EXPECT (cache.size () == 0);
+    }
+
+    void
+    run () override
+    {
+        testFetch ();
+        testExpire ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE (CachedSLEs, ledger, ripple);
+
+}
+}
@@ -2,6 +2,9 @@
 
 #include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <future>
+#include <thread>
 
 namespace ripple {
 namespace test {
@@ -31,9 +34,53 @@ struct PendingSaves_test : public beast::unit_test::suite
         BEAST_EXPECT(! ps.pending (0));
     }
 
+    void testWrites()
+    {
+        PendingSaves ps;
+        uint256 const hash {1};
+        std::vector<std::string> ran;
+
+        BEAST_EXPECT(! ps.afterWrite (hash, [] {}));
+        ps.finishWrite (hash);
+
+        // Saves wait for the write, which runs once
+        ps.startWrite (hash, [&ran] { ran.push_back ("write"); });
+        BEAST_EXPECT(ps.afterWrite (hash, [&ran] { ran.push_back ("save"); }));
+        BEAST_EXPECT(ran.empty ());
+        ps.finishWrite (hash);
+        BEAST_EXPECT((ran == std::vector<std::string>{"write", "save"}));
+        ps.finishWrite (hash);
+        BEAST_EXPECT(ran.size () == 2);
+        BEAST_EXPECT(! ps.afterWrite (hash, [] {}));
+
+        // A second thread finishing the write waits for the first
+        std::promise<void> started;
+        std::promise<void> release;
+        auto const go = release.get_future ().share ();
+        std::atomic<bool> written {false};
+        ps.startWrite (hash, [&started, go, &written]
+            {
+                started.set_value ();
+                go.wait ();
+                written = true;
+            });
+        std::thread writer ([&ps, &hash] { ps.finishWrite (hash); });
+        started.get_future ().wait ();
+        auto waiter = std::async (std::launch::async,
+            [&ps, &hash, &written]
+            {
+                ps.finishWrite (hash);
+                return written.load ();
+            });
+        release.set_value ();
+        BEAST_EXPECT(waiter.get ());
+        writer.join ();
+    }
+
     void run() override
     {
         testSaves();
+        testWrites();
     }
 };
 
@@ -0,0 +1,111 @@
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/ledger/TxMeta.h>
+#include <ripple/beast/unit_test.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class TxMeta_test : public beast::unit_test::suite
+{
+    void
+    testBuiltLedger()
+    {
+        testcase("Metadata of a built ledger");
+
+        using namespace jtx;
+        Env env(*this);
+
+        Account const gw {"gateway"};
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(10000), gw, alice, bob);
+        env.close();
+        env.trust(USD(1000), alice, bob);
+        env(pay(gw, alice, USD(100)));
+        env(offer(alice, XRP(10), USD(5)));
+        env(pay(bob, alice, XRP(50)));
+        env(pay(alice, bob, USD(200)), txflags(tfPartialPayment));
+        env.close();
+
+        auto const ledger = env.app().getLedgerMaster().getClosedLedger();
+        std::size_t count = 0;
+        std::size_t delivered = 0;
+        for (auto const& tx : ledger->txs)
+        {
+            ++count;
+            auto const id = tx.first->getTransactionID();
+
+            // Readers share the parsed form kept when it was built
+            auto const read = ledger->txRead(id);
+            BEAST_EXPECT(read.first == tx.first);
+            BEAST_EXPECT(read.second == tx.second);
+
+            // It matches what was written to the ledger
+            auto const item = ledger->txMap().peekItem(id);
+            if (! BEAST_EXPECT(item))
+                continue;
+            auto const parsed = deserializeTxPlusMeta(*item);
+            BEAST_EXPECT(parsed.first->getTransactionID() == id);
+            BEAST_EXPECT(*parsed.second == *tx.second);
+
+            SerialIter sit(item->slice());
+            sit.getVL();
+            auto const raw = sit.getVL();
+
+            // Writing fields directly gives the same bytes as the object
+            TxMeta meta(id, ledger->info().seq, *tx.second);
+            if (meta.hasDeliveredAmount())
+                ++delivered;
+            Serializer s;
+            meta.addRaw(s, meta.getResultTER(), meta.getIndex());
+            BEAST_EXPECT(s.peekData() == raw);
+
+            Serializer o;
+            meta.getAsObject().add(o);
+            BEAST_EXPECT(o.peekData() == raw);
+        }
+        BEAST_EXPECT(count == 6);
+        BEAST_EXPECT(delivered == 1);
+    }
+
+    void
+    testTake()
+    {
+        testcase("Take as object");
+
+        TxMeta meta;
+        meta.init(uint256(1), 3);
+        meta.setAffectedNode(uint256(2), sfModifiedNode, ltACCOUNT_ROOT);
+        meta.setAffectedNode(uint256(1), sfCreatedNode, ltOFFER);
+        meta.setDeliveredAmount(STAmount(1000));
+
+        Serializer s;
+        meta.addRaw(s, tesSUCCESS, 7);
+        auto const copy = meta.getAsObject();
+        auto const taken = meta.takeAsObject();
+        BEAST_EXPECT(taken == copy);
+        BEAST_EXPECT(taken.getFieldArray(sfAffectedNodes).size() == 2);
+        BEAST_EXPECT(meta.getNodes().empty());
+
+        Serializer t;
+        taken.add(t);
+        BEAST_EXPECT(t.peekData() == s.peekData());
+    }
+
+public:
+    void
+    run() override
+    {
+        testBuiltLedger();
+        testTake();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxMeta,ledger,ripple);
+
+}
+}
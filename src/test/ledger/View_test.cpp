@@ -2,6 +2,8 @@
 
 #include <test/jtx.h>
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/tx/apply.h>
 #include <ripple/ledger/ApplyViewImpl.h>
 #include <ripple/ledger/OpenView.h>
 #include <ripple/ledger/PaymentSandbox.h>
@@ -9,6 +11,7 @@
 #include <ripple/core/ConfigSections.h>
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/Protocol.h>
+#include <chrono>
 #include <type_traits>
 
 namespace ripple {
@@ -745,8 +748,92 @@ class GetAmendments_test
     }
 };
 
+// Throughput of applying payments to the open ledger and closing it
+class ApplyBench_test
+    : public beast::unit_test::suite
+{
+    std::chrono::steady_clock::duration
+    measure (int count, FeatureBitset features)
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        Env env {*this, features};
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund(XRP(10000000), alice, bob);
+        env.close();
+
+        // Sign up front so only the apply is timed
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve(count);
+        auto const first = env.seq(alice);
+        for (int i = 0; i < count; ++i)
+        {
+            auto const jt = env.jt(pay(alice, bob, XRP(1)),
+                seq(first + i), fee(10));
+            forceValidity(env.app().getHashRouter(),
+                jt.stx->getTransactionID(), Validity::Valid);
+            txs.push_back(jt.stx);
+        }
+
+        int applied = 0;
+        auto const start = steady_clock::now();
+        env.app().openLedger().modify(
+            [&](OpenView& view, beast::Journal j)
+            {
+                for (auto const& tx : txs)
+                    if (ripple::apply(env.app(), view,
+                            *tx, tapNONE, j).second)
+                        ++applied;
+                return true;
+            });
+        auto const open = steady_clock::now() - start;
+
+        auto const closeStart = steady_clock::now();
+        env.close();
+        auto const close = steady_clock::now() - closeStart;
+
+        BEAST_EXPECT(applied == count);
+        BEAST_EXPECT(env.seq(alice) == first + count);
+
+        auto const rate = [&](steady_clock::duration d)
+        {
+            return count * 1000000 /
+                std::max<std::int64_t>(
+                    duration_cast<microseconds>(d).count(), 1);
+        };
+
+        log << count << " payments: open ledger " <<
+            duration_cast<milliseconds>(open).count() << "ms (" <<
+            rate(open) << " tx/s), close " <<
+            duration_cast<milliseconds>(close).count() << "ms (" <<
+            rate(close) << " tx/s)" << std::endl;
+        return open + close;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono;
+        using namespace jtx;
+
+        int const count = 10000;
+        auto const checked = measure(count, supported_amendments());
+        auto const unchecked = measure(count,
+            supported_amendments() - featureEnforceInvariants);
+
+        // Each payment is applied to the open ledger and again on close
+        log << "invariant checks: " <<
+            duration_cast<nanoseconds>(checked - unchecked).count() /
+                (2 * count) << "ns per transaction" << std::endl;
+    }
+};
+
 BEAST_DEFINE_TESTSUITE(View,ledger,ripple);
 BEAST_DEFINE_TESTSUITE(GetAmendments,ledger,ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ApplyBench,ledger,ripple);
 
 }  
 }  
@@ -0,0 +1,111 @@
+#include <test/jtx.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/protocol/jss.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class DatabaseShard_test : public beast::unit_test::suite
+{
+    static std::uint32_t constexpr ledgersPerShard = 256;
+    static std::uint32_t constexpr earliestSeq = 3;
+    static std::uint32_t constexpr lastSeq = 2 * ledgersPerShard;
+
+    struct Result
+    {
+        std::string complete;
+        std::string imported;
+        std::string validated;
+    };
+
+    // Closes enough ledgers for two shards, imports them from the node
+    // store into a shard store using the given number of workers and
+    // validates them.
+    Result
+    importAndValidate (int workers)
+    {
+        using namespace test::jtx;
+
+        beast::temp_dir shardDir;
+        Env env (*this, envconfig ([&](std::unique_ptr<Config> cfg)
+            {
+                auto& shards = cfg->section (ConfigSection::shardDatabase ());
+                shards.set ("type", "nudb");
+                shards.set ("path", shardDir.path ());
+                shards.set ("max_size_gb", "4");
+                shards.set ("ledgers_per_shard",
+                    std::to_string (ledgersPerShard));
+                shards.set ("earliest_seq", std::to_string (earliestSeq));
+                shards.set ("worker_threads", std::to_string (workers));
+                cfg->section (ConfigSection::nodeDatabase ()).set (
+                    "earliest_seq", std::to_string (earliestSeq));
+                return cfg;
+            }));
+
+        auto const alice = Account ("alice");
+        env.fund (XRP (100000), alice);
+        env.close ();
+        for (int i = 0; env.closed ()->info ().seq < lastSeq; ++i)
+        {
+            env (pay (env.master, alice, XRP (1 + i % 100)));
+            env.close ();
+        }
+
+        Result result;
+        auto shardStore = env.app ().getShardStore ();
+        if (! BEAST_EXPECT(shardStore))
+            return result;
+
+        shardStore->import (env.app ().getNodeStore ());
+        result.complete = shardStore->getCompleteShards ();
+        result.imported = shardStore->getProgress ()[jss::ledgers].asString ();
+
+        // Every imported ledger can be read back from the shards
+        std::size_t missing = 0;
+        for (auto seq = earliestSeq; seq <= lastSeq; ++seq)
+        {
+            auto const hash = getHashByIndex (seq, env.app ());
+            auto const ledger = shardStore->fetchLedger (hash, seq);
+            if (! ledger || ledger->info ().hash != hash)
+                ++missing;
+        }
+        BEAST_EXPECT(missing == 0);
+
+        shardStore->validate ();
+        result.validated = shardStore->getProgress ()[jss::ledgers].asString ();
+        return result;
+    }
+
+    void
+    testImportAndValidate ()
+    {
+        testcase ("Import and validate");
+
+        auto const serial = importAndValidate (1);
+        auto const parallel = importAndValidate (4);
+
+        auto const ledgers = std::to_string (lastSeq - earliestSeq + 1);
+        BEAST_EXPECT(serial.complete == "0-1");
+        BEAST_EXPECT(serial.imported == ledgers);
+        BEAST_EXPECT(serial.validated == ledgers);
+
+        BEAST_EXPECT(parallel.complete == serial.complete);
+        BEAST_EXPECT(parallel.imported == serial.imported);
+        BEAST_EXPECT(parallel.validated == serial.validated);
+    }
+
+public:
+    void
+    run () override
+    {
+        testImportAndValidate ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DatabaseShard,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,279 @@
+#include <ripple/overlay/impl/MessageDispatch.h>
+#include <ripple/beast/unit_test.h>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class MessageDispatch_test : public beast::unit_test::suite
+{
+    using Class = MessageDispatch::Class;
+    using DropPolicy = MessageDispatch::DropPolicy;
+    using Priority = MessageDispatch::Priority;
+
+    static
+    std::array<MessageDispatch::Setup, MessageDispatch::classes>
+    makeSetup (std::size_t limit, DropPolicy policy)
+    {
+        return {{
+            {1, limit, policy},
+            {1, limit, policy},
+            {1, limit, policy},
+            {1, limit, policy}}};
+    }
+
+    // Occupies the only thread of a class until released
+    class Blocker
+    {
+        std::promise<void> started_;
+        std::promise<void> release_;
+
+    public:
+        explicit
+        Blocker (MessageDispatch& dispatch, Class c)
+        {
+            auto started = started_.get_future ();
+            auto release = release_.get_future ().share ();
+            dispatch.post (c, Priority::urgent, [this, release]
+                {
+                    started_.set_value ();
+                    release.wait ();
+                });
+            started.wait ();
+        }
+
+        void
+        release ()
+        {
+            release_.set_value ();
+        }
+    };
+
+    // Wait for everything queued on a class to run
+    static
+    void
+    drain (MessageDispatch& dispatch, Class c)
+    {
+        while (dispatch.getStats (c).queued != 0)
+            std::this_thread::yield ();
+
+        std::promise<void> done;
+        dispatch.post (c, Priority::urgent, [&done] { done.set_value (); });
+        done.get_future ().wait ();
+    }
+
+    void
+    testClassify ()
+    {
+        testcase ("Classify");
+
+        using cat = TrafficCount::category;
+        BEAST_EXPECT(MessageDispatch::classify (cat::proposal) ==
+            Class::consensus);
+        BEAST_EXPECT(MessageDispatch::classify (cat::validation) ==
+            Class::consensus);
+        BEAST_EXPECT(MessageDispatch::classify (cat::ld_tsc_share) ==
+            Class::consensus);
+        BEAST_EXPECT(MessageDispatch::classify (cat::transaction) ==
+            Class::transactions);
+        BEAST_EXPECT(MessageDispatch::classify (cat::get_hash_asnode) ==
+            Class::ledgerData);
+        BEAST_EXPECT(MessageDispatch::classify (cat::ld_share) ==
+            Class::ledgerData);
+        BEAST_EXPECT(MessageDispatch::classify (cat::overlay) ==
+            Class::discovery);
+    }
+
+    void
+    testDropNewest ()
+    {
+        testcase ("Drop newest");
+
+        MessageDispatch dispatch (makeSetup (2, DropPolicy::newest));
+        std::mutex mutex;
+        std::vector<int> ran;
+        auto const work = [&](int i)
+        {
+            return [&, i]
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                ran.push_back (i);
+            };
+        };
+
+        Blocker blocker (dispatch, Class::transactions);
+        BEAST_EXPECT(dispatch.post (Class::transactions, Priority::normal, work (1)));
+        BEAST_EXPECT(dispatch.post (Class::transactions, Priority::normal, work (2)));
+        BEAST_EXPECT(! dispatch.post (Class::transactions, Priority::normal, work (3)));
+        BEAST_EXPECT(dispatch.getStats (Class::transactions).queued == 2);
+        blocker.release ();
+        drain (dispatch, Class::transactions);
+
+        BEAST_EXPECT((ran == std::vector<int>{1, 2}));
+        dispatch.stop ();
+        dispatch.join ();
+        auto const stats = dispatch.getStats (Class::transactions);
+        BEAST_EXPECT(stats.dropped == 1);
+        BEAST_EXPECT(stats.executed == 4);
+        BEAST_EXPECT(stats.queued == 0);
+    }
+
+    void
+    testDropOldest ()
+    {
+        testcase ("Drop oldest");
+
+        MessageDispatch dispatch (makeSetup (2, DropPolicy::oldest));
+        std::mutex mutex;
+        std::vector<int> ran;
+        auto const work = [&](int i)
+        {
+            return [&, i]
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                ran.push_back (i);
+            };
+        };
+
+        Blocker blocker (dispatch, Class::ledgerData);
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::normal, work (1)));
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::normal, work (2)));
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::normal, work (3)));
+        blocker.release ();
+        drain (dispatch, Class::ledgerData);
+
+        BEAST_EXPECT((ran == std::vector<int>{2, 3}));
+        BEAST_EXPECT(dispatch.getStats (Class::ledgerData).dropped == 1);
+    }
+
+    void
+    testUrgent ()
+    {
+        testcase ("Urgent");
+
+        MessageDispatch dispatch (makeSetup (1, DropPolicy::newest));
+        std::mutex mutex;
+        std::vector<int> ran;
+        auto const work = [&](int i)
+        {
+            return [&, i]
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                ran.push_back (i);
+            };
+        };
+
+        // Urgent work is never dropped and runs before the rest
+        Blocker blocker (dispatch, Class::consensus);
+        BEAST_EXPECT(dispatch.post (Class::consensus, Priority::normal, work (1)));
+        BEAST_EXPECT(dispatch.post (Class::consensus, Priority::urgent, work (2)));
+        BEAST_EXPECT(dispatch.post (Class::consensus, Priority::urgent, work (3)));
+        BEAST_EXPECT(! dispatch.post (Class::consensus, Priority::normal, work (4)));
+        blocker.release ();
+        drain (dispatch, Class::consensus);
+
+        BEAST_EXPECT((ran == std::vector<int>{2, 3, 1}));
+
+        // Other classes are not held up by a busy one
+        Blocker busy (dispatch, Class::ledgerData);
+        drain (dispatch, Class::consensus);
+        busy.release ();
+        dispatch.stop ();
+        dispatch.join ();
+
+        auto const executed = dispatch.getStats (Class::consensus).executed;
+        BEAST_EXPECT(dispatch.waitTimes (
+            Class::consensus).snapshot ().count () == executed);
+        BEAST_EXPECT(dispatch.runTimes (
+            Class::consensus).snapshot ().count () == executed);
+    }
+
+    void
+    testRequired ()
+    {
+        testcase ("Required");
+
+        MessageDispatch dispatch (makeSetup (1, DropPolicy::oldest));
+        std::mutex mutex;
+        std::vector<int> ran;
+        auto const work = [&](int i)
+        {
+            return [&, i]
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                ran.push_back (i);
+            };
+        };
+
+        // Required work is never dropped and keeps its place in line
+        Blocker blocker (dispatch, Class::ledgerData);
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::normal,
+            work (1)));
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::required,
+            work (2)));
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::normal,
+            work (3)));
+        BEAST_EXPECT(dispatch.post (Class::ledgerData, Priority::required,
+            work (4)));
+        BEAST_EXPECT(dispatch.getStats (Class::ledgerData).queued == 3);
+        blocker.release ();
+        drain (dispatch, Class::ledgerData);
+
+        BEAST_EXPECT((ran == std::vector<int>{2, 3, 4}));
+        BEAST_EXPECT(dispatch.getStats (Class::ledgerData).dropped == 1);
+    }
+
+    void
+    testStop ()
+    {
+        testcase ("Stop");
+
+        MessageDispatch dispatch (makeSetup (4, DropPolicy::newest));
+        bool ran = false;
+        {
+            Blocker blocker (dispatch, Class::discovery);
+            dispatch.post (Class::discovery, Priority::normal, [&ran] { ran = true; });
+            blocker.release ();
+        }
+        dispatch.stop ();
+        dispatch.join ();
+        BEAST_EXPECT(! dispatch.post (Class::discovery, Priority::urgent, [] {}));
+
+        auto const stats = dispatch.getStats (Class::discovery);
+        BEAST_EXPECT(stats.executed + stats.dropped == 2);
+        BEAST_EXPECT(ran == (stats.dropped == 0));
+
+        // Work may stop the pools it runs on without waiting for itself
+        MessageDispatch other (makeSetup (4, DropPolicy::newest));
+        std::promise<void> stopped;
+        BEAST_EXPECT(other.post (Class::consensus, Priority::normal, [&]
+            {
+                other.stop ();
+                stopped.set_value ();
+            }));
+        stopped.get_future ().wait ();
+        BEAST_EXPECT(! other.post (Class::ledgerData, Priority::urgent, [] {}));
+        other.join ();
+        BEAST_EXPECT(other.getStats (Class::consensus).executed == 1);
+    }
+
+public:
+    void
+    run () override
+    {
+        testClassify ();
+        testDropNewest ();
+        testDropOldest ();
+        testUrgent ();
+        testRequired ();
+        testStop ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MessageDispatch,overlay,ripple);
+
+}
+}
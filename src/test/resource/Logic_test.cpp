@@ -3,12 +3,15 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/random.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
 #include <ripple/resource/Consumer.h>
 #include <ripple/resource/impl/Entry.h>
 #include <ripple/resource/impl/Logic.h>
 #include <test/unit_test/SuiteJournal.h>
 
 #include <boost/utility/base_from_member.hpp>
+#include <thread>
+#include <vector>
 
 
 namespace ripple {
@@ -240,6 +243,46 @@ public:
         pass();
     }
 
+    void testConcurrent (beast::Journal j)
+    {
+        testcase ("Concurrent");
+
+        TestLogic logic (j);
+
+        beast::IP::Endpoint const addr (
+            beast::IP::Endpoint::from_string ("192.0.2.3"));
+        Consumer c (logic.newInboundEndpoint (addr));
+
+        // Copies, charges and releases from several threads at once must
+        // neither lose a charge nor a reference.
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back ([&]
+                {
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        Consumer copy (c);
+                        copy.charge (Charge (decayWindowSeconds));
+                        Consumer other (logic.newInboundEndpoint (addr));
+                    }
+                });
+        }
+        for (auto& t : threads)
+            t.join ();
+
+        BEAST_EXPECT(c.balance () == 4000);
+        BEAST_EXPECT(c.entry ().refcount == 1);
+
+        ++logic.clock ();
+        BEAST_EXPECT(c.balance () == 3875);
+
+        // The entry expires only once the last reference is gone
+        logic.periodicActivity ();
+        BEAST_EXPECT(logic.getJson (0).isMember (
+            addr.at_port (0).to_string ()));
+    }
+
     void run() override
     {
         using namespace beast::severities;
@@ -250,11 +293,94 @@ public:
         testCharges (journal);
         testImports (journal);
         testImport (journal);
+        testConcurrent (journal);
     }
 };
 
 BEAST_DEFINE_TESTSUITE(ResourceManager,resource,ripple);
 
+class ResourceBench_test : public beast::unit_test::suite
+{
+    std::size_t static constexpr peers = 100;
+    std::size_t static constexpr clients = 400;
+    std::size_t static constexpr charges = 2000000;
+
+    // Peers hold their consumer and are charged for every message, while
+    // one in sixteen charges is an RPC request from a client, which looks
+    // up its consumer, is charged and releases it.
+    void
+    measure (std::size_t threads)
+    {
+        using namespace std::chrono;
+
+        Logic logic (beast::insight::NullCollector::New (), stopwatch (),
+            beast::Journal {beast::Journal::getNullSink ()});
+
+        std::vector<Consumer> consumers;
+        for (std::size_t i = 0; i < peers; ++i)
+        {
+            beast::IP::AddressV4::bytes_type d = {{10, 0,
+                static_cast<std::uint8_t> (i / 256),
+                static_cast<std::uint8_t> (i % 256)}};
+            consumers.push_back (logic.newOutboundEndpoint (
+                beast::IP::Endpoint {beast::IP::AddressV4 {d}, 51235}));
+        }
+
+        std::vector<beast::IP::Endpoint> addresses;
+        for (std::size_t i = 0; i < clients; ++i)
+        {
+            beast::IP::AddressV4::bytes_type d = {{198, 51,
+                static_cast<std::uint8_t> (100 + i / 256),
+                static_cast<std::uint8_t> (i % 256)}};
+            addresses.emplace_back (beast::IP::AddressV4 {d}, 443);
+        }
+
+        auto const start = steady_clock::now ();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&, t]
+                {
+                    beast::xor_shift_engine rng (t + 1);
+                    Charge const fee (1);
+                    for (std::size_t i = t; i < charges; i += threads)
+                    {
+                        auto const r = rng ();
+                        if ((r & 15) == 0)
+                        {
+                            Consumer c (logic.newInboundEndpoint (
+                                addresses[(r >> 4) % clients]));
+                            c.charge (fee);
+                        }
+                        else
+                        {
+                            consumers[(r >> 4) % peers].charge (fee);
+                        }
+                    }
+                });
+        }
+        for (auto& w : workers)
+            w.join ();
+        auto const elapsed = steady_clock::now () - start;
+
+        auto const us = std::max<std::int64_t> (
+            duration_cast<microseconds> (elapsed).count (), 1);
+        log << threads << " threads: " <<
+            (charges * 1000000 / us) << " charges/s" << std::endl;
+        pass ();
+    }
+
+public:
+    void
+    run () override
+    {
+        for (std::size_t threads : {1, 2, 4, 8})
+            measure (threads);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ResourceBench,resource,ripple);
+
 }
 }
 
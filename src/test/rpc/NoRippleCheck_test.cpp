@@ -244,12 +244,7 @@ class NoRippleCheckLimits_test : public beast::unit_test::suite
                     Endpoint::from_string (test::getEnvLocalhostAddr()));
 
             if (c.balance() > warningThreshold)
-            {
-                using clock_type = beast::abstract_clock <steady_clock>;
-                c.entry().local_balance =
-                    DecayingSample <decayWindowSeconds, clock_type>
-                        {steady_clock::now()};
-            }
+                c.entry().local_balance.reset (steady_clock::now());
         };
 
         for (auto i = 0; i < ripple::RPC::Tuning::noRippleCheck.rmax + 5; ++i)
@@ -4303,6 +4303,61 @@ static RPCCallTestData const rpcCallTestArray [] =
     })"
 },
 
+{
+    "ledger_profile: minimal.", __LINE__,
+    {
+        "ledger_profile",
+    },
+    RPCCallTestData::no_exception,
+    R"({
+    "method" : "ledger_profile"
+    })"
+},
+{
+    "ledger_profile: with limit.", __LINE__,
+    {
+        "ledger_profile",
+        "8"
+    },
+    RPCCallTestData::no_exception,
+    R"({
+    "method" : "ledger_profile",
+    "params" : [
+      {
+         "limit" : 8
+      }
+    ]
+    })"
+},
+{
+    "ledger_profile: too many arguments.", __LINE__,
+    {
+        "ledger_profile",
+        "8",
+        "whatever"
+    },
+    RPCCallTestData::no_exception,
+    R"({
+    "method" : "ledger_profile",
+    "params" : [
+      {
+         "error" : "badSyntax",
+         "error_code" : 1,
+         "error_message" : "Syntax error."
+      }
+    ]
+    })"
+},
+{
+    "ledger_profile: limit too small.", __LINE__,
+    {
+        "ledger_profile",
+        "-1",
+    },
+    RPCCallTestData::bad_cast,
+    R"()"
+},
+
 {
     "ledger_request: ledger index.", __LINE__,
     {
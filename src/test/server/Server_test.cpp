@@ -12,7 +12,9 @@
 #include <boost/asio.hpp>
 #include <boost/optional.hpp>
 #include <boost/utility/in_place_factory.hpp>
+#include <array>
 #include <chrono>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 
@@ -48,6 +50,12 @@ public:
         {
             return io_service_;
         }
+
+        std::thread::id
+        get_id() const
+        {
+            return thread_.get_id();
+        }
     };
 
 
@@ -271,6 +279,58 @@ public:
         pass();
     }
 
+    void shardTests()
+    {
+        testcase("IO shards");
+
+        // Remembers the threads requests were handled on
+        struct ShardHandler : TestHandler
+        {
+            std::mutex mutex;
+            std::vector<std::thread::id> threads;
+
+            void
+            onRequest (Session& session)
+            {
+                {
+                    std::lock_guard<std::mutex> lock (mutex);
+                    threads.push_back (std::this_thread::get_id());
+                }
+                TestHandler::onRequest (session);
+            }
+        };
+
+        SuiteJournal journal ("Server_test", *this);
+        TestThread thread;
+        std::array<TestThread, 2> shards;
+        std::size_t next = 0;
+        ShardHandler handler;
+        auto s = make_Server (handler, thread.get_io_service(), journal,
+            [&shards, &next]() -> boost::asio::io_service&
+            {
+                return shards[next++ % shards.size()].get_io_service();
+            });
+        std::vector<Port> serverPort(1);
+        serverPort.back().ip =
+            beast::IP::Address::from_string (getEnvLocalhostAddr()),
+        serverPort.back().port = 0;
+        serverPort.back().protocol.insert("http");
+        auto eps = s->ports (serverPort);
+        test_keepalive(eps[0]);
+        test_keepalive(eps[0]);
+        s = nullptr;
+
+        // Each connection stays on the shard it was accepted onto
+        BEAST_EXPECT(handler.threads.size() == 4);
+        if (handler.threads.size() == 4)
+        {
+            BEAST_EXPECT(handler.threads[0] == shards[0].get_id());
+            BEAST_EXPECT(handler.threads[1] == shards[0].get_id());
+            BEAST_EXPECT(handler.threads[2] == shards[1].get_id());
+            BEAST_EXPECT(handler.threads[3] == shards[1].get_id());
+        }
+    }
+
     void stressTest()
     {
         testcase("stress test");
@@ -510,6 +570,7 @@ public:
     run() override
     {
         basicTests();
+        shardTests();
         stressTest();
         testBadConfig();
     }
@@ -5,8 +5,12 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <mutex>
+#include <set>
 
 namespace ripple {
 namespace tests {
@@ -303,6 +307,156 @@ public:
                 --h;
             }
         }
+
+        if (backed)
+            testcase ("delta backed");
+        else
+            testcase ("delta unbacked");
+
+        {
+            tests::TestFamily tf{journal};
+            SHAMap map{SHAMapType::FREE, tf, v};
+            if (! backed)
+                map.setUnbacked ();
+            for (int i = 0; i < 2000; ++i)
+                map.addItem (SHAMapItem{sha512Half(i), IntToVUC(i)},
+                    false, false);
+            auto const before = map.snapShot (false);
+
+            for (int i = 0; i < 2000; i += 7)
+                map.delItem (sha512Half(i));
+            for (int i = 1; i < 2000; i += 11)
+            {
+                if (i % 7 != 0)
+                    map.updateGiveItem (std::make_shared<SHAMapItem const>(
+                        sha512Half(i), IntToVUC(i + 1)), false, false);
+            }
+            for (int i = 2000; i < 2100; ++i)
+                map.addItem (SHAMapItem{sha512Half(i), IntToVUC(i)},
+                    false, false);
+            auto const after = map.snapShot (false);
+
+            SHAMap::Delta delta;
+            BEAST_EXPECT(after->compare (*before, delta, 100000));
+
+            for (int threads : {1, 4})
+            {
+                std::mutex lock;
+                SHAMap::Delta visited;
+                BEAST_EXPECT(after->visitDelta (*before,
+                    [&](uint256 const& key,
+                        std::shared_ptr<SHAMapItem const> const& ours,
+                        std::shared_ptr<SHAMapItem const> const& other)
+                    {
+                        // Version 2 maps can report a key that moved
+                        // between depths twice, as compare() does
+                        std::lock_guard<std::mutex> sl (lock);
+                        visited.emplace (key, SHAMap::DeltaItem (ours, other));
+                        return true;
+                    }, threads));
+
+                BEAST_EXPECT(visited.size() == delta.size());
+                for (auto const& d : delta)
+                {
+                    auto const it = visited.find (d.first);
+                    if (! BEAST_EXPECT(it != visited.end()))
+                        continue;
+                    BEAST_EXPECT(it->second.first == d.second.first);
+                    BEAST_EXPECT(it->second.second == d.second.second);
+                }
+            }
+
+            std::atomic<int> count {0};
+            BEAST_EXPECT(! after->visitDelta (*before,
+                [&count](uint256 const&,
+                    std::shared_ptr<SHAMapItem const> const&,
+                    std::shared_ptr<SHAMapItem const> const&)
+                {
+                    return ++count < 10;
+                }, 4));
+            BEAST_EXPECT(count >= 10);
+
+            for (auto const have : {before.get(), static_cast<SHAMap*>(nullptr)})
+            {
+                std::set<SHAMapHash> expected;
+                after->visitDifferences (have,
+                    [&expected](SHAMapAbstractNode& node)
+                    {
+                        expected.insert (node.getNodeHash ());
+                        return true;
+                    });
+                BEAST_EXPECT(! expected.empty ());
+
+                std::mutex lock;
+                std::set<SHAMapHash> visited;
+                after->visitDifferences (have,
+                    [&](SHAMapAbstractNode& node)
+                    {
+                        std::lock_guard<std::mutex> sl (lock);
+                        BEAST_EXPECT(visited.insert (node.getNodeHash ()).second);
+                        return true;
+                    }, 4);
+                BEAST_EXPECT(visited == expected);
+            }
+        }
+
+        if (backed)
+            testcase ("deferred write backed");
+        else
+            testcase ("deferred write unbacked");
+
+        {
+            tests::TestFamily flushed{journal}, deferred{journal};
+            SHAMap map1{SHAMapType::FREE, flushed, v};
+            SHAMap map2{SHAMapType::FREE, deferred, v};
+            if (! backed)
+            {
+                map1.setUnbacked ();
+                map2.setUnbacked ();
+            }
+
+            // Every test family shares one memory backend, so use keys no
+            // other case stores
+            bool const v2 = v == SHAMap::version{2};
+            for (int i = 0; i < 1000; ++i)
+            {
+                auto const key = sha512Half(std::string ("deferred"), v2, i);
+                map1.addItem (SHAMapItem{key, IntToVUC(i)}, false, false);
+                map2.addItem (SHAMapItem{key, IntToVUC(i)}, false, false);
+            }
+
+            // The dirty nodes are cached, but not yet stored
+            std::vector<std::shared_ptr<SHAMapAbstractNode>> dirty;
+            auto const unshared = map2.unshare (dirty);
+            map2.invariants();
+            std::set<SHAMapHash> unwritten;
+            for (auto const& node : dirty)
+            {
+                unwritten.insert (node->getNodeHash ());
+                BEAST_EXPECT(deferred.treecache().fetch (
+                    node->getNodeHash ().as_uint256()) == node);
+                BEAST_EXPECT(! deferred.db().fetch (
+                    node->getNodeHash ().as_uint256(), 1));
+            }
+
+            map2.writeNodes (hotACCOUNT_NODE, dirty);
+            for (auto const& hash : unwritten)
+                BEAST_EXPECT(deferred.db().fetch (hash.as_uint256(), 1));
+
+            // The same nodes were left for writing as flushDirty writes
+            BEAST_EXPECT(unshared == map1.flushDirty (hotACCOUNT_NODE, 1));
+            BEAST_EXPECT(map2.getHash () == map1.getHash ());
+            std::set<SHAMapHash> written;
+            map1.visitNodes ([&written](SHAMapAbstractNode& node)
+                {
+                    written.insert (node.getNodeHash ());
+                    return true;
+                });
+            if (backed)
+                BEAST_EXPECT(unwritten == written);
+            else
+                BEAST_EXPECT(dirty.empty ());
+        }
     }
 };
 
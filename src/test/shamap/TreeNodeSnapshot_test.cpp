@@ -0,0 +1,97 @@
+#include <ripple/shamap/TreeNodeSnapshot.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem.hpp>
+
+namespace ripple {
+namespace tests {
+
+class TreeNodeSnapshot_test : public beast::unit_test::suite
+{
+    beast::xor_shift_engine eng_;
+
+    void
+    fill (SHAMap& map, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            Serializer s;
+            for (int d = 0; d < 3; ++d)
+                s.add32 (rand_int<std::uint32_t>(eng_));
+            map.addItem (SHAMapItem {s.getSHA512Half (), s.peekData ()},
+                false, false);
+        }
+        map.flushDirty (hotACCOUNT_NODE, 1);
+        map.setImmutable ();
+    }
+
+public:
+    void
+    run () override
+    {
+        testcase ("Round trip");
+
+        test::SuiteJournal journal ("TreeNodeSnapshot_test", *this);
+        beast::Journal const j {journal};
+
+        TestFamily source (j);
+        SHAMap map (SHAMapType::FREE, source, SHAMap::version{1});
+        fill (map, 2000);
+        auto const root = map.getHash ().as_uint256 ();
+        source.fullbelow ().insert (root);
+
+        TreeNodeSnapshotSetup setup;
+        setup.path = boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ("node_snapshot_%%%%%%%%");
+        setup.levels = 2;
+
+        auto const saved = saveTreeNodeSnapshot (setup, source, &map, j);
+        BEAST_EXPECT(saved > 16);
+
+        {
+            // The nodes come back, but nothing is taken as full below
+            TestFamily family (j);
+            BEAST_EXPECT(loadTreeNodeSnapshot (setup, family, j) == saved);
+            BEAST_EXPECT(family.treecache ().fetch (root));
+            BEAST_EXPECT(! family.fullbelow ().touch_if_exists (root));
+
+            // Including every node of the top levels
+            std::size_t visited = 0;
+            std::size_t found = 0;
+            map.visitInnerNodes (2, [&](SHAMapAbstractNode& node)
+                {
+                    ++visited;
+                    if (family.treecache ().fetch (
+                            node.getNodeHash ().as_uint256 ()))
+                        ++found;
+                });
+            BEAST_EXPECT(visited == 17);
+            BEAST_EXPECT(found == visited);
+        }
+
+        {
+            // A truncated file loads up to the damage
+            boost::filesystem::resize_file (setup.path,
+                boost::filesystem::file_size (setup.path) - 1);
+            TestFamily family (j);
+            BEAST_EXPECT(loadTreeNodeSnapshot (setup, family, j) ==
+                saved - 1);
+        }
+
+        {
+            // A missing file loads nothing
+            boost::filesystem::remove (setup.path);
+            TestFamily family (j);
+            BEAST_EXPECT(loadTreeNodeSnapshot (setup, family, j) == 0);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TreeNodeSnapshot,shamap,ripple);
+
+}
+}
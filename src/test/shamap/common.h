@@ -22,6 +22,7 @@ private:
     RootStoppable parent_;
     std::unique_ptr<NodeStore::Database> db_;
     bool shardBacked_;
+    LatencyHistogram fetchLatency_;
     beast::Journal j_;
 
 public:
@@ -95,6 +96,12 @@ public:
         return shardBacked_;
     }
 
+    LatencyHistogram&
+    fetchLatency() override
+    {
+        return fetchLatency_;
+    }
+
     void
     missing_node (std::uint32_t refNum) override
     {
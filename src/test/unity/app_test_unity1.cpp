@@ -9,6 +9,7 @@
 #include <test/app/DepositAuth_test.cpp>
 #include <test/app/Discrepancy_test.cpp>
 #include <test/app/Escrow_test.cpp>
+#include <test/app/FetchPackStream_test.cpp>
 #include <test/app/Flow_test.cpp>
 #include <test/app/Freeze_test.cpp>
 #include <test/app/HashRouter_test.cpp>
@@ -20,6 +21,7 @@
 #include <test/app/MultiSign_test.cpp>
 #include <test/app/OfferStream_test.cpp>
 #include <test/app/Offer_test.cpp>
+#include <test/app/OrderBookIndex_test.cpp>
 #include <test/app/OversizeMeta_test.cpp>
 
 #include <test/unit_test/multi_runner.cpp>
@@ -1,6 +1,7 @@
 
 
 
+#include <test/app/ParallelApply_test.cpp>
 #include <test/app/Path_test.cpp>
 #include <test/app/PayChan_test.cpp>
 #include <test/app/PayStrand_test.cpp>
@@ -16,6 +17,7 @@
 #include <test/app/Ticket_test.cpp>
 #include <test/app/Transaction_ordering_test.cpp>
 #include <test/app/TrustAndBalance_test.cpp>
+#include <test/app/TrustLineGraph_test.cpp>
 #include <test/app/TxQ_test.cpp>
 #include <test/app/ValidatorKeys_test.cpp>
 #include <test/app/ValidatorList_test.cpp>
@@ -4,12 +4,15 @@
 #include <test/basics/base64_test.cpp>
 #include <test/basics/base_uint_test.cpp>
 #include <test/basics/Buffer_test.cpp>
+#include <test/basics/CloseProfiler_test.cpp>
 #include <test/basics/contract_test.cpp>
 #include <test/basics/DetectCrash_test.cpp>
 #include <test/basics/FileUtilities_test.cpp>
 #include <test/basics/hardened_hash_test.cpp>
 #include <test/basics/KeyCache_test.cpp>
+#include <test/basics/LatencyHistogram_test.cpp>
 #include <test/basics/mulDiv_test.cpp>
+#include <test/basics/ParallelFor_test.cpp>
 #include <test/basics/PerfLog_test.cpp>
 #include <test/basics/qalloc_test.cpp>
 #include <test/basics/RangeSet_test.cpp>
@@ -5,6 +5,7 @@
 #include <test/beast/beast_abstract_clock_test.cpp>
 #include <test/beast/beast_asio_error_test.cpp>
 #include <test/beast/beast_basic_seconds_clock_test.cpp>
+#include <test/beast/beast_insight_AggregatedCollector_test.cpp>
 #include <test/beast/beast_io_latency_probe_test.cpp>
 #include <test/beast/beast_CurrentThreadName_test.cpp>
 #include <test/beast/beast_Debug_test.cpp>
@@ -5,6 +5,7 @@
 #include <test/consensus/DistributedValidatorsSim_test.cpp>
 #include <test/consensus/LedgerTiming_test.cpp>
 #include <test/consensus/LedgerTrie_test.cpp>
+#include <test/consensus/PerformanceSim_test.cpp>
 #include <test/consensus/ScaleFreeSim_test.cpp>
 #include <test/consensus/Validations_test.cpp>
 
@@ -2,6 +2,7 @@
 
 
 #include <test/ledger/BookDirs_test.cpp>
+#include <test/ledger/CachedSLEs_test.cpp>
 #include <test/ledger/CashDiff_test.cpp>
 #include <test/ledger/Directory_test.cpp>
 #include <test/ledger/Invariants_test.cpp>
@@ -9,6 +10,7 @@
 #include <test/ledger/PendingSaves_test.cpp>
 #include <test/ledger/SHAMapV2_test.cpp>
 #include <test/ledger/SkipList_test.cpp>
+#include <test/ledger/TxMeta_test.cpp>
 #include <test/ledger/View_test.cpp>
 
 
@@ -2,6 +2,7 @@
 
 
 #include <test/overlay/cluster_test.cpp>
+#include <test/overlay/MessageDispatch_test.cpp>
 #include <test/overlay/short_read_test.cpp>
 #include <test/overlay/TMHello_test.cpp>
 
@@ -4,6 +4,7 @@
 #include <test/shamap/FetchPack_test.cpp>
 #include <test/shamap/SHAMapSync_test.cpp>
 #include <test/shamap/SHAMap_test.cpp>
+#include <test/shamap/TreeNodeSnapshot_test.cpp>
 
 
 